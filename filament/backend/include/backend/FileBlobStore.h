@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//! \file
+
+#ifndef TNT_FILAMENT_DRIVER_FILEBLOBSTORE_H
+#define TNT_FILAMENT_DRIVER_FILEBLOBSTORE_H
+
+#include <backend/Platform.h>
+
+#include <utils/compiler.h>
+#include <utils/FileBlobStore.h>
+
+namespace filament {
+namespace backend {
+
+/**
+ * A blob store backed by the filesystem, used to cache compiled programs across runs.
+ *
+ * Each blob is stored in its own file, in the directory given at construction, e.g.:
+ *
+ * ~~~~~~~~~~~{.cpp}
+ * Backend backend = Backend::OPENGL;
+ * DefaultPlatform* platform = DefaultPlatform::create(&backend);
+ * FileBlobStore store("/path/to/cache");
+ * store.attach(*platform);
+ * Engine* engine = Engine::create(backend, platform);
+ * ~~~~~~~~~~~
+ *
+ * The FileBlobStore must outlive the Engine. See utils::FileBlobStore for the storage details.
+ */
+class UTILS_PUBLIC FileBlobStore : public utils::FileBlobStore {
+public:
+    using utils::FileBlobStore::FileBlobStore;
+
+    /**
+     * Sets this store as the blob cache of a Platform, see Platform::setBlobFunc().
+     */
+    void attach(Platform& platform) noexcept;
+};
+
+} // namespace backend
+} // namespace filament
+
+#endif // TNT_FILAMENT_DRIVER_FILEBLOBSTORE_H
@@ -23,6 +23,8 @@
 
 #include <utils/compiler.h>
 
+#include <stddef.h>
+
 namespace filament {
 namespace backend {
 
@@ -37,6 +39,21 @@ public:
         uintptr_t image = 0;
     };
 
+    /**
+     * Stores a blob in the cache. Called by the backend, possibly from its own thread.
+     * The key and value are only valid during the call.
+     */
+    using InsertBlobFunc = void(*)(void const* key, size_t keySize,
+            void const* value, size_t valueSize, void* user);
+
+    /**
+     * Retrieves a blob from the cache. Called by the backend, possibly from its own thread.
+     * Returns the size of the blob associated to key, or 0 if there is none. The blob is
+     * copied into value only if valueSize is large enough to hold it.
+     */
+    using RetrieveBlobFunc = size_t(*)(void const* key, size_t keySize,
+            void* value, size_t valueSize, void* user);
+
     virtual ~Platform() noexcept;
 
     /**
@@ -57,6 +74,43 @@ public:
      * @return nullptr on failure, or a pointer to the newly created driver.
      */
     virtual backend::Driver* createDriver(void* sharedContext) noexcept = 0;
+
+    /**
+     * Sets the callbacks used by the backend to cache the compiled programs (e.g. OpenGL program
+     * binaries or the Vulkan pipeline cache) across runs, see FileBlobStore for an implementation
+     * backed by the filesystem. This must be called before createDriver().
+     *
+     * The blobs are opaque and only valid for the device and driver that created them, the
+     * backend takes care of including this information in the keys.
+     *
+     * @param insert    function called to store a blob, or nullptr to disable caching.
+     * @param retrieve  function called to retrieve a blob, or nullptr to disable caching.
+     * @param user      a pointer passed back to \p insert and \p retrieve.
+     */
+    void setBlobFunc(InsertBlobFunc insert, RetrieveBlobFunc retrieve, void* user) noexcept;
+
+    /**
+     * @return true if both blob callbacks are set.
+     */
+    bool hasBlobFunc() const noexcept { return mInsertBlob && mRetrieveBlob; }
+
+    /**
+     * Stores a blob using the callback set with setBlobFunc(), if any.
+     */
+    void insertBlob(void const* key, size_t keySize,
+            void const* value, size_t valueSize) noexcept;
+
+    /**
+     * Retrieves a blob using the callback set with setBlobFunc(), if any.
+     * @return the size of the blob or 0 if it wasn't found.
+     */
+    size_t retrieveBlob(void const* key, size_t keySize,
+            void* value, size_t valueSize) noexcept;
+
+private:
+    InsertBlobFunc mInsertBlob = nullptr;
+    RetrieveBlobFunc mRetrieveBlob = nullptr;
+    void* mBlobUserData = nullptr;
 };
 
 
@@ -49,6 +49,9 @@ public:
     using SamplerGroupInfo = std::array<std::vector<Sampler>, SAMPLER_BINDING_COUNT>;
     using UniformBlockInfo = std::array<utils::CString, UNIFORM_BINDING_COUNT>;
 
+    // called on the thread calling Driver::purge() once the program can be used
+    using CompilationCallback = void(*)(void* user);
+
     Program() noexcept;
     Program(const Program& rhs) = delete;
     Program& operator=(const Program& rhs) = delete;
@@ -56,7 +59,8 @@ public:
     Program& operator=(Program&& rhs) noexcept;
     ~Program() noexcept;
 
-    // sets the material name and variant for diagnostic purposes only
+    // sets the material name and variant for diagnostic purposes, the variant is also part of
+    // the program cache key, see cacheId().
     Program& diagnostics(utils::CString const& name, uint8_t variantKey = 0);
     Program& diagnostics(utils::CString&& name, uint8_t variantKey = 0) noexcept;
 
@@ -77,6 +81,17 @@ public:
     // Or more precisely, what layout(binding=) is set to in GLSL.
     Program& setSamplerGroup(size_t bindingPoint, Sampler const* samplers, size_t count) noexcept;
 
+    // Allows the backend to compile this program asynchronously, see
+    // Driver::isParallelShaderCompileSupported(). The program must not be used before 'callback'
+    // is called. 'callback' is always called, even if the program fails to compile or is
+    // destroyed before its compilation completes.
+    Program& compilationCallback(CompilationCallback callback, void* user) noexcept;
+
+    // Allows the backend to cache the compiled program across runs using the Platform's blob
+    // store. 'id' must identify the shaders' source uniquely, e.g. a hash of the material
+    // package; the variant set with diagnostics() is added to the key. 0 disables caching.
+    Program& cacheId(uint64_t id) noexcept;
+
     Program& withVertexShader(void const* data, size_t size) {
         return shader(Shader::VERTEX, data, size);
     }
@@ -99,6 +114,12 @@ public:
 
     bool hasSamplers() const noexcept { return mHasSamplers; }
 
+    CompilationCallback getCompilationCallback() const noexcept { return mCompilationCallback; }
+
+    void* getCompilationUserData() const noexcept { return mCompilationUserData; }
+
+    uint64_t getCacheId() const noexcept { return mCacheId; }
+
 private:
 #if !defined(NDEBUG)
     friend utils::io::ostream& operator<< (utils::io::ostream& out, const Program& builder);
@@ -109,8 +130,11 @@ private:
     SamplerGroupInfo mSamplerGroups = {};
     std::array<std::vector<uint8_t>, SHADER_TYPE_COUNT> mShadersSource;
     utils::CString mName;
+    CompilationCallback mCompilationCallback = nullptr;
+    void* mCompilationUserData = nullptr;
+    uint64_t mCacheId = 0;
     bool mHasSamplers = false;
-    uint8_t mVariant;
+    uint8_t mVariant = 0;
 };
 
 } // namespace backend;
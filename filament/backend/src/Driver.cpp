@@ -38,14 +38,21 @@ DriverBase::DriverBase(Dispatcher* dispatcher) noexcept
 }
 
 DriverBase::~DriverBase() noexcept {
+    // make sure all pending callbacks are called
+    purge();
     delete mDispatcher;
 }
 
 void DriverBase::purge() noexcept {
     std::vector<BufferDescriptor> buffersToPurge;
+    std::vector<std::pair<void (*)(void*), void*>> callbacks;
     std::unique_lock<std::mutex> lock(mPurgeLock);
     std::swap(buffersToPurge, mBufferToPurge);
+    std::swap(callbacks, mCallbacks);
     lock.unlock(); // don't remove this, it ensures mBufferToPurge is destroyed without lock held
+    for (auto const& item : callbacks) {
+        item.first(item.second);
+    }
 }
 
 void DriverBase::scheduleDestroySlow(BufferDescriptor&& buffer) noexcept {
@@ -53,6 +60,11 @@ void DriverBase::scheduleDestroySlow(BufferDescriptor&& buffer) noexcept {
     mBufferToPurge.push_back(std::move(buffer));
 }
 
+void DriverBase::scheduleCallback(void (*callback)(void* user), void* user) noexcept {
+    std::lock_guard<std::mutex> lock(mPurgeLock);
+    mCallbacks.emplace_back(callback, user);
+}
+
 // ------------------------------------------------------------------------------------------------
 
 Driver::~Driver() noexcept = default;
@@ -168,9 +168,13 @@ protected:
 
     void scheduleDestroySlow(BufferDescriptor&& buffer) noexcept;
 
+    // the callback is called from the thread calling purge()
+    void scheduleCallback(void (*callback)(void* user), void* user) noexcept;
+
 private:
     std::mutex mPurgeLock;
     std::vector<BufferDescriptor> mBufferToPurge;
+    std::vector<std::pair<void (*)(void*), void*>> mCallbacks;
 };
 
 
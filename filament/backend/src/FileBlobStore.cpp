@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <backend/FileBlobStore.h>
+
+namespace filament {
+namespace backend {
+
+static size_t retrieveBlob(void const* key, size_t keySize,
+        void* value, size_t valueSize, void* user) {
+    return static_cast<FileBlobStore*>(user)->retrieve(key, keySize, value, valueSize);
+}
+
+static void insertBlob(void const* key, size_t keySize,
+        void const* value, size_t valueSize, void* user) {
+    static_cast<FileBlobStore*>(user)->insert(key, keySize, value, valueSize);
+}
+
+void FileBlobStore::attach(Platform& platform) noexcept {
+    platform.setBlobFunc(&insertBlob, &retrieveBlob, this);
+}
+
+} // namespace backend
+} // namespace filament
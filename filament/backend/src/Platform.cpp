@@ -71,6 +71,28 @@ namespace backend {
 // this generates the vtable in this translation unit
 Platform::~Platform() noexcept = default;
 
+void Platform::setBlobFunc(InsertBlobFunc insert, RetrieveBlobFunc retrieve,
+        void* user) noexcept {
+    mInsertBlob = insert;
+    mRetrieveBlob = retrieve;
+    mBlobUserData = user;
+}
+
+void Platform::insertBlob(void const* key, size_t keySize,
+        void const* value, size_t valueSize) noexcept {
+    if (hasBlobFunc()) {
+        mInsertBlob(key, keySize, value, valueSize, mBlobUserData);
+    }
+}
+
+size_t Platform::retrieveBlob(void const* key, size_t keySize,
+        void* value, size_t valueSize) noexcept {
+    if (hasBlobFunc()) {
+        return mRetrieveBlob(key, keySize, value, valueSize, mBlobUserData);
+    }
+    return 0;
+}
+
 // Creates the platform-specific Platform object. The caller takes ownership and is
 // responsible for destroying it. Initialization of the backend API is deferred until
 // createDriver(). The passed-in backend hint is replaced with the resolved backend.
@@ -61,6 +61,16 @@ Program& Program::setSamplerGroup(size_t bindingPoint,
     return *this;
 }
 
+Program& Program::compilationCallback(CompilationCallback callback, void* user) noexcept {
+    mCompilationCallback = callback;
+    mCompilationUserData = user;
+    return *this;
+}
+
+Program& Program::cacheId(uint64_t id) noexcept {
+    mCacheId = id;
+    return *this;
+}
 
 #if !defined(NDEBUG)
 io::ostream& operator<<(io::ostream& out, const Program& builder) {
@@ -491,6 +491,10 @@ bool MetalDriver::canGenerateMipmaps() {
     return true;
 }
 
+bool MetalDriver::isParallelShaderCompileSupported() {
+    return false;
+}
+
 void MetalDriver::loadUniformBuffer(Handle<HwUniformBuffer> ubh,
         BufferDescriptor&& data) {
    if (data.size <= 0) {
@@ -503,6 +507,18 @@ void MetalDriver::loadUniformBuffer(Handle<HwUniformBuffer> ubh,
     scheduleDestroy(std::move(data));
 }
 
+void MetalDriver::updateUniformBuffer(Handle<HwUniformBuffer> ubh, BufferDescriptor&& data,
+        uint32_t byteOffset) {
+    if (data.size <= 0) {
+        return;
+    }
+
+    auto buffer = handle_cast<MetalUniformBuffer>(mHandleMap, ubh);
+
+    buffer->copyIntoBuffer(data.buffer, data.size, byteOffset);
+    scheduleDestroy(std::move(data));
+}
+
 void MetalDriver::updateSamplerGroup(Handle<HwSamplerGroup> sbh,
         SamplerGroup&& samplerGroup) {
     auto sb = handle_cast<MetalSamplerGroup>(mHandleMap, sbh);
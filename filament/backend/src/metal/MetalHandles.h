@@ -73,7 +73,7 @@ public:
      * Update the uniform with data inside src. Potentially allocates a new buffer allocation to
      * hold the bytes which will be released when the current frame is finished.
      */
-    void copyIntoBuffer(void* src, size_t size);
+    void copyIntoBuffer(void* src, size_t size, size_t byteOffset = 0);
 
     /**
      * Denotes that this uniform is used for a draw call ensuring that its allocation remains valid
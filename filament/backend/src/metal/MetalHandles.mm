@@ -125,28 +125,33 @@ MetalUniformBuffer::~MetalUniformBuffer() {
     }
 }
 
-void MetalUniformBuffer::copyIntoBuffer(void* src, size_t size) {
+void MetalUniformBuffer::copyIntoBuffer(void* src, size_t size, size_t byteOffset) {
     if (size <= 0) {
         return;
     }
-    ASSERT_PRECONDITION(size <= this->size, "Attempting to copy %d bytes into a uniform of size %d",
-            size, this->size);
+    ASSERT_PRECONDITION(byteOffset + size <= this->size,
+            "Attempting to copy %d bytes at offset %d into a uniform of size %d",
+            size, byteOffset, this->size);
 
     // Either copy into the Metal buffer or into our cpu buffer.
     if (cpuBuffer) {
-        memcpy(cpuBuffer, src, size);
+        memcpy(static_cast<uint8_t*>(cpuBuffer) + byteOffset, src, size);
         return;
     }
 
     // We're about to acquire a new buffer to hold the new contents of the uniform. If we previously
     // had obtained a buffer we release it, decrementing its reference count, as this uniform no
-    // longer needs it.
-    if (bufferPoolEntry) {
-        context.bufferPool->releaseBuffer(bufferPoolEntry);
+    // longer needs it. When only a range is updated, the rest of the contents is carried over.
+    const MetalBufferPoolEntry* previous = bufferPoolEntry;
+    bufferPoolEntry = context.bufferPool->acquireBuffer(this->size);
+    uint8_t* contents = static_cast<uint8_t*>(bufferPoolEntry->buffer.contents);
+    if (previous) {
+        if (byteOffset || size < this->size) {
+            memcpy(contents, previous->buffer.contents, this->size);
+        }
+        context.bufferPool->releaseBuffer(previous);
     }
-
-    bufferPoolEntry = context.bufferPool->acquireBuffer(size);
-    memcpy(static_cast<uint8_t*>(bufferPoolEntry->buffer.contents), src, size);
+    memcpy(contents + byteOffset, src, size);
 }
 
 id<MTLBuffer> MetalUniformBuffer::getGpuBufferForDraw() {
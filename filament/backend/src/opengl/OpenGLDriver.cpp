@@ -25,6 +25,7 @@
 #include "OpenGLProgram.h"
 
 #include <utils/compiler.h>
+#include <utils/Hash.h>
 #include <utils/Log.h>
 #include <utils/Panic.h>
 #include <utils/Systrace.h>
@@ -220,6 +221,18 @@ OpenGLDriver::OpenGLDriver(OpenGLPlatform* platform) noexcept
     };
     mShaderModel = shaderModel;
 
+#if !defined(__EMSCRIPTEN__)
+    // WebGL doesn't support program binaries
+    GLint programBinaryFormatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &programBinaryFormatCount);
+    features.program_binary = programBinaryFormatCount > 0 && mPlatform.hasBlobFunc();
+#endif
+
+    // program binaries are invalidated by driver updates, so the version is part of the id
+    for (char const* s : { vendor, renderer, version }) {
+        mDriverId = hash::murmurSlow((uint8_t const*)s, strlen(s), mDriverId);
+    }
+
     /*
      * Set our default state
      */
@@ -280,6 +293,7 @@ void OpenGLDriver::initExtensionsGLES(GLint major, GLint minor, ExtentionSet con
     ext.EXT_color_buffer_half_float = hasExtension(exts, "GL_EXT_color_buffer_half_float");
     ext.texture_compression_s3tc = hasExtension(exts, "WEBGL_compressed_texture_s3tc");
     ext.EXT_multisampled_render_to_texture = hasExtension(exts, "GL_EXT_multisampled_render_to_texture");
+    ext.KHR_parallel_shader_compile = hasExtension(exts, "GL_KHR_parallel_shader_compile");
 }
 
 void OpenGLDriver::initExtensionsGL(GLint major, GLint minor, ExtentionSet const& exts) {
@@ -289,9 +303,17 @@ void OpenGLDriver::initExtensionsGL(GLint major, GLint minor, ExtentionSet const
     ext.OES_EGL_image_external_essl3 = hasExtension(exts, "GL_OES_EGL_image_external_essl3");
     ext.EXT_debug_marker = hasExtension(exts, "GL_EXT_debug_marker");
     ext.EXT_color_buffer_half_float = true;  // Assumes core profile.
+    ext.KHR_parallel_shader_compile = hasExtension(exts, "GL_KHR_parallel_shader_compile") ||
+            hasExtension(exts, "GL_ARB_parallel_shader_compile");
 }
 
 void OpenGLDriver::terminate() {
+    // the compilation callbacks of the programs still pending must always be called
+    for (auto const& item : mPendingPrograms) {
+        scheduleCallback(item.callback, item.user);
+    }
+    mPendingPrograms.clear();
+
     for (auto& item : mSamplerMap) {
         unbindSampler(item.second);
         glDeleteSamplers(1, &item.second);
@@ -947,8 +969,16 @@ void OpenGLDriver::createRenderPrimitiveR(Handle<HwRenderPrimitive> rph, int) {
 void OpenGLDriver::createProgramR(Handle<HwProgram> ph, Program&& program) {
     DEBUG_MARKER()
 
-    construct<OpenGLProgram>(ph, this, program);
+    OpenGLProgram* p = construct<OpenGLProgram>(ph, this, program);
     CHECK_GL_ERROR(utils::slog.e)
+
+    if (auto callback = program.getCompilationCallback()) {
+        if (p->isPending()) {
+            mPendingPrograms.push_back({ ph, callback, program.getCompilationUserData() });
+        } else {
+            scheduleCallback(callback, program.getCompilationUserData());
+        }
+    }
 }
 
 void OpenGLDriver::createSamplerGroupR(Handle<HwSamplerGroup> sbh, size_t size) {
@@ -1451,6 +1481,15 @@ void OpenGLDriver::destroyProgram(Handle<HwProgram> ph) {
 
     if (ph) {
         OpenGLProgram* p = handle_cast<OpenGLProgram*>(ph);
+        if (UTILS_UNLIKELY(p->isPending())) {
+            // the compilation callback must still be called
+            auto pos = std::find_if(mPendingPrograms.begin(), mPendingPrograms.end(),
+                    [ph](PendingProgram const& item) { return item.ph == ph; });
+            if (pos != mPendingPrograms.end()) {
+                scheduleCallback(pos->callback, pos->user);
+                mPendingPrograms.erase(pos);
+            }
+        }
         destruct(ph, p);
     }
 }
@@ -1786,6 +1825,25 @@ void OpenGLDriver::loadUniformBuffer(Handle<HwUniformBuffer> ubh, BufferDescript
     scheduleDestroy(std::move(p));
 }
 
+void OpenGLDriver::updateUniformBuffer(Handle<HwUniformBuffer> ubh, BufferDescriptor&& p,
+        uint32_t byteOffset) {
+    DEBUG_MARKER()
+
+    GLUniformBuffer* ub = handle_cast<GLUniformBuffer *>(ubh);
+    assert(ub);
+    assert(ub->gl.ubo.usage != BufferUsage::STREAM);
+    assert(byteOffset + p.size <= ub->gl.ubo.capacity);
+
+    if (p.size > 0) {
+        bindBuffer(GL_UNIFORM_BUFFER, ub->gl.ubo.id);
+        glBufferSubData(GL_UNIFORM_BUFFER, byteOffset, p.size, p.buffer);
+        ub->gl.ubo.size = std::max(ub->gl.ubo.size, uint32_t(byteOffset + p.size));
+    }
+    scheduleDestroy(std::move(p));
+
+    CHECK_GL_ERROR(utils::slog.e)
+}
+
 void OpenGLDriver::updateBuffer(GLenum target,
         GLBuffer* buffer, BufferDescriptor const& p, uint32_t alignment) noexcept {
     assert(buffer->capacity >= p.size);
@@ -1910,6 +1968,10 @@ bool OpenGLDriver::canGenerateMipmaps() {
     return true;
 }
 
+bool OpenGLDriver::isParallelShaderCompileSupported() {
+    return ext.KHR_parallel_shader_compile;
+}
+
 void OpenGLDriver::setTextureData(GLTexture* t,
                                   uint32_t level,
                                   uint32_t xoffset, uint32_t yoffset, uint32_t zoffset,
@@ -2773,6 +2835,9 @@ void OpenGLDriver::readPixels(Handle<HwRenderTarget> src,
 
 void OpenGLDriver::beginFrame(int64_t monotonic_clock_ns, uint32_t frameId) {
     insertEventMarker("beginFrame");
+    if (UTILS_UNLIKELY(!mPendingPrograms.empty())) {
+        updatePendingPrograms();
+    }
     if (UTILS_UNLIKELY(!mExternalStreams.empty())) {
         OpenGLPlatform& platform = mPlatform;
         const size_t index = getIndexForTextureTarget(GL_TEXTURE_EXTERNAL_OES);
@@ -2793,6 +2858,24 @@ void OpenGLDriver::setPresentationTime(int64_t monotonic_clock_ns) {
     mPlatform.setPresentationTime(monotonic_clock_ns);
 }
 
+void OpenGLDriver::updatePendingPrograms() noexcept {
+    auto& pendingPrograms = mPendingPrograms;
+    auto last = std::remove_if(pendingPrograms.begin(), pendingPrograms.end(),
+            [this](PendingProgram const& item) {
+                OpenGLProgram* p = handle_cast<OpenGLProgram*>(item.ph);
+                // the program may have been initialized already if it was used
+                if (p->isPending()) {
+                    if (!p->isCompilationComplete()) {
+                        return false;
+                    }
+                    p->initializePending(this);
+                }
+                scheduleCallback(item.callback, item.user);
+                return true;
+            });
+    pendingPrograms.erase(last, pendingPrograms.end());
+}
+
 void OpenGLDriver::endFrame(uint32_t frameId) {
     //SYSTRACE_NAME("glFinish");
     //glFinish();
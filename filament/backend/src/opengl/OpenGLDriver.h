@@ -518,6 +518,16 @@ private:
     mutable tsl::robin_map<uint32_t, GLuint> mSamplerMap;
     mutable std::vector<GLTexture*> mExternalStreams;
 
+    // programs being compiled asynchronously
+    struct PendingProgram {
+        backend::Handle<backend::HwProgram> ph;
+        backend::Program::CompilationCallback callback;
+        void* user;
+    };
+    std::vector<PendingProgram> mPendingPrograms;
+    // initializes the programs whose compilation completed, and calls their callbacks
+    void updatePendingPrograms() noexcept;
+
     // glGet*() values
     struct {
         GLint max_renderbuffer_size = 0;
@@ -528,8 +538,13 @@ private:
     // features supported by this version of GL or GLES
     struct {
         bool multisample_texture = false;
+        // program binaries are supported, and the platform provides a blob store to keep them
+        bool program_binary = false;
     } features;
 
+    // identifies the GL driver, program binaries are only valid for the driver that created them
+    uint32_t mDriverId = 0;
+
     // supported extensions detected at runtime
     struct {
         bool texture_compression_s3tc = false;
@@ -540,6 +555,7 @@ private:
         bool EXT_debug_marker = false;
         bool EXT_color_buffer_half_float = false;
         bool EXT_multisampled_render_to_texture = false;
+        bool KHR_parallel_shader_compile = false;
     } ext;
 
     struct {
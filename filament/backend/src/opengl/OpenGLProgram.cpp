@@ -18,11 +18,18 @@
 
 #include "OpenGLDriver.h"
 
+#include "private/backend/OpenGLPlatform.h"
+
 #include <utils/Log.h>
 #include <utils/compiler.h>
 #include <utils/Panic.h>
 
 #include <cctype>
+#include <memory>
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
 
 namespace filament {
 
@@ -37,7 +44,20 @@ OpenGLProgram::OpenGLProgram(OpenGLDriver* gl, const Program& programBuilder) no
 
     const auto& shadersSource = programBuilder.getShadersSource();
 
-    // build all shaders
+    BlobKey blobKey;
+    if (programBuilder.getCacheId() && gl->features.program_binary) {
+        blobKey.cacheId = programBuilder.getCacheId();
+        blobKey.driverId = gl->mDriverId;
+        blobKey.variant = programBuilder.getVariant();
+        if (loadBinary(gl, blobKey)) {
+            initializeProgram(gl, programBuilder.getUniformBlockInfo(),
+                    programBuilder.getSamplerGroupInfo());
+            return;
+        }
+    }
+
+    // build all shaders, we don't query the compilation status here, so that the driver can
+    // compile the shaders in parallel if it supports it.
     #pragma nounroll
     for (size_t i = 0; i < Program::SHADER_TYPE_COUNT; i++) {
         GLenum glShaderType;
@@ -52,19 +72,12 @@ OpenGLProgram::OpenGLProgram(OpenGLDriver* gl, const Program& programBuilder) no
         }
 
         if (!shadersSource[i].empty()) {
-            GLint status;
             char const* const source = (const char*)shadersSource[i].data();
 
             GLuint shaderId = glCreateShader(glShaderType);
             glShaderSource(shaderId, 1, &source, nullptr);
             glCompileShader(shaderId);
 
-            glGetShaderiv(shaderId, GL_COMPILE_STATUS, &status);
-            if (UTILS_UNLIKELY(status != GL_TRUE)) {
-                logCompilationError(slog.e, shaderId, source);
-                glDeleteShader(shaderId);
-                return;
-            }
             this->gl.shaders[i] = shaderId;
             mValidShaderSet |= 1U << i;
         }
@@ -73,81 +86,91 @@ OpenGLProgram::OpenGLProgram(OpenGLDriver* gl, const Program& programBuilder) no
     // we need at least a vertex and fragment program
     const uint8_t validShaderSet = mValidShaderSet;
     const uint8_t mask = VERTEX_SHADER_BIT | FRAGMENT_SHADER_BIT;
-    if (UTILS_LIKELY((mValidShaderSet & mask) == mask)) {
-        GLint status;
+    if (UTILS_LIKELY((validShaderSet & mask) == mask)) {
         GLuint program = glCreateProgram();
         for (size_t i = 0; i < Program::SHADER_TYPE_COUNT; i++) {
             if (validShaderSet & (1U << i)) {
                 glAttachShader(program, this->gl.shaders[i]);
             }
         }
+        if (blobKey.cacheId) {
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
         glLinkProgram(program);
+        this->gl.program = program;
+    }
+
+    if (programBuilder.getCompilationCallback() && gl->ext.KHR_parallel_shader_compile) {
+        // the program will be initialized when its compilation completes, keep around what
+        // we need until then.
+        mPendingInfo = new PendingInfo{
+                programBuilder.getUniformBlockInfo(),
+                programBuilder.getSamplerGroupInfo(),
+                shadersSource,
+                blobKey
+        };
+        return;
+    }
+
+    initialize(gl, programBuilder.getUniformBlockInfo(), programBuilder.getSamplerGroupInfo(),
+            shadersSource, blobKey);
+}
+
+bool OpenGLProgram::isCompilationComplete() const noexcept {
+    assert(mPendingInfo);
+    if (!this->gl.program) {
+        return true;
+    }
+    GLint status = GL_FALSE;
+    glGetProgramiv(this->gl.program, GL_COMPLETION_STATUS_KHR, &status);
+    return status == GL_TRUE;
+}
 
+void OpenGLProgram::initializePending(OpenGLDriver* gl) noexcept {
+    assert(mPendingInfo);
+    PendingInfo* const info = mPendingInfo;
+    mPendingInfo = nullptr;
+    initialize(gl, info->uniformBlockInfo, info->samplerGroupInfo, info->shadersSource,
+            info->blobKey);
+    delete info;
+}
+
+void OpenGLProgram::initialize(OpenGLDriver* gl,
+        Program::UniformBlockInfo const& uniformBlockInfo,
+        Program::SamplerGroupInfo const& samplerGroupInfo,
+        ShadersSource const& shadersSource, BlobKey const& blobKey) noexcept {
+
+    // check the compilation status of all shaders, this waits for their compilation to complete
+    uint8_t validShaderSet = mValidShaderSet;
+    #pragma nounroll
+    for (size_t i = 0; i < Program::SHADER_TYPE_COUNT; i++) {
+        if (validShaderSet & (1U << i)) {
+            GLint status;
+            const GLuint shaderId = this->gl.shaders[i];
+            glGetShaderiv(shaderId, GL_COMPILE_STATUS, &status);
+            if (UTILS_UNLIKELY(status != GL_TRUE)) {
+                logCompilationError(slog.e, shaderId, (const char*)shadersSource[i].data());
+                validShaderSet &= ~(1U << i);
+            }
+        }
+    }
+
+    const uint8_t mask = VERTEX_SHADER_BIT | FRAGMENT_SHADER_BIT;
+    if (UTILS_LIKELY((validShaderSet & mask) == mask)) {
+        GLint status;
+        GLuint program = this->gl.program;
         glGetProgramiv(program, GL_LINK_STATUS, &status);
         if (UTILS_UNLIKELY(status != GL_TRUE)) {
             char error[512];
             glGetProgramInfoLog(program, sizeof(error), nullptr, error);
 
             slog.e << "LINKING: " << error << io::endl;
-            glDeleteProgram(program);
-            return;
-        }
-        this->gl.program = program;
-
-        // Associate each UniformBlock in the program to a known binding.
-        auto const& uniformBlockInfo = programBuilder.getUniformBlockInfo();
-        #pragma nounroll
-        for (GLuint binding = 0, n = uniformBlockInfo.size(); binding < n; binding++) {
-            auto const& name = uniformBlockInfo[binding];
-            if (!name.empty()) {
-                GLint index = glGetUniformBlockIndex(program, name.c_str());
-                if (index >= 0) {
-                    glUniformBlockBinding(program, GLuint(index), binding);
-                }
-                CHECK_GL_ERROR(utils::slog.e)
+        } else {
+            if (blobKey.cacheId) {
+                storeBinary(gl, blobKey);
             }
+            initializeProgram(gl, uniformBlockInfo, samplerGroupInfo);
         }
-
-        if (programBuilder.hasSamplers()) {
-            // if we have samplers, we need to do a bit of extra work
-            // activate this program so we can set all its samplers once and for all (glUniform1i)
-            gl->useProgram(program);
-
-            auto const& samplerGroupInfo = programBuilder.getSamplerGroupInfo();
-            auto& indicesRun = mIndicesRuns;
-            uint8_t numUsedBindings = 0;
-            uint8_t tmu = 0;
-
-            #pragma nounroll
-            for (size_t i = 0, c = samplerGroupInfo.size(); i < c; i++) {
-                auto const& groupInfo = samplerGroupInfo[i];
-                if (!groupInfo.empty()) {
-                    // Cache the sampler uniform locations for each interface block
-                    BlockInfo& info = mBlockInfos[numUsedBindings];
-                    info.binding = uint8_t(i);
-                    uint8_t count = 0;
-                    for (uint8_t j = 0, m = uint8_t(groupInfo.size()); j < m; ++j) {
-                        // find its location and associate a TMU to it
-                        GLint loc = glGetUniformLocation(program, groupInfo[j].name.c_str());
-                        if (loc >= 0) {
-                            glUniform1i(loc, tmu);
-                            indicesRun[tmu] = j;
-                            count++;
-                            tmu++;
-                        } else {
-                            // glGetUniformLocation could fail if the uniform is not used
-                            // in the program. We should just ignore the error in that case.
-                        }
-                    }
-                    if (count > 0) {
-                        numUsedBindings++;
-                        info.count = uint8_t(count - 1);
-                    }
-                }
-            }
-            mUsedBindingsCount = numUsedBindings;
-        }
-        mIsValid = true;
     }
 
     // failing to compile a program can't be fatal, because this will happen a lot in
@@ -158,23 +181,150 @@ OpenGLProgram::OpenGLProgram(OpenGLDriver* gl, const Program& programBuilder) no
     }
 }
 
+void OpenGLProgram::initializeProgram(OpenGLDriver* gl,
+        Program::UniformBlockInfo const& uniformBlockInfo,
+        Program::SamplerGroupInfo const& samplerGroupInfo) noexcept {
+    // Associate each UniformBlock in the program to a known binding.
+    GLuint program = this->gl.program;
+    #pragma nounroll
+    for (GLuint binding = 0, n = uniformBlockInfo.size(); binding < n; binding++) {
+        auto const& name = uniformBlockInfo[binding];
+        if (!name.empty()) {
+            GLint index = glGetUniformBlockIndex(program, name.c_str());
+            if (index >= 0) {
+                glUniformBlockBinding(program, GLuint(index), binding);
+            }
+            CHECK_GL_ERROR(utils::slog.e)
+        }
+    }
+
+    initializeSamplers(gl, samplerGroupInfo);
+    mIsValid = true;
+}
+
+bool OpenGLProgram::loadBinary(OpenGLDriver* gl, BlobKey const& blobKey) noexcept {
+    // The blob is the key, the binary format and the binary itself. The key is checked because
+    // the platform's blob store may only compare hashes of the keys (e.g. Android's).
+    constexpr size_t headerSize = sizeof(BlobKey) + sizeof(GLenum);
+    OpenGLPlatform& platform = gl->mPlatform;
+    const size_t size = platform.retrieveBlob(&blobKey, sizeof(blobKey), nullptr, 0);
+    if (size <= headerSize) {
+        return false;
+    }
+
+    std::unique_ptr<uint8_t[]> blob(new uint8_t[size]);
+    if (platform.retrieveBlob(&blobKey, sizeof(blobKey), blob.get(), size) != size ||
+            memcmp(blob.get(), &blobKey, sizeof(blobKey)) != 0) {
+        return false;
+    }
+
+    GLenum format;
+    memcpy(&format, blob.get() + sizeof(BlobKey), sizeof(format));
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, format, blob.get() + headerSize, GLsizei(size - headerSize));
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (UTILS_UNLIKELY(status != GL_TRUE)) {
+        // The binary can be rejected at any time (e.g. after a driver update), in which case we
+        // just compile the program from source. This also discards the GL error we get if the
+        // format isn't supported anymore.
+        glGetError();
+        glDeleteProgram(program);
+        return false;
+    }
+
+    this->gl.program = program;
+    return true;
+}
+
+void OpenGLProgram::storeBinary(OpenGLDriver* gl, BlobKey const& blobKey) const noexcept {
+    GLuint program = this->gl.program;
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    constexpr size_t headerSize = sizeof(BlobKey) + sizeof(GLenum);
+    std::unique_ptr<uint8_t[]> blob(new uint8_t[headerSize + length]);
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, blob.get() + headerSize);
+    if (written > 0) {
+        memcpy(blob.get(), &blobKey, sizeof(blobKey));
+        memcpy(blob.get() + sizeof(BlobKey), &format, sizeof(format));
+        gl->mPlatform.insertBlob(&blobKey, sizeof(blobKey), blob.get(), headerSize + written);
+    }
+}
+
+void OpenGLProgram::initializeSamplers(OpenGLDriver* gl,
+        Program::SamplerGroupInfo const& samplerGroupInfo) noexcept {
+    // if we have samplers, we need to do a bit of extra work
+    // activate this program so we can set all its samplers once and for all (glUniform1i)
+    bool hasSamplers = false;
+    for (auto const& groupInfo : samplerGroupInfo) {
+        hasSamplers |= !groupInfo.empty();
+    }
+    if (!hasSamplers) {
+        return;
+    }
+
+    GLuint program = this->gl.program;
+    gl->useProgram(program);
+
+    auto& indicesRun = mIndicesRuns;
+    uint8_t numUsedBindings = 0;
+    uint8_t tmu = 0;
+
+    #pragma nounroll
+    for (size_t i = 0, c = samplerGroupInfo.size(); i < c; i++) {
+        auto const& groupInfo = samplerGroupInfo[i];
+        if (!groupInfo.empty()) {
+            // Cache the sampler uniform locations for each interface block
+            BlockInfo& info = mBlockInfos[numUsedBindings];
+            info.binding = uint8_t(i);
+            uint8_t count = 0;
+            for (uint8_t j = 0, m = uint8_t(groupInfo.size()); j < m; ++j) {
+                // find its location and associate a TMU to it
+                GLint loc = glGetUniformLocation(program, groupInfo[j].name.c_str());
+                if (loc >= 0) {
+                    glUniform1i(loc, tmu);
+                    indicesRun[tmu] = j;
+                    count++;
+                    tmu++;
+                } else {
+                    // glGetUniformLocation could fail if the uniform is not used
+                    // in the program. We should just ignore the error in that case.
+                }
+            }
+            if (count > 0) {
+                numUsedBindings++;
+                info.count = uint8_t(count - 1);
+            }
+        }
+    }
+    mUsedBindingsCount = numUsedBindings;
+}
+
 OpenGLProgram::~OpenGLProgram() noexcept {
+    delete mPendingInfo;
     const size_t validShaderSet = mValidShaderSet;
-    const bool isValid = mIsValid;
     GLuint program = gl.program;
     if (validShaderSet) {
         #pragma nounroll
         for (size_t i = 0; i < Program::SHADER_TYPE_COUNT; i++) {
             if (validShaderSet & (1U << i)) {
                 const GLuint shader = gl.shaders[i];
-                if (isValid) {
+                if (program) {
                     glDetachShader(program, shader);
                 }
                 glDeleteShader(shader);
             }
         }
     }
-    if (isValid) {
+    if (program) {
         glDeleteProgram(program);
     }
 }
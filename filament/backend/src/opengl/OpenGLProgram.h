@@ -42,7 +42,19 @@ public:
 
     bool isValid() const noexcept { return mIsValid; }
 
+    // whether this program is being compiled asynchronously and hasn't been initialized yet
+    bool isPending() const noexcept { return mPendingInfo != nullptr; }
+
+    // whether the asynchronous compilation of this program is complete, only valid if pending.
+    bool isCompilationComplete() const noexcept;
+
+    // initializes a pending program, this blocks until its compilation completes.
+    void initializePending(OpenGLDriver* gl) noexcept;
+
     void use(OpenGLDriver* const gl) noexcept {
+        if (UTILS_UNLIKELY(mPendingInfo)) {
+            initializePending(gl);
+        }
         if (UTILS_UNLIKELY(mUsedBindingsCount)) {
             // We rely on GL state tracking to avoid unnecessary glBindTexture / glBindSampler
             // calls.
@@ -62,7 +74,7 @@ public:
 
     struct {
         GLuint shaders[backend::Program::SHADER_TYPE_COUNT];
-        GLuint program;
+        GLuint program = 0;
     } gl; // 12 bytes
 
     static void logCompilationError(utils::io::ostream& out, GLuint shaderId, char const* source) noexcept;
@@ -84,6 +96,26 @@ private:
         static_assert(backend::Program::SAMPLER_BINDING_COUNT <= 8, "SAMPLER_BINDING_COUNT must be <= 8");
     };
 
+    using ShadersSource = std::array<std::vector<uint8_t>, backend::Program::SHADER_TYPE_COUNT>;
+
+    // identifies a program binary in the platform's blob store, it has no padding so that it
+    // can be compared with memcmp()
+    struct BlobKey {
+        uint64_t cacheId = 0;       // identifies the program's source, 0 if not cached
+        uint32_t driverId = 0;      // identifies the GL driver
+        uint32_t variant = 0;
+    };
+    static_assert(sizeof(BlobKey) == 16, "BlobKey must not have padding");
+
+    // what we need to initialize the program once its compilation completes
+    struct PendingInfo {
+        backend::Program::UniformBlockInfo uniformBlockInfo;
+        backend::Program::SamplerGroupInfo samplerGroupInfo;
+        ShadersSource shadersSource;
+        BlobKey blobKey;
+    };
+
+    PendingInfo* mPendingInfo = nullptr;
     uint8_t mUsedBindingsCount = 0;
     uint8_t mValidShaderSet = 0;
     bool mIsValid = false;
@@ -94,6 +126,24 @@ private:
     // runs of indices into SamplerGroup -- run start index and size given by BlockInfo
     std::array<uint8_t, TEXTURE_UNIT_COUNT> mIndicesRuns;    // 16 bytes
 
+    void initialize(OpenGLDriver* gl,
+            backend::Program::UniformBlockInfo const& uniformBlockInfo,
+            backend::Program::SamplerGroupInfo const& samplerGroupInfo,
+            ShadersSource const& shadersSource, BlobKey const& blobKey) noexcept;
+
+    // called once the program is successfully linked
+    void initializeProgram(OpenGLDriver* gl,
+            backend::Program::UniformBlockInfo const& uniformBlockInfo,
+            backend::Program::SamplerGroupInfo const& samplerGroupInfo) noexcept;
+
+    void initializeSamplers(OpenGLDriver* gl,
+            backend::Program::SamplerGroupInfo const& samplerGroupInfo) noexcept;
+
+    // creates the program from a binary previously stored in the blob store
+    bool loadBinary(OpenGLDriver* gl, BlobKey const& blobKey) noexcept;
+
+    void storeBinary(OpenGLDriver* gl, BlobKey const& blobKey) const noexcept;
+
     void updateSamplers(OpenGLDriver* gl) noexcept;
 };
 
@@ -174,6 +174,9 @@ VulkanDriver::VulkanDriver(VulkanPlatform* platform,
     createVirtualDevice(mContext);
     mBinder.setDevice(mContext.device);
 
+    createPipelineCache();
+    mBinder.setPipelineCache(mPipelineCache);
+
     // Choose a depth format that meets our requirements. Take care not to include stencil formats
     // just yet, since that would require a corollary change to the "aspect" flags for the VkImage.
     mContext.depthFormat = findSupportedFormat(mContext,
@@ -192,6 +195,65 @@ Driver* VulkanDriver::create(VulkanPlatform* const platform,
     return driver;
 }
 
+// identifies the pipeline cache in the platform's blob store, the cache is only valid for the
+// device and driver that created it.
+struct PipelineCacheKey {
+    char tag[8] = { 'V', 'k', 'P', 'C', 'a', 'c', 'h', 'e' };
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint32_t driverVersion;
+    uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+};
+
+static PipelineCacheKey getPipelineCacheKey(VkPhysicalDeviceProperties const& props) noexcept {
+    PipelineCacheKey key;
+    key.vendorID = props.vendorID;
+    key.deviceID = props.deviceID;
+    key.driverVersion = props.driverVersion;
+    memcpy(key.pipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE);
+    return key;
+}
+
+void VulkanDriver::createPipelineCache() noexcept {
+    // The driver validates the data's header, so a stale cache is simply ignored.
+    std::vector<uint8_t> data;
+    const PipelineCacheKey key = getPipelineCacheKey(mContext.physicalDeviceProperties);
+    const size_t size = mContextManager.retrieveBlob(&key, sizeof(key), nullptr, 0);
+    if (size) {
+        data.resize(size);
+        if (mContextManager.retrieveBlob(&key, sizeof(key), data.data(), size) != size) {
+            data.clear();
+        }
+    }
+
+    VkPipelineCacheCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = data.size();
+    createInfo.pInitialData = data.empty() ? nullptr : data.data();
+    VkResult result = vkCreatePipelineCache(mContext.device, &createInfo, VKALLOC,
+            &mPipelineCache);
+    if (result != VK_SUCCESS) {
+        utils::slog.w << "vkCreatePipelineCache error " << result << utils::io::endl;
+        mPipelineCache = VK_NULL_HANDLE;
+    }
+}
+
+void VulkanDriver::savePipelineCache() noexcept {
+    if (!mPipelineCache || !mContextManager.hasBlobFunc()) {
+        return;
+    }
+    size_t size = 0;
+    vkGetPipelineCacheData(mContext.device, mPipelineCache, &size, nullptr);
+    if (size) {
+        std::vector<uint8_t> data(size);
+        if (vkGetPipelineCacheData(mContext.device, mPipelineCache, &size, data.data()) ==
+                VK_SUCCESS) {
+            const PipelineCacheKey key = getPipelineCacheKey(mContext.physicalDeviceProperties);
+            mContextManager.insertBlob(&key, sizeof(key), data.data(), size);
+        }
+    }
+}
+
 ShaderModel VulkanDriver::getShaderModel() const noexcept {
 #if defined(ANDROID) || defined(IOS)
     return ShaderModel::GL_ES_30;
@@ -224,6 +286,9 @@ void VulkanDriver::terminate() {
     mFramebufferCache.reset();
     mSamplerCache.reset();
 
+    savePipelineCache();
+    vkDestroyPipelineCache(mContext.device, mPipelineCache, VKALLOC);
+
     vmaDestroyAllocator(mContext.allocator);
     vkDestroyCommandPool(mContext.device, mContext.commandPool, VKALLOC);
     vkDestroyDevice(mContext.device, VKALLOC);
@@ -652,6 +717,10 @@ bool VulkanDriver::canGenerateMipmaps() {
     return false;
 }
 
+bool VulkanDriver::isParallelShaderCompileSupported() {
+    return false;
+}
+
 void VulkanDriver::loadUniformBuffer(Handle<HwUniformBuffer> ubh, BufferDescriptor&& data) {
     if (data.size > 0) {
         auto* buffer = handle_cast<VulkanUniformBuffer>(mHandleMap, ubh);
@@ -660,6 +729,15 @@ void VulkanDriver::loadUniformBuffer(Handle<HwUniformBuffer> ubh, BufferDescript
     }
 }
 
+void VulkanDriver::updateUniformBuffer(Handle<HwUniformBuffer> ubh, BufferDescriptor&& data,
+        uint32_t byteOffset) {
+    if (data.size > 0) {
+        auto* buffer = handle_cast<VulkanUniformBuffer>(mHandleMap, ubh);
+        buffer->loadFromCpu(data.buffer, (uint32_t) data.size, byteOffset);
+        scheduleDestroy(std::move(data));
+    }
+}
+
 void VulkanDriver::updateSamplerGroup(Handle<HwSamplerGroup> sbh,
         SamplerGroup&& samplerGroup) {
     auto* sb = handle_cast<VulkanSamplerGroup>(mHandleMap, sbh);
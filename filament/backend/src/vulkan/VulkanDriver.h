@@ -78,6 +78,10 @@ private:
     VulkanDriver& operator = (VulkanDriver const&) = delete;
 
 private:
+    // The pipeline cache is seeded from the platform's blob store, and saved back on terminate.
+    void createPipelineCache() noexcept;
+    void savePipelineCache() noexcept;
+
     backend::VulkanPlatform& mContextManager;
 
     // For now we're not bothering to store handles in pools, just simple on-demand allocation.
@@ -150,6 +154,7 @@ private:
     VulkanRenderTarget* mCurrentRenderTarget = nullptr;
     VulkanSamplerGroup* mSamplerBindings[VulkanBinder::SAMPLER_BINDING_COUNT] = {};
     VkDebugReportCallbackEXT mDebugCallback = VK_NULL_HANDLE;
+    VkPipelineCache mPipelineCache = VK_NULL_HANDLE;
 };
 
 } // namespace backend
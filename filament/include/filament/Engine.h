@@ -21,11 +21,16 @@
 #include <filament/Fence.h>
 #include <filament/SwapChain.h>
 
+#include <backend/BufferDescriptor.h>
 #include <backend/Platform.h>
 
 #include <utils/compiler.h>
 #include <utils/EntityManager.h>
 
+namespace utils {
+class JobSystem;
+} // namespace utils
+
 namespace filament {
 
 class Camera;
@@ -35,6 +40,7 @@ class IndexBuffer;
 class IndirectLight;
 class Material;
 class MaterialInstance;
+class MaterialLibrary;
 class Renderer;
 class Scene;
 class Skybox;
@@ -288,6 +294,36 @@ public:
      */
     Fence* createFence(Fence::Type type = Fence::Type::SOFT) noexcept;
 
+    /**
+     * Creates a MaterialLibrary, which holds materials sharing the same shaders dictionary.
+     * The dictionary is loaded once, Materials are then created from the library with
+     * Material::Builder::library().
+     *
+     * @param payload Pointer to the library data produced by filamat::MaterialLibraryBuilder.
+     *                The data is copied, it can be freed when this method returns.
+     * @param size Size of the library data pointed to by "payload" in bytes.
+     *
+     * @return A pointer to the newly created MaterialLibrary or nullptr if the library data
+     *         is invalid, or doesn't contain the shaders for this Engine's backend.
+     */
+    MaterialLibrary* createMaterialLibrary(const void* payload, size_t size) noexcept;
+
+    /**
+     * Creates a MaterialLibrary without copying the library data.
+     *
+     * @param payload Pointer to the library data produced by filamat::MaterialLibraryBuilder.
+     *                It must stay valid until callback is called.
+     * @param size Size of the library data pointed to by "payload" in bytes.
+     * @param callback Called when the library data is not needed anymore, i.e. when the
+     *                 MaterialLibrary is destroyed or if it couldn't be created. Can be null.
+     * @param user An opaque user pointer passed to the callback function.
+     *
+     * @return A pointer to the newly created MaterialLibrary or nullptr if the library data
+     *         is invalid, or doesn't contain the shaders for this Engine's backend.
+     */
+    MaterialLibrary* createMaterialLibrary(const void* payload, size_t size,
+            backend::BufferDescriptor::Callback callback, void* user = nullptr) noexcept;
+
     void destroy(const VertexBuffer* p);        //!< Destroys an VertexBuffer object.
     void destroy(const Fence* p);               //!< Destroys a Fence object.
     void destroy(const IndexBuffer* p);         //!< Destroys an IndexBuffer object.
@@ -303,6 +339,15 @@ public:
      */
     void destroy(const Material* p);
     void destroy(const MaterialInstance* p);    //!< Destroys a MaterialInstance object.
+
+    /**
+     * Destroys a MaterialLibrary object
+     * @param p the material library to destroy
+     * @attention All the Materials created from this library must be destroyed first.
+     * @exception utils::PreConditionPanic is thrown if some Materials remain.
+     * no-op if exceptions are disabled and some Materials remain.
+     */
+    void destroy(const MaterialLibrary* p);
     void destroy(const Renderer* p);            //!< Destroys a Renderer object.
     void destroy(const Scene* p);               //!< Destroys a Scene object.
     void destroy(const Skybox* p);              //!< Destroys a SkyBox object.
@@ -369,6 +414,15 @@ public:
 
     DebugRegistry& getDebugRegistry() noexcept;
 
+    /**
+     * Returns the JobSystem used by this Engine, which can also be used to run work in parallel
+     * on the application side, e.g. while loading assets.
+     *
+     * Jobs can only be created and waited on from the thread that created the Engine, or from a
+     * thread that adopted this JobSystem.
+     */
+    utils::JobSystem& getJobSystem() noexcept;
+
 protected:
     //! \privatesection
     Engine() noexcept = default;
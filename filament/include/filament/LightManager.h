@@ -176,7 +176,9 @@ public:
      * Control the quality / performance of the shadow map associated to this light
      */
     struct ShadowOptions {
-        /** Size of the shadow map in texels. Must be a power-of-two. */
+        /** Size of the shadow map in texels. Must be a power-of-two. For spot and point lights
+         * this is the maximum size of the light's tiles in the shadow atlas (2048 texels).
+         */
         uint32_t mapSize = 1024;
 
         /** Constant bias in world units (e.g. meters) by which shadows are moved away from the
@@ -232,6 +234,25 @@ public:
          * Setting this value correctly is essential for LISPSM shadow-maps.
          */
         float polygonOffsetSlope = 2.0f;
+
+        /**
+         * Caches the depth of the static shadow casters (see
+         * RenderableManager::Builder::staticShadowCaster()) between frames. The cache is rendered
+         * again only when the light direction, the shadow options, or the static shadow casters
+         * change, or when the camera moves further than staticCacheDistance; otherwise only
+         * the dynamic shadow casters are rendered each frame.
+         * In this mode the shadow map is not focused on the view frustum, which lowers the
+         * effective resolution of shadows; it's best used with a small shadowFar.
+         * This is currently only supported with the OpenGL backend and ignored otherwise.
+         */
+        bool cacheStaticCasters = false;
+
+        /**
+         * Distance in world units the camera can move before the static shadow casters cache
+         * is invalidated. Larger values invalidate the cache less often, at the expense of
+         * shadow resolution.
+         */
+        float staticCacheDistance = 4.0f;
     };
 
     //! Use Builder to construct a Light object instance
@@ -257,8 +278,11 @@ public:
          *
          * @return This Builder, for chaining calls.
          *
-         * @warning
-         * - Only a Type.DIRECTIONAL or Type.SUN light can cast shadows
+         * @note
+         * Shadows of Type.SPOT, Type.FOCUSED_SPOT and Type.POINT lights share a shadow atlas,
+         * point lights use six times as much space as spot lights. When the atlas is full,
+         * the resolution of the shadows of the lights farthest from the camera is reduced
+         * first, and these lights stop casting shadows as a last resort.
          */
         Builder& castShadows(bool enable) noexcept;
 
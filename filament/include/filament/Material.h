@@ -24,6 +24,7 @@
 #include <filament/Texture.h>
 #include <filament/TextureSampler.h>
 
+#include <backend/BufferDescriptor.h>
 #include <backend/DriverEnums.h>
 
 #include <utils/compiler.h>
@@ -40,6 +41,7 @@ class  FMaterial;
 } // namespace details
 
 class Engine;
+class MaterialLibrary;
 
 class UTILS_PUBLIC Material : public FilamentAPI {
     struct BuilderDetails;
@@ -97,6 +99,44 @@ public:
          */
         Builder& package(const void* payload, size_t size);
 
+        /**
+         * Specifies the material data, without copying it. The material data is a binary blob
+         * produced by libfilamat or by matc.
+         *
+         * The shaders are read straight from the material data, which for instance allows
+         * to create materials from a memory-mapped file, without keeping a copy in memory.
+         *
+         * @param payload Pointer to the material data, must stay valid until callback is called.
+         * @param size Size of the material data pointed to by "payload" in bytes.
+         * @param callback Called when the material data is not needed anymore, i.e. when the
+         *                 Material is destroyed or if build() fails. Can be null.
+         * @param user An opaque user pointer passed to the callback function.
+         */
+        Builder& package(const void* payload, size_t size,
+                backend::BufferDescriptor::Callback callback, void* user = nullptr);
+
+        /**
+         * Specifies the material data as one of the materials of a MaterialLibrary. The shaders
+         * are read from the library's dictionary, which is shared by all its materials.
+         *
+         * @param library The MaterialLibrary holding the material, it must outlive the Material.
+         * @param index Index of the material in the library, see
+         *              MaterialLibrary::getMaterialIndex().
+         */
+        Builder& library(MaterialLibrary const* library, size_t index) noexcept;
+
+        /**
+         * Enables asynchronous compilation of this material's shader programs (disabled by
+         * default).
+         *
+         * When enabled, and if the backend supports it, the programs are compiled in the
+         * background the first time they are needed. Until a program is ready, objects using it
+         * are rendered with the default material instead, which avoids stalling the frame.
+         *
+         * @param enable Enables or disables asynchronous compilation of this Material.
+         */
+        Builder& asynchronousCompilation(bool enable) noexcept;
+
         /**
          * Creates the Material object and returns a pointer to it.
          *
@@ -195,6 +235,55 @@ public:
     //! Indicates whether a parameter of the given name exists on this material.
     bool hasParameter(const char* name) const noexcept;
 
+    /**
+     * Features of the shader programs that can be prepared ahead of time with compile().
+     * These can be combined.
+     */
+    enum VariantFeature : uint8_t {
+        DIRECTIONAL_LIGHTING = 0x01,    //!< a directional light is present in the scene
+        DYNAMIC_LIGHTING     = 0x02,    //!< point or spot lights are present in the scene
+        SHADOW_RECEIVER      = 0x04,    //!< renderables receive shadows
+        SKINNING             = 0x08,    //!< renderables use GPU skinning
+        ALL_VARIANTS         = 0x0F
+    };
+
+    /**
+     * Callback used to report the progress of compile().
+     *
+     * @param material The Material whose programs are being compiled.
+     * @param ready Number of requested programs that are ready.
+     * @param total Number of requested programs, the last call has ready == total.
+     * @param user The user pointer given to compile().
+     */
+    using CompilationCallback = void(*)(Material const* material,
+            size_t ready, size_t total, void* user);
+
+    /**
+     * Creates the shader programs of this material ahead of time, e.g. during a loading screen,
+     * so that the first frames using this material don't need to create them.
+     *
+     * All the programs needed by any combination of the given features are created. Programs
+     * are compiled asynchronously if this material was built with
+     * Builder::asynchronousCompilation().
+     *
+     * @param variants A combination of VariantFeature, e.g. DIRECTIONAL_LIGHTING | SKINNING.
+     * @param callback Optional callback, called on the application thread every time one of
+     *                 the programs is ready. This callback may be called before compile()
+     *                 returns and isn't called if this material is destroyed first.
+     * @param user User pointer passed to the callback.
+     */
+    void compile(uint8_t variants,
+            CompilationCallback callback = nullptr, void* user = nullptr) noexcept;
+
+    /**
+     * Returns the variants this material was rendered with since it was created, as a bitmask
+     * where bit N is set when the variant made of the VariantFeature combination N was used.
+     *
+     * Recorded during representative runs, this can be given to matc (--variant-profile) so that
+     * only these variants are compiled in the material, see MaterialBuilder::usedVariants().
+     */
+    uint32_t getUsedVariants() const noexcept;
+
     /**
      * Sets the value of the given parameter on this material's default instance.
      *
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//! \file
+
+#ifndef TNT_FILAMENT_MATERIALLIBRARY_H
+#define TNT_FILAMENT_MATERIALLIBRARY_H
+
+#include <filament/FilamentAPI.h>
+
+#include <utils/compiler.h>
+
+#include <stddef.h>
+
+namespace filament {
+
+/**
+ * A MaterialLibrary holds several materials whose shaders share the same dictionary.
+ *
+ * Material libraries are built offline with filamat::MaterialLibraryBuilder. The shared
+ * dictionary is loaded only once, when the library is created with
+ * Engine::createMaterialLibrary(), and Materials are then created from the library with
+ * Material::Builder::library():
+ *
+ * ~~~~~~~~~~~{.cpp}
+ * MaterialLibrary* library = engine->createMaterialLibrary(data, size);
+ * Material* material = Material::Builder()
+ *         .library(library, library->getMaterialIndex("lit"))
+ *         .build(*engine);
+ * ~~~~~~~~~~~
+ *
+ * @attention A MaterialLibrary must outlive all the Materials created from it.
+ */
+class UTILS_PUBLIC MaterialLibrary : public FilamentAPI {
+public:
+    //! Value returned by getMaterialIndex() when a material is not found.
+    static constexpr size_t INVALID_INDEX = size_t(-1);
+
+    //! Returns the number of materials in this library.
+    size_t getMaterialCount() const noexcept;
+
+    /**
+     * Returns the name of a material of this library.
+     *
+     * @param index Index of the material, between 0 and getMaterialCount() - 1.
+     * @return The name of the material. The pointer is valid as long as the library.
+     */
+    const char* getMaterialName(size_t index) const noexcept;
+
+    /**
+     * Returns the index of a material of this library.
+     *
+     * @param name Name of the material.
+     * @return The index of the material or INVALID_INDEX if it's not in this library.
+     */
+    size_t getMaterialIndex(const char* name) const noexcept;
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_MATERIALLIBRARY_H
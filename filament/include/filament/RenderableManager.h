@@ -82,6 +82,9 @@ public:
         Builder& culling(bool enable) noexcept; // true by default
         Builder& castShadows(bool enable) noexcept; // false by default
         Builder& receiveShadows(bool enable) noexcept; // true by default
+        // Static shadow casters can be cached in the shadow map,
+        // see LightManager::ShadowOptions::cacheStaticCasters.
+        Builder& staticShadowCaster(bool enable) noexcept; // false by default
         Builder& skinning(size_t boneCount) noexcept; // 0 by default, 255 max
         Builder& skinning(size_t boneCount, Bone const* bones) noexcept;
         Builder& skinning(size_t boneCount, math::mat4f const* transforms) noexcept;
@@ -134,8 +137,10 @@ public:
     void setPriority(Instance instance, uint8_t priority) noexcept;
     void setCastShadows(Instance instance, bool enable) noexcept;
     void setReceiveShadows(Instance instance, bool enable) noexcept;
+    void setStaticShadowCaster(Instance instance, bool enable) noexcept;
     bool isShadowCaster(Instance instance) const noexcept;
     bool isShadowReceiver(Instance instance) const noexcept;
+    bool isStaticShadowCaster(Instance instance) const noexcept;
 
     // Updates the bone transforms in the range [offset, offset + boneCount).
     // The bones must be pre-allocated using Builder::skinning().
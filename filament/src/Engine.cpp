@@ -23,6 +23,7 @@
 #include "details/IndexBuffer.h"
 #include "details/IndirectLight.h"
 #include "details/Material.h"
+#include "details/MaterialLibrary.h"
 #include "details/Renderer.h"
 #include "details/RenderPrimitive.h"
 #include "details/Scene.h"
@@ -52,6 +53,7 @@
 #include <math/fast.h>
 #include <math/scalar.h>
 
+#include <algorithm>
 #include <functional>
 
 #include <stdio.h>
@@ -158,8 +160,9 @@ void FEngine::init() {
     DriverApi& driverApi = getDriverApi();
 
     // Parse all post process shaders now, but create them lazily
+    // the post-process materials are static data, no need to copy them
     mPostProcessParser = std::make_unique<MaterialParser>(mBackend,
-            MATERIALS_POSTPROCESS_DATA, MATERIALS_POSTPROCESS_SIZE);
+            MATERIALS_POSTPROCESS_DATA, MATERIALS_POSTPROCESS_SIZE, nullptr, nullptr);
 
     UTILS_UNUSED_IN_RELEASE bool ppMaterialOk =
             mPostProcessParser->parse() && mPostProcessParser->isPostProcessMaterial();
@@ -215,6 +218,14 @@ void FEngine::init() {
             .intensity(1.0f)
             .build(*this));
 
+    // Metal copies the whole uniform buffer when a range of it is updated, so sub-allocating
+    // material instances' uniforms in large buffers would multiply the upload size.
+    mUniformBufferArena.init(mBackend != Backend::METAL);
+
+    // The noop backend never completes the compilation of programs.
+    mParallelShaderCompile = mBackend != Backend::NOOP &&
+            driverApi.isParallelShaderCompileSupported();
+
     // Always initialize the default material, most materials' depth shaders fallback on it.
     mDefaultMaterial = upcast(
             FMaterial::DefaultMaterialBuilder()
@@ -288,6 +299,9 @@ void FEngine::shutdown() {
     for (auto& item : mMaterialInstances) {
         cleanupResourceList(item.second);
     }
+    // this must be done after materials
+    cleanupResourceList(mMaterialLibraries);
+    mUniformBufferArena.terminate(driver);
     cleanupResourceList(mFences);
 
     for (const auto& mPostProcessProgram : mPostProcessPrograms) {
@@ -317,20 +331,18 @@ void FEngine::shutdown() {
 
 void FEngine::prepare() {
     SYSTRACE_CALL();
-    // prepare() is called once per Renderer frame. Ideally we would upload the content of
-    // UBOs that are visible only. It's not such a big issue because the actual upload() is
-    // skipped is the UBO hasn't changed. Still we could have a lot of these.
+    // prepare() is called once per Renderer frame. Only the material instances modified since
+    // the last frame are committed, and only their modified uniforms are uploaded.
     FEngine::DriverApi& driver = getDriverApi();
-    for (auto& materialInstanceList : mMaterialInstances) {
-        for (auto& item : materialInstanceList.second) {
-            item->commit(driver);
-        }
+    for (FMaterialInstance const* instance : mDirtyMaterialInstances) {
+        instance->commitDirty(driver);
     }
+    mDirtyMaterialInstances.clear();
+}
 
-    // Commit default material instances.
-    for (auto& material : mMaterials) {
-        material->getDefaultInstance()->commit(driver);
-    }
+void FEngine::removeDirtyMaterialInstance(FMaterialInstance const* instance) noexcept {
+    auto& instances = mDirtyMaterialInstances;
+    instances.erase(std::remove(instances.begin(), instances.end(), instance), instances.end());
 }
 
 void FEngine::gc() {
@@ -590,6 +602,21 @@ FFence* FEngine::createFence(Fence::Type type) noexcept {
     return p;
 }
 
+FMaterialLibrary* FEngine::createMaterialLibrary(const void* payload, size_t size,
+        bool copy, backend::BufferDescriptor::Callback callback, void* user) noexcept {
+    FMaterialLibrary* p = mHeapAllocator.make<FMaterialLibrary>(
+            payload, size, copy, callback, user);
+    if (p) {
+        if (!ASSERT_POSTCONDITION_NON_FATAL(p->parse(*this),
+                "could not parse the material library")) {
+            mHeapAllocator.destroy(p);
+            return nullptr;
+        }
+        mMaterialLibraries.insert(p);
+    }
+    return p;
+}
+
 FSwapChain* FEngine::createSwapChain(void* nativeWindow, uint64_t flags) noexcept {
     FSwapChain* p = mHeapAllocator.make<FSwapChain>(*this, nativeWindow, flags);
     if (p) {
@@ -743,6 +770,20 @@ void FEngine::destroy(const FMaterialInstance* ptr) {
     }
 }
 
+void FEngine::destroy(const FMaterialLibrary* ptr) {
+    if (ptr != nullptr) {
+        // ensure we've destroyed all the materials using this library
+        for (FMaterial const* material : mMaterials) {
+            if (!ASSERT_PRECONDITION_NON_FATAL(material->getLibrary() != ptr,
+                    "destroying a material library but material \"%s\" still uses it",
+                    material->getName().c_str())) {
+                return;
+            }
+        }
+        terminateAndDestroy(ptr, mMaterialLibraries);
+    }
+}
+
 void FEngine::destroy(Entity e) {
     mRenderableManager.destroy(e);
     mLightManager.destroy(e);
@@ -863,6 +904,15 @@ SwapChain* Engine::createSwapChain(void* nativeWindow, uint64_t flags) noexcept
     return upcast(this)->createSwapChain(nativeWindow, flags);
 }
 
+MaterialLibrary* Engine::createMaterialLibrary(const void* payload, size_t size) noexcept {
+    return upcast(this)->createMaterialLibrary(payload, size, true, nullptr, nullptr);
+}
+
+MaterialLibrary* Engine::createMaterialLibrary(const void* payload, size_t size,
+        backend::BufferDescriptor::Callback callback, void* user) noexcept {
+    return upcast(this)->createMaterialLibrary(payload, size, false, callback, user);
+}
+
 void Engine::destroy(const VertexBuffer* p) {
     upcast(this)->destroy(upcast(p));
 }
@@ -883,6 +933,10 @@ void Engine::destroy(const MaterialInstance* p) {
     upcast(this)->destroy(upcast(p));
 }
 
+void Engine::destroy(const MaterialLibrary* p) {
+    upcast(this)->destroy(upcast(p));
+}
+
 void Engine::destroy(const Renderer* p) {
     upcast(this)->destroy(upcast(p));
 }
@@ -947,5 +1001,9 @@ DebugRegistry& Engine::getDebugRegistry() noexcept {
     return upcast(this)->getDebugRegistry();
 }
 
+JobSystem& Engine::getJobSystem() noexcept {
+    return upcast(this)->getJobSystem();
+}
+
 
 } // namespace filament
@@ -18,6 +18,7 @@
 
 #include "details/Engine.h"
 #include "details/DFG.h"
+#include "details/MaterialLibrary.h"
 
 #include "private/backend/Program.h"
 
@@ -34,8 +35,11 @@
 
 #include <MaterialParser.h>
 
+#include <utils/algorithm.h>
+#include <utils/Hash.h>
 #include <utils/Panic.h>
 
+#include <algorithm>
 #include <sstream>
 
 using namespace utils;
@@ -50,8 +54,14 @@ using namespace backend;
 struct Material::BuilderDetails {
     const void* mPayload = nullptr;
     size_t mSize = 0;
+    bool mCopyPayload = true;
+    backend::BufferDescriptor::Callback mCallback = nullptr;
+    void* mCallbackUser = nullptr;
+    FMaterialLibrary const* mLibrary = nullptr;
+    size_t mLibraryIndex = 0;
     MaterialParser* mMaterialParser = nullptr;
     bool mDefaultMaterial = false;
+    bool mAsynchronousCompilation = false;
 };
 
 FMaterial::DefaultMaterialBuilder::DefaultMaterialBuilder() : Material::Builder() {
@@ -69,14 +79,59 @@ BuilderType::Builder& BuilderType::Builder::operator=(BuilderType::Builder&& rhs
 Material::Builder& Material::Builder::package(const void* payload, size_t size) {
     mImpl->mPayload = payload;
     mImpl->mSize = size;
+    mImpl->mCopyPayload = true;
+    mImpl->mCallback = nullptr;
+    mImpl->mCallbackUser = nullptr;
+    mImpl->mLibrary = nullptr;
+    return *this;
+}
+
+Material::Builder& Material::Builder::package(const void* payload, size_t size,
+        backend::BufferDescriptor::Callback callback, void* user) {
+    mImpl->mPayload = payload;
+    mImpl->mSize = size;
+    mImpl->mCopyPayload = false;
+    mImpl->mCallback = callback;
+    mImpl->mCallbackUser = user;
+    mImpl->mLibrary = nullptr;
+    return *this;
+}
+
+Material::Builder& Material::Builder::library(MaterialLibrary const* library,
+        size_t index) noexcept {
+    mImpl->mLibrary = upcast(library);
+    mImpl->mLibraryIndex = index;
+    return *this;
+}
+
+Material::Builder& Material::Builder::asynchronousCompilation(bool enable) noexcept {
+    mImpl->mAsynchronousCompilation = enable;
     return *this;
 }
 
 Material* Material::Builder::build(Engine& engine) {
-    MaterialParser* materialParser = new MaterialParser(
-            upcast(engine).getBackend(), mImpl->mPayload, mImpl->mSize);
+    FMaterialLibrary const* library = mImpl->mLibrary;
+    if (library) {
+        ASSERT_PRECONDITION(mImpl->mLibraryIndex < library->getMaterialCount(),
+                "material index %u out of range", unsigned(mImpl->mLibraryIndex));
+        // the material's package lives in the library, it's used in place
+        mImpl->mPayload = library->getMaterialData(mImpl->mLibraryIndex);
+        mImpl->mSize = library->getMaterialSize(mImpl->mLibraryIndex);
+        mImpl->mCopyPayload = false;
+        mImpl->mCallback = nullptr;
+        mImpl->mCallbackUser = nullptr;
+    }
+
+    MaterialParser* materialParser = mImpl->mCopyPayload ?
+            new MaterialParser(upcast(engine).getBackend(), mImpl->mPayload, mImpl->mSize) :
+            new MaterialParser(upcast(engine).getBackend(), mImpl->mPayload, mImpl->mSize,
+                    mImpl->mCallback, mImpl->mCallbackUser);
+    if (library) {
+        materialParser->setSharedDictionary(&library->getDictionary());
+    }
     bool materialOK = materialParser->parse() && materialParser->isShadingMaterial();
     if (!ASSERT_POSTCONDITION_NON_FATAL(materialOK, "could not parse the material package")) {
+        delete materialParser;
         return nullptr;
     }
 
@@ -105,6 +160,7 @@ Material* Material::Builder::build(Engine& engine) {
         }
         slog.e << "Compiled material contains shader models 0x"
                 << io::hex << shaderModels.getValue() << io::dec << "." << io::endl;
+        delete materialParser;
         return nullptr;
     }
 
@@ -213,6 +269,25 @@ FMaterial::FMaterial(FEngine& engine, const Material::Builder& builder)
     parser->getTransparencyMode(&mTransparencyMode);
     parser->hasCustomDepthShader(&mHasCustomDepthShader);
     mIsDefaultMaterial = builder->mDefaultMaterial;
+    mLibrary = builder->mLibrary;
+
+    // identifies this material's shaders in the program cache, across runs. The shaders of a
+    // library's material also depend on the library's dictionary.
+    const uint64_t seed = mLibrary ? mLibrary->getDictionaryHash() : 0;
+    mCacheId = hash::murmur64((uint8_t const*)builder->mPayload, builder->mSize, seed);
+
+    // the variants whose vertex and fragment shaders are both in the package
+    const ShaderModel sm = engine.getDriver().getShaderModel();
+    for (uint8_t i = 0; i < VARIANT_COUNT; i++) {
+        if (parser->hasShader(sm, Variant::filterVariantVertex(i), ShaderType::VERTEX) &&
+                parser->hasShader(sm, Variant::filterVariantFragment(i), ShaderType::FRAGMENT)) {
+            mCompiledVariants |= 1u << i;
+        }
+    }
+
+    // the default material is the fallback while programs are compiling, it's always synchronous
+    mAsynchronousCompilation = builder->mAsynchronousCompilation && !mIsDefaultMaterial &&
+            engine.isParallelShaderCompileSupported();
 
     // pre-cache the shared variants -- these variants are shared with the default material.
     if (UTILS_UNLIKELY(!mIsDefaultMaterial && !mHasCustomDepthShader)) {
@@ -259,6 +334,13 @@ void FMaterial::terminate(FEngine& engine) {
         }
         driverApi.destroyProgram(cachedPrograms[i]);
     }
+    for (CompilationToken* token : mCompilationTokens) {
+        if (token) {
+            // the compilation callback will be called, but must not access us anymore
+            token->material = nullptr;
+            driverApi.destroyProgram(token->program);
+        }
+    }
     mDefaultInstance.terminate(engine);
 }
 
@@ -274,12 +356,128 @@ bool FMaterial::hasParameter(const char* name) const noexcept {
 }
 
 backend::Handle<backend::HwProgram> FMaterial::getProgramSlow(uint8_t variantKey) const noexcept {
-    const ShaderModel sm = mEngine.getDriver().getShaderModel();
+    if (UTILS_UNLIKELY(mAsynchronousCompilation)) {
+        if (!mCompilationTokens[variantKey]) {
+            // mCachedPrograms is updated when the compilation completes, see onProgramCompiled()
+            CompilationToken* token = new CompilationToken{ this, {}, variantKey };
+            Program pb = getProgramBuilder(variantKey);
+            pb.compilationCallback(&FMaterial::onProgramCompiled, token);
+            token->program = mEngine.getDriverApi().createProgram(std::move(pb));
+            mCompilationTokens[variantKey] = token;
+        }
+        // until our program is ready, we use the default material's
+        return mEngine.getDefaultMaterial()->getProgram(variantKey);
+    }
+
+    auto program = mEngine.getDriverApi().createProgram(getProgramBuilder(variantKey));
+    assert(program);
 
-    assert(!Variant::isReserved(variantKey));
+    mCachedPrograms[variantKey] = program;
+    return program;
+}
 
-    uint8_t vertexVariantKey = Variant::filterVariantVertex(variantKey);
-    uint8_t fragmentVariantKey = Variant::filterVariantFragment(variantKey);
+void FMaterial::onProgramCompiled(void* user) {
+    CompilationToken* token = static_cast<CompilationToken*>(user);
+    FMaterial const* material = token->material;
+    if (material) {
+        material->mCachedPrograms[token->variant] = token->program;
+        material->mCompilationTokens[token->variant] = nullptr;
+        material->updateCompilationRequests(token->variant);
+    }
+    delete token;
+}
+
+void FMaterial::compile(uint8_t variants,
+        CompilationCallback callback, void* user) noexcept {
+    uint32_t pending = 0;
+    size_t total = 0;
+    for (uint8_t i = 0; i < VARIANT_COUNT; i++) {
+        // all the variants made of the requested features only
+        if ((i & ~variants) || Variant::filterVariant(i, isVariantLit()) != i) {
+            continue;
+        }
+        total++;
+        if (!mCachedPrograms[i]) {
+            getProgramSlow(i);
+            if (!mCachedPrograms[i]) {
+                // this program is compiled asynchronously
+                pending |= 1u << i;
+            }
+        }
+    }
+
+    if (callback) {
+        if (pending) {
+            mCompilationRequests.push_back({ pending, total, callback, user });
+        } else {
+            callback(this, total, total, user);
+        }
+    }
+}
+
+void FMaterial::updateCompilationRequests(uint8_t variant) const noexcept {
+    // the callbacks may call compile(), which adds to mCompilationRequests, so they're invoked
+    // only once it's up to date and not being iterated anymore
+    std::vector<CompilationRequest> updated;
+    auto& requests = mCompilationRequests;
+    for (CompilationRequest& request : requests) {
+        if (request.pending & (1u << variant)) {
+            request.pending &= ~(1u << variant);
+            updated.push_back(request);
+        }
+    }
+    requests.erase(std::remove_if(requests.begin(), requests.end(),
+            [](CompilationRequest const& request) { return request.pending == 0; }),
+            requests.end());
+
+    for (CompilationRequest const& request : updated) {
+        const size_t ready = request.total - utils::popcount(request.pending);
+        request.callback(this, ready, request.total, request.user);
+    }
+}
+
+uint8_t FMaterial::getCompiledVariant(uint8_t variantKey) const noexcept {
+    if (UTILS_LIKELY(mCompiledVariants & (1u << variantKey))) {
+        return variantKey;
+    }
+
+    const uint8_t best = findClosestVariant(mCompiledVariants, variantKey);
+    if (best != variantKey) {
+        slog.w << "The material '" << mName.c_str_safe() << "' doesn't have the variant 0x"
+                << io::hex << unsigned(variantKey) << ", using the variant 0x"
+                << unsigned(best) << io::dec << " instead." << io::endl;
+    }
+    return best;
+}
+
+uint8_t FMaterial::findClosestVariant(uint32_t compiledVariants, uint8_t variantKey) noexcept {
+    // Pick the compiled variant with the most features of the requested one. Skinning outweighs
+    // everything else since the geometry would be wrong without it, then depth variants are
+    // replaced by depth variants if possible.
+    uint8_t best = variantKey;
+    int bestScore = -1;
+    for (uint8_t i = 0; i < VARIANT_COUNT; i++) {
+        if ((i & ~variantKey) || !(compiledVariants & (1u << i))) {
+            continue;
+        }
+        int score = int(utils::popcount(uint32_t(i)));
+        score += (Variant(i).isDepthPass() == Variant(variantKey).isDepthPass()) ? 16 : 0;
+        score += (i & Variant::SKINNING) ? 32 : 0;
+        if (score > bestScore) {
+            bestScore = score;
+            best = i;
+        }
+    }
+    return best;
+}
+
+Program FMaterial::getProgramBuilder(uint8_t variantKey) const noexcept {
+    const ShaderModel sm = mEngine.getDriver().getShaderModel();
+
+    // the program is built from the closest variant available in the package
+    const uint8_t compiledVariantKey = getCompiledVariant(variantKey);
+    uint8_t vertexVariantKey = Variant::filterVariantVertex(compiledVariantKey);
+    uint8_t fragmentVariantKey = Variant::filterVariantFragment(compiledVariantKey);
 
     /*
      * Vertex shader
@@ -311,6 +509,7 @@ backend::Handle<backend::HwProgram> FMaterial::getProgramSlow(uint8_t variantKey
 
     Program pb;
     pb      .diagnostics(mName, variantKey)
+            .cacheId(mCacheId)
             .withVertexShader(vsBuilder.data(), vsBuilder.size())
             .withFragmentShader(fsBuilder.data(), fsBuilder.size())
             .setUniformBlock(BindingPoints::PER_VIEW, UibGenerator::getPerViewUib().getName())
@@ -318,7 +517,7 @@ backend::Handle<backend::HwProgram> FMaterial::getProgramSlow(uint8_t variantKey
             .setUniformBlock(BindingPoints::PER_RENDERABLE, UibGenerator::getPerRenderableUib().getName())
             .setUniformBlock(BindingPoints::PER_MATERIAL_INSTANCE, mUniformInterfaceBlock.getName());
 
-    if (Variant(variantKey).hasSkinning()) {
+    if (Variant(compiledVariantKey).hasSkinning()) {
         pb.setUniformBlock(BindingPoints::PER_RENDERABLE_BONES,
                 UibGenerator::getPerRenderableBonesUib().getName());
     }
@@ -344,11 +543,7 @@ backend::Handle<backend::HwProgram> FMaterial::getProgramSlow(uint8_t variantKey
     addSamplerGroup(BindingPoints::PER_VIEW, SibGenerator::getPerViewSib(), mSamplerBindings);
     addSamplerGroup(BindingPoints::PER_MATERIAL_INSTANCE, mSamplerInterfaceBlock, mSamplerBindings);
 
-    auto program = mEngine.getDriverApi().createProgram(std::move(pb));
-    assert(program);
-
-    mCachedPrograms[variantKey] = program;
-    return program;
+    return pb;
 }
 
 size_t FMaterial::getParameters(ParameterInfo* parameters, size_t count) const noexcept {
@@ -473,6 +668,14 @@ bool Material::hasParameter(const char* name) const noexcept {
     return upcast(this)->hasParameter(name);
 }
 
+void Material::compile(uint8_t variants, CompilationCallback callback, void* user) noexcept {
+    upcast(this)->compile(variants, callback, user);
+}
+
+uint32_t Material::getUsedVariants() const noexcept {
+    return upcast(this)->getUsedVariants();
+}
+
 MaterialInstance* Material::getDefaultInstance() noexcept {
     return upcast(this)->getDefaultInstance();
 }
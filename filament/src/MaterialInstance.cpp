@@ -43,6 +43,7 @@ FMaterialInstance::FMaterialInstance() noexcept = default;
 
 FMaterialInstance::FMaterialInstance(FEngine& engine, FMaterial const* material) {
     mMaterial = material;
+    mEngine = &engine;
     mMaterialSortingKey = RenderPass::makeMaterialSortingKey(
             material->getId(), material->generateMaterialInstanceId());
 
@@ -50,7 +51,7 @@ FMaterialInstance::FMaterialInstance(FEngine& engine, FMaterial const* material)
 
     if (!material->getUniformInterfaceBlock().isEmpty()) {
         mUniforms.setUniforms(material->getDefaultInstance()->getUniformBuffer());
-        mUbHandle = driver.createUniformBuffer(mUniforms.getSize(), backend::BufferUsage::DYNAMIC);
+        allocateUniformBuffer(engine);
     }
 
     if (!material->getSamplerInterfaceBlock().isEmpty()) {
@@ -59,11 +60,13 @@ FMaterialInstance::FMaterialInstance(FEngine& engine, FMaterial const* material)
     }
 
     initParameters(material);
+    invalidate();
 }
 
 // This version is used to initialize the default material instance
 void FMaterialInstance::initDefaultInstance(FEngine& engine, FMaterial const* material) {
     mMaterial = material;
+    mEngine = &engine;
     mMaterialSortingKey = RenderPass::makeMaterialSortingKey(
             material->getId(), material->generateMaterialInstanceId());
 
@@ -71,7 +74,7 @@ void FMaterialInstance::initDefaultInstance(FEngine& engine, FMaterial const* ma
 
     if (!material->getUniformInterfaceBlock().isEmpty()) {
         mUniforms = UniformBuffer(material->getUniformInterfaceBlock().getSize());
-        mUbHandle = driver.createUniformBuffer(mUniforms.getSize(), backend::BufferUsage::STATIC);
+        allocateUniformBuffer(engine);
     }
 
     if (!material->getSamplerInterfaceBlock().isEmpty()) {
@@ -80,16 +83,27 @@ void FMaterialInstance::initDefaultInstance(FEngine& engine, FMaterial const* ma
     }
 
     initParameters(material);
+    invalidate();
 }
 
 FMaterialInstance::~FMaterialInstance() noexcept = default;
 
 void FMaterialInstance::terminate(FEngine& engine) {
+    if (mInDirtyList) {
+        engine.removeDirtyMaterialInstance(this);
+    }
     FEngine::DriverApi& driver = engine.getDriverApi();
-    driver.destroyUniformBuffer(mUbHandle);
+    engine.getUniformBufferArena().free(driver, { mUbHandle, mUbOffset }, mUniforms.getSize());
     driver.destroySamplerGroup(mSbHandle);
 }
 
+void FMaterialInstance::allocateUniformBuffer(FEngine& engine) noexcept {
+    UniformBufferArena::Allocation allocation = engine.getUniformBufferArena().allocate(
+            engine.getDriverApi(), mUniforms.getSize());
+    mUbHandle = allocation.ubh;
+    mUbOffset = allocation.offset;
+}
+
 void FMaterialInstance::initParameters(FMaterial const* material) {
 
     if (material->getBlendingMode() == BlendingMode::MASKED) {
@@ -113,7 +127,10 @@ void FMaterialInstance::initParameters(FMaterial const* material) {
 void FMaterialInstance::commitSlow(DriverApi& driver) const {
     // update uniforms if needed
     if (mUniforms.isDirty()) {
-        driver.loadUniformBuffer(mUbHandle, mUniforms.toBufferDescriptor(driver));
+        // only upload the changed uniforms, the rest of the buffer is preserved
+        uint32_t offset;
+        BufferDescriptor data(mUniforms.toDirtyBufferDescriptor(driver, &offset));
+        driver.updateUniformBuffer(mUbHandle, std::move(data), mUbOffset + offset);
     }
     if (mSamplers.isDirty()) {
         driver.updateSamplerGroup(mSbHandle, std::move(mSamplers.toCommandStream()));
@@ -125,6 +142,7 @@ inline void FMaterialInstance::setParameter(const char* name, T value) noexcept
     ssize_t offset = mMaterial->getUniformInterfaceBlock().getUniformOffset(name, 0);
     if (offset >= 0) {
         mUniforms.setUniform<T>(size_t(offset), value);  // handles specialization for mat3f
+        invalidate();
     }
 }
 
@@ -133,6 +151,7 @@ inline void FMaterialInstance::setParameter(const char* name, const T* value, si
     ssize_t offset = mMaterial->getUniformInterfaceBlock().getUniformOffset(name, 0);
     if (offset >= 0) {
         mUniforms.setUniformArray<T>(size_t(offset), value, count);
+        invalidate();
     }
 }
 
@@ -145,6 +164,7 @@ void FMaterialInstance::setParameter(const char* name,
         backend::Handle<backend::HwTexture> texture, backend::SamplerParams params) noexcept {
     size_t index = mMaterial->getSamplerInterfaceBlock().getSamplerInfo(name)->offset;
     mSamplers.setSampler(index, { texture, params });
+    invalidate();
 }
 
 void FMaterialInstance::setDoubleSided(bool doubleSided) noexcept {
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "details/MaterialLibrary.h"
+
+#include "details/Engine.h"
+
+#include <MaterialParser.h>
+
+#include <filaflat/DictionaryReader.h>
+#include <filaflat/Unflattener.h>
+
+#include <filament/MaterialChunkType.h>
+#include <filament/MaterialEnums.h>
+
+#include <utils/Hash.h>
+#include <utils/Log.h>
+#include <utils/Panic.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+using namespace utils;
+using namespace filaflat;
+using namespace filamat;
+
+namespace filament {
+namespace details {
+
+FMaterialLibrary::FMaterialLibrary(const void* data, size_t size, bool copy,
+        Callback callback, void* user)
+        : mData(copy ? memcpy(malloc(size), data, size) : const_cast<void*>(data)),
+          mSize(size), mCallback(callback), mUser(user), mOwned(copy),
+          mChunkContainer(mData, size) {
+}
+
+FMaterialLibrary::~FMaterialLibrary() noexcept {
+    if (mOwned) {
+        free(mData);
+    } else if (mCallback) {
+        mCallback(mData, mSize, mUser);
+    }
+}
+
+bool FMaterialLibrary::parse(FEngine& engine) noexcept {
+    ChunkContainer& cc = mChunkContainer;
+    if (!cc.parse() || !cc.hasChunk(ChunkType::MaterialVersion) ||
+            !cc.hasChunk(ChunkType::MaterialLibrary)) {
+        return false;
+    }
+
+    uint32_t version = 0;
+    Unflattener versionReader(cc.getChunkStart(ChunkType::MaterialVersion),
+            cc.getChunkEnd(ChunkType::MaterialVersion));
+    if (!versionReader.read(&version) || version != MATERIAL_VERSION) {
+        slog.e << "Material library version mismatch. Expected " << MATERIAL_VERSION
+               << " but received " << version << "." << io::endl;
+        return false;
+    }
+
+    // the dictionary is only read for the backend in use, materials only reference it
+    const ChunkType dictionaryTag = MaterialParser::getDictionaryChunkType(engine.getBackend());
+    if (!cc.hasChunk(dictionaryTag)) {
+        slog.e << "The material library was not built for this backend." << io::endl;
+        return false;
+    }
+    if (!DictionaryReader::unflatten(cc, dictionaryTag, mDictionary)) {
+        return false;
+    }
+    const uint8_t* dictionaryStart = cc.getChunkStart(dictionaryTag);
+    mDictionaryHash = hash::murmur64(dictionaryStart,
+            cc.getChunkEnd(dictionaryTag) - dictionaryStart, 0);
+
+    Unflattener unflattener(cc.getChunkStart(ChunkType::MaterialLibrary),
+            cc.getChunkEnd(ChunkType::MaterialLibrary));
+    uint32_t count = 0;
+    if (!unflattener.read(&count)) {
+        return false;
+    }
+    mMaterials.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        Entry entry{};
+        if (!unflattener.read(&entry.name) || !unflattener.read(&entry.data, &entry.size)) {
+            return false;
+        }
+        mMaterials.push_back(entry);
+    }
+    return true;
+}
+
+size_t FMaterialLibrary::getMaterialIndex(const char* name) const noexcept {
+    for (size_t i = 0, c = mMaterials.size(); i < c; i++) {
+        if (!strcmp(mMaterials[i].name, name)) {
+            return i;
+        }
+    }
+    return INVALID_INDEX;
+}
+
+} // namespace details
+
+// ------------------------------------------------------------------------------------------------
+// Trampoline calling into private implementation
+// ------------------------------------------------------------------------------------------------
+
+using namespace details;
+
+size_t MaterialLibrary::getMaterialCount() const noexcept {
+    return upcast(this)->getMaterialCount();
+}
+
+const char* MaterialLibrary::getMaterialName(size_t index) const noexcept {
+    return upcast(this)->getMaterialName(index);
+}
+
+size_t MaterialLibrary::getMaterialIndex(const char* name) const noexcept {
+    return upcast(this)->getMaterialIndex(name);
+}
+
+} // namespace filament
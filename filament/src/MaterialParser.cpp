@@ -42,29 +42,13 @@ namespace filament {
 
 // ------------------------------------------------------------------------------------------------
 
-MaterialParser::MaterialParserDetails::MaterialParserDetails(Backend backend, const void* data, size_t size)
-        : mManagedBuffer(data, size),
+MaterialParser::MaterialParserDetails::MaterialParserDetails(Backend backend,
+        const void* data, size_t size, bool copy, Callback callback, void* user)
+        : mManagedBuffer(data, size, copy, callback, user),
           mChunkContainer(mManagedBuffer.data(), mManagedBuffer.size()),
-          mMaterialChunk(mChunkContainer) {
-    switch (backend) {
-        case Backend::OPENGL:
-            mMaterialTag = ChunkType::MaterialGlsl;
-            mDictionaryTag = ChunkType::DictionaryGlsl;
-            break;
-        case Backend::METAL:
-            mMaterialTag = ChunkType::MaterialMetal;
-            mDictionaryTag = ChunkType::DictionaryMetal;
-            break;
-        case Backend::VULKAN:
-            mMaterialTag = ChunkType::MaterialSpirv;
-            mDictionaryTag = ChunkType::DictionarySpirv;
-            break;
-        default:
-            // this is for testing purpose -- for e.g.: with the NoopDriver
-            mMaterialTag = ChunkType::MaterialGlsl;
-            mDictionaryTag = ChunkType::DictionaryGlsl;
-            break;
-    }
+          mMaterialChunk(mChunkContainer),
+          mMaterialTag(getMaterialChunkType(backend)),
+          mDictionaryTag(getDictionaryChunkType(backend)) {
 }
 
 template<typename T>
@@ -81,7 +65,12 @@ bool MaterialParser::MaterialParserDetails::getFromSimpleChunk(filamat::ChunkTyp
 // ------------------------------------------------------------------------------------------------
 
 MaterialParser::MaterialParser(Backend backend, const void* data, size_t size)
-        : mImpl(backend, data, size) {
+        : mImpl(backend, data, size, true, nullptr, nullptr) {
+}
+
+MaterialParser::MaterialParser(Backend backend, const void* data, size_t size,
+        Callback callback, void* user)
+        : mImpl(backend, data, size, false, callback, user) {
 }
 
 ChunkContainer& MaterialParser::getChunkContainer() noexcept {
@@ -92,14 +81,47 @@ ChunkContainer const& MaterialParser::getChunkContainer() const noexcept {
     return mImpl.mChunkContainer;
 }
 
+ChunkType MaterialParser::getMaterialChunkType(Backend backend) noexcept {
+    switch (backend) {
+        case Backend::METAL:
+            return ChunkType::MaterialMetal;
+        case Backend::VULKAN:
+            return ChunkType::MaterialSpirv;
+        default:
+            // OPENGL, or for testing purpose -- for e.g.: with the NoopDriver
+            return ChunkType::MaterialGlsl;
+    }
+}
+
+ChunkType MaterialParser::getDictionaryChunkType(Backend backend) noexcept {
+    switch (backend) {
+        case Backend::METAL:
+            return ChunkType::DictionaryMetal;
+        case Backend::VULKAN:
+            return ChunkType::DictionarySpirv;
+        default:
+            // OPENGL, or for testing purpose -- for e.g.: with the NoopDriver
+            return ChunkType::DictionaryGlsl;
+    }
+}
+
+void MaterialParser::setSharedDictionary(BlobDictionary const* dictionary) noexcept {
+    mImpl.mSharedDictionary = dictionary;
+}
+
 bool MaterialParser::parse() noexcept {
     ChunkContainer& cc = getChunkContainer();
     if (cc.parse()) {
-        if (!cc.hasChunk(mImpl.mMaterialTag) || !cc.hasChunk(mImpl.mDictionaryTag)) {
+        if (!cc.hasChunk(mImpl.mMaterialTag)) {
             return false;
         }
-        if (!DictionaryReader::unflatten(cc, mImpl.mDictionaryTag, mImpl.mBlobDictionary)) {
-            return false;
+        if (!mImpl.mSharedDictionary) {
+            if (!cc.hasChunk(mImpl.mDictionaryTag)) {
+                return false;
+            }
+            if (!DictionaryReader::unflatten(cc, mImpl.mDictionaryTag, mImpl.mBlobDictionary)) {
+                return false;
+            }
         }
         if (!mImpl.mMaterialChunk.readIndex(mImpl.mMaterialTag)) {
             return false;
@@ -260,8 +282,15 @@ bool MaterialParser::getRequiredAttributes(AttributeBitset* value) const noexcep
 
 bool MaterialParser::getShader(ShaderBuilder& shader,
         ShaderModel shaderModel, uint8_t variant, ShaderType stage) noexcept {
+    BlobDictionary const& dictionary = mImpl.mSharedDictionary ?
+            *mImpl.mSharedDictionary : mImpl.mBlobDictionary;
     return mImpl.mMaterialChunk.getShader(shader,
-            mImpl.mBlobDictionary, (uint8_t)shaderModel, variant, stage);
+            dictionary, (uint8_t)shaderModel, variant, stage);
+}
+
+bool MaterialParser::hasShader(ShaderModel shaderModel,
+        uint8_t variant, ShaderType stage) const noexcept {
+    return mImpl.mMaterialChunk.hasShader((uint8_t)shaderModel, variant, stage);
 }
 
 // ------------------------------------------------------------------------------------------------
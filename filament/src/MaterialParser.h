@@ -22,6 +22,7 @@
 #include <filaflat/MaterialChunk.h>
 
 #include <filament/MaterialEnums.h>
+#include <backend/BufferDescriptor.h>
 #include <backend/DriverEnums.h>
 #include <filament/MaterialChunkType.h>
 
@@ -43,11 +44,23 @@ class SamplerInterfaceBlock;
 
 class MaterialParser {
 public:
+    using Callback = backend::BufferDescriptor::Callback;
+
+    // the material data is copied
     MaterialParser(backend::Backend backend, const void* data, size_t size);
 
+    // the material data is used in place, it must stay valid until callback is called, which
+    // happens when the MaterialParser is destroyed. callback can be null, e.g. for static data.
+    MaterialParser(backend::Backend backend, const void* data, size_t size,
+            Callback callback, void* user);
+
     MaterialParser(MaterialParser const& rhs) noexcept = delete;
     MaterialParser& operator=(MaterialParser const& rhs) noexcept = delete;
 
+    // Use the shaders dictionary of a material library, which must outlive this MaterialParser.
+    // This must be called before parse(), the package itself then has no dictionary.
+    void setSharedDictionary(filaflat::BlobDictionary const* dictionary) noexcept;
+
     bool parse() noexcept;
     bool isShadingMaterial() const noexcept;
     bool isPostProcessMaterial() const noexcept;
@@ -84,9 +97,17 @@ public:
     bool getShader(filaflat::ShaderBuilder& shader, backend::ShaderModel shaderModel,
             uint8_t variant, backend::ShaderType stage) noexcept;
 
+    bool hasShader(backend::ShaderModel shaderModel,
+            uint8_t variant, backend::ShaderType stage) const noexcept;
+
+    // The chunks holding the shaders and their dictionary for a given backend.
+    static filamat::ChunkType getMaterialChunkType(backend::Backend backend) noexcept;
+    static filamat::ChunkType getDictionaryChunkType(backend::Backend backend) noexcept;
+
 private:
     struct MaterialParserDetails {
-        MaterialParserDetails(backend::Backend backend, const void* data, size_t size);
+        MaterialParserDetails(backend::Backend backend, const void* data, size_t size,
+                bool copy, Callback callback, void* user);
 
         template<typename T>
         bool getFromSimpleChunk(filamat::ChunkType type, T* value) const noexcept;
@@ -97,12 +118,26 @@ private:
         class ManagedBuffer {
             void* mStart = nullptr;
             size_t mSize = 0;
+            Callback mCallback = nullptr;
+            void* mUser = nullptr;
+            bool mOwned = false;
         public:
-            explicit ManagedBuffer(const void* start, size_t size)
-                    : mStart(malloc(size)), mSize(size) {
-                memcpy(mStart, start, size);
+            ManagedBuffer(const void* start, size_t size,
+                    bool copy, Callback callback, void* user)
+                    : mStart(const_cast<void*>(start)), mSize(size),
+                      mCallback(callback), mUser(user), mOwned(copy) {
+                if (copy) {
+                    mStart = malloc(size);
+                    memcpy(mStart, start, size);
+                }
+            }
+            ~ManagedBuffer() noexcept {
+                if (mOwned) {
+                    free(mStart);
+                } else if (mCallback) {
+                    mCallback(mStart, mSize, mUser);
+                }
             }
-            ~ManagedBuffer() noexcept { free(mStart); }
             ManagedBuffer(ManagedBuffer const& rhs) = delete;
             ManagedBuffer& operator=(ManagedBuffer const& rhs) = delete;
             void* data() const noexcept { return mStart; }
@@ -117,6 +152,7 @@ private:
         // Keep MaterialChunk alive between calls to getShader to avoid reload the shader index.
         filaflat::MaterialChunk mMaterialChunk;
         filaflat::BlobDictionary mBlobDictionary;
+        filaflat::BlobDictionary const* mSharedDictionary = nullptr;
         filamat::ChunkType mMaterialTag = filamat::ChunkType::Unknown;
         filamat::ChunkType mDictionaryTag = filamat::ChunkType::Unknown;
     };
@@ -310,13 +310,18 @@ void RenderPass::generateCommandsImpl(uint32_t extraFlags,
     const bool depthContainsShadowCasters = bool(extraFlags & CommandTypeFlags::DEPTH_CONTAINS_SHADOW_CASTERS);
     const bool depthFilterTranslucentObjects = bool(extraFlags & CommandTypeFlags::DEPTH_FILTER_TRANSLUCENT_OBJECTS);
     const bool depthFilterAlphaMaskedObjects = bool(extraFlags & CommandTypeFlags::DEPTH_FILTER_ALPHA_MASKED_OBJECTS);
+    const bool depthFilterStaticCasters = bool(extraFlags & CommandTypeFlags::DEPTH_FILTER_STATIC_SHADOW_CASTERS);
+    const bool depthFilterDynamicCasters = bool(extraFlags & CommandTypeFlags::DEPTH_FILTER_DYNAMIC_SHADOW_CASTERS);
+    const bool depthFilterShadowTile = bool(extraFlags & CommandTypeFlags::DEPTH_FILTER_SHADOW_TILE);
 
     auto const* const UTILS_RESTRICT soaWorldAABBCenter = soa.data<FScene::WORLD_AABB_CENTER>();
     auto const* const UTILS_RESTRICT soaVisibility      = soa.data<FScene::VISIBILITY_STATE>();
     auto const* const UTILS_RESTRICT soaPrimitives      = soa.data<FScene::PRIMITIVES>();
     auto const* const UTILS_RESTRICT soaBonesUbh        = soa.data<FScene::BONES_UBH>();
+    auto const* const UTILS_RESTRICT soaVisibleMask     = soa.data<FScene::VISIBLE_MASK>();
+    auto const* const UTILS_RESTRICT soaUboSlot         = soa.data<FScene::UBO_SLOT>();
 
-    const bool hasShadowing = renderFlags & HAS_SHADOWING;
+    const bool hasShadowing = renderFlags & (HAS_SHADOWING | HAS_LOCAL_SHADOWING);
     const bool inverseFrontFaces = renderFlags & HAS_INVERSE_FRONT_FACES;
 
     Variant materialVariant;
@@ -367,7 +372,7 @@ void RenderPass::generateCommandsImpl(uint32_t extraFlags,
         const uint32_t distanceBits = reinterpret_cast<uint32_t&>(distance);
 
         cmdColor.key = makeField(soaVisibility[i].priority, PRIORITY_MASK, PRIORITY_SHIFT);
-        cmdColor.primitive.index = (uint16_t)i;
+        cmdColor.primitive.index = (uint16_t)soaUboSlot[i];
         cmdColor.primitive.perRenderableBones = soaBonesUbh[i];
         materialVariant.setShadowReceiver(soaVisibility[i].receiveShadows & hasShadowing);
         materialVariant.setSkinning(soaVisibility[i].skinning);
@@ -377,12 +382,17 @@ void RenderPass::generateCommandsImpl(uint32_t extraFlags,
         cmdDepth.key = uint64_t(Pass::DEPTH);
         cmdDepth.key |= makeField(soaVisibility[i].priority, PRIORITY_MASK, PRIORITY_SHIFT);
         cmdDepth.key |= makeField(distanceBits, DISTANCE_BITS_MASK, DISTANCE_BITS_SHIFT);
-        cmdDepth.primitive.index = (uint16_t)i;
+        cmdDepth.primitive.index = (uint16_t)soaUboSlot[i];
         cmdDepth.primitive.perRenderableBones = soaBonesUbh[i];
         cmdDepth.primitive.materialVariant.setSkinning(soaVisibility[i].skinning);
 
         const bool shadowCaster = soaVisibility[i].castShadows & hasShadowing;
         const bool writeDepthForShadowCasters = depthContainsShadowCasters & shadowCaster;
+        const bool staticShadowCaster = soaVisibility[i].staticShadowCaster;
+        const bool filterDepth = (depthFilterStaticCasters & staticShadowCaster)
+                               | (depthFilterDynamicCasters & !staticShadowCaster)
+                               | (depthFilterShadowTile &
+                                       !(soaVisibleMask[i] & (1u << FScene::VISIBLE_SHADOW_TILE_BIT)));
 
         const Slice<FRenderPrimitive>& primitives = soaPrimitives[i];
 
@@ -492,7 +502,7 @@ void RenderPass::generateCommandsImpl(uint32_t extraFlags,
                         & !(depthFilterAlphaMaskedObjects & rs.alphaToCoverage))
                                 | writeDepthForShadowCasters;
 
-                curr->key |= select(!issueDepth);
+                curr->key |= select(!issueDepth | filterDepth);
 
                 // handle the case where this primitive is empty / no-op
                 curr->key |= select(primitive.getPrimitiveType() == PrimitiveType::NONE);
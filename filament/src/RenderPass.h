@@ -95,13 +95,26 @@ public:
         DEPTH_FILTER_TRANSLUCENT_OBJECTS = 0x8,
         // alpha-tested objects are not rendered in the depth buffer
         DEPTH_FILTER_ALPHA_MASKED_OBJECTS = 0x10,
+        // static shadow casters are not rendered in the depth buffer
+        DEPTH_FILTER_STATIC_SHADOW_CASTERS = 0x20,
+        // dynamic (i.e. non static) shadow casters are not rendered in the depth buffer
+        DEPTH_FILTER_DYNAMIC_SHADOW_CASTERS = 0x40,
+        // shadow casters outside of the current shadow atlas tile are not rendered in the depth
+        // buffer (see FScene::VISIBLE_SHADOW_TILE_BIT)
+        DEPTH_FILTER_SHADOW_TILE = 0x80,
 
 
         // generate commands for color with depth pre-pass -- in this case, we want to put
         // objects that use alpha-testing or blending in the depth prepass.
         COLOR_WITH_DEPTH_PREPASS = DEPTH | COLOR | DEPTH_FILTER_TRANSLUCENT_OBJECTS | DEPTH_FILTER_ALPHA_MASKED_OBJECTS,
         // generate commands for shadow map
-        SHADOW = DEPTH | DEPTH_CONTAINS_SHADOW_CASTERS
+        SHADOW = DEPTH | DEPTH_CONTAINS_SHADOW_CASTERS,
+        // generate commands for the static shadow casters cache only
+        SHADOW_STATIC_CASTERS = SHADOW | DEPTH_FILTER_DYNAMIC_SHADOW_CASTERS,
+        // generate commands for the shadow map, minus the cached static shadow casters
+        SHADOW_DYNAMIC_CASTERS = SHADOW | DEPTH_FILTER_STATIC_SHADOW_CASTERS,
+        // generate commands for a tile of the shadow atlas
+        SHADOW_TILE = SHADOW | DEPTH_FILTER_SHADOW_TILE
     };
 
 
@@ -216,6 +229,7 @@ public:
     static constexpr RenderFlags HAS_DIRECTIONAL_LIGHT   = 0x02;
     static constexpr RenderFlags HAS_DYNAMIC_LIGHTING    = 0x04;
     static constexpr RenderFlags HAS_INVERSE_FRONT_FACES = 0x08;
+    static constexpr RenderFlags HAS_LOCAL_SHADOWING     = 0x10;
 
 
     RenderPass(FEngine& engine, utils::GrowingSlice<Command>& commands) noexcept;
@@ -208,6 +208,7 @@ void FRenderer::renderJob(ArenaScope& arena, FView& view) {
     RenderPass::RenderFlags renderFlags = 0;
     if (view.hasShadowing())               renderFlags |= RenderPass::HAS_SHADOWING;
     if (view.hasDirectionalLight())        renderFlags |= RenderPass::HAS_DIRECTIONAL_LIGHT;
+    if (view.hasLocalShadowing())          renderFlags |= RenderPass::HAS_LOCAL_SHADOWING;
     if (view.hasDynamicLighting())         renderFlags |= RenderPass::HAS_DYNAMIC_LIGHTING;
     if (view.isFrontFaceWindingInverted()) renderFlags |= RenderPass::HAS_INVERSE_FRONT_FACES;
     pass.setRenderFlags(renderFlags);
@@ -222,6 +223,11 @@ void FRenderer::renderJob(ArenaScope& arena, FView& view) {
         commands.clear();
     }
 
+    if (view.hasLocalShadowing()) {
+        view.getShadowAtlas().render(driver, pass, view);
+        commands.clear();
+    }
+
     /*
      * Frame graph
      */
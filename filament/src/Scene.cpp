@@ -24,15 +24,20 @@
 #include "details/Culler.h"
 #include "details/Engine.h"
 #include "details/IndirectLight.h"
+#include "details/ShadowAtlas.h"
 #include "details/Skybox.h"
 
 #include <utils/compiler.h>
 #include <utils/EntityManager.h>
+#include <utils/Hash.h>
+#include <utils/JobSystem.h>
 #include <utils/Range.h>
 #include <utils/Zip2Iterator.h>
 
 #include <algorithm>
 
+#include <string.h>
+
 using namespace filament::math;
 using namespace utils;
 
@@ -95,6 +100,12 @@ void FScene::prepare(const mat4f& worldOriginTransform) {
     // find the max intensity directional light index in our local array
     float maxIntensity = 0.0f;
 
+    // signature of the static shadow casters, used to invalidate the shadow map cache
+    uint32_t staticShadowCastersHash = 0;
+
+    // the world transforms are rigid only if the world origin transform is too
+    const bool worldOriginRigid = FTransformManager::isRigidTransform(worldOriginTransform);
+
     for (Entity e : entities) {
         if (!em.isAlive(e))
             continue;
@@ -116,15 +127,29 @@ void FScene::prepare(const mat4f& worldOriginTransform) {
             // compute the world AABB so we can perform culling
             const Box worldAABB = rigidTransform(rcm.getAABB(ri), worldTransform);
 
+            const FRenderableManager::Visibility visibility = rcm.getVisibility(ri);
+            const uint8_t layers = rcm.getLayerMask(ri);
+            if (UTILS_UNLIKELY(visibility.castShadows && visibility.staticShadowCaster)) {
+                // this uses the transform without the world origin, which changes with the camera
+                const mat4f& model = tcm.getWorldTransform(ti);
+                const uint32_t key = layers;
+                staticShadowCastersHash = hash::murmur3(
+                        reinterpret_cast<const uint32_t*>(&model), sizeof(model) / 4,
+                        staticShadowCastersHash);
+                staticShadowCastersHash = hash::murmur3(&key, 1, staticShadowCastersHash);
+            }
+
             // we know there is enough space in the array
             sceneData.push_back_unsafe(
                     ri,
                     worldTransform,
-                    rcm.getVisibility(ri),
+                    visibility,
                     rcm.getBonesUbh(ri),
                     worldAABB.center,
                     0,
-                    rcm.getLayerMask(ri),
+                    0,
+                    worldOriginRigid && tcm.isWorldTransformRigid(ti),
+                    layers,
                     worldAABB.halfExtent,
                     {}, {});
         }
@@ -162,45 +187,295 @@ void FScene::prepare(const mat4f& worldOriginTransform) {
     for (size_t i = lightData.size(), e = (lightData.size() + 3) & ~3; i < e; i++) {
         new(lightData.data<POSITION_RADIUS>() + i) float4{ 0, 0, 0, 1 };
     }
+
+    mStaticShadowCastersHash = staticShadowCastersHash;
 }
 
-void FScene::updateUBOs(utils::Range<uint32_t> visibleRenderables, backend::Handle<backend::HwUniformBuffer> renderableUbh) noexcept {
-    FEngine::DriverApi& driver = mEngine.getDriverApi();
-    const size_t size = visibleRenderables.size() * sizeof(PerRenderableUib);
+// Computes the normal matrices of a batch of renderables, with the columns of their upper-left
+// 3x3 matrices stored in SoA form, i.e. c[column][component][renderable].
+//
+// Using the inverse-transpose handles non-uniform scaling, but DOESN'T guarantee that
+// the transformed normals will have unit-length, therefore they need to be normalized
+// in the shader (that's already the case anyways, since normalization is needed after
+// interpolation).
+//
+// We pre-scale normals by the inverse of the largest scale factor to avoid
+// large post-transform magnitudes in the shader, especially in the fragment shader, where
+// we use medium precision.
+//
+// The inverse-transpose is the cofactor matrix divided by the determinant, since we normalize
+// it anyways, only the sign of the determinant matters: the columns of the normal matrix are
+// sign(det) * (c1 x c2, c2 x c0, c0 x c1), scaled by the inverse of the longest one.
+template<size_t N>
+static inline void computeNormalMatrices(
+        float const (& UTILS_RESTRICT c)[3][3][N],
+        float (& UTILS_RESTRICT n)[3][3][N]) noexcept {
+    #pragma clang loop vectorize(enable) interleave(disable)
+    for (size_t k = 0; k < N; k++) {
+        // cofactors
+        float r[3][3];
+        for (size_t j = 0; j < 3; j++) {
+            float const* a = &c[(j + 1) % 3][0][0];
+            float const* b = &c[(j + 2) % 3][0][0];
+            r[j][0] = a[1 * N + k] * b[2 * N + k] - a[2 * N + k] * b[1 * N + k];
+            r[j][1] = a[2 * N + k] * b[0 * N + k] - a[0 * N + k] * b[2 * N + k];
+            r[j][2] = a[0 * N + k] * b[1 * N + k] - a[1 * N + k] * b[0 * N + k];
+        }
+        const float det = c[0][0][k] * r[0][0] + c[0][1][k] * r[0][1] + c[0][2][k] * r[0][2];
+        const float l0 = r[0][0] * r[0][0] + r[0][1] * r[0][1] + r[0][2] * r[0][2];
+        const float l1 = r[1][0] * r[1][0] + r[1][1] * r[1][1] + r[1][2] * r[1][2];
+        const float l2 = r[2][0] * r[2][0] + r[2][1] * r[2][1] + r[2][2] * r[2][2];
+        const float s = 1.0f / std::sqrt(std::max(l0, std::max(l1, l2)));
+        const float scale = det < 0 ? -s : s;
+        for (size_t j = 0; j < 3; j++) {
+            for (size_t i = 0; i < 3; i++) {
+                n[j][i][k] = r[j][i] * scale;
+            }
+        }
+    }
+}
 
-    // allocate space into the command stream directly
-    void* const buffer = driver.allocate(size);
+// For rigid transforms, the normal matrix is just the upper-left 3x3 matrix scaled by the
+// inverse of the length of its columns.
+template<size_t N>
+static inline void computeRigidNormalMatrices(
+        float const (& UTILS_RESTRICT c)[3][3][N],
+        float (& UTILS_RESTRICT n)[3][3][N]) noexcept {
+    #pragma clang loop vectorize(enable) interleave(disable)
+    for (size_t k = 0; k < N; k++) {
+        const float l = c[0][0][k] * c[0][0][k] + c[0][1][k] * c[0][1][k] +
+                c[0][2][k] * c[0][2][k];
+        const float s = 1.0f / std::sqrt(l);
+        for (size_t j = 0; j < 3; j++) {
+            for (size_t i = 0; i < 3; i++) {
+                n[j][i][k] = c[j][i][k] * s;
+            }
+        }
+    }
+}
+
+void FScene::updateNormalMatrices(RenderableSoa const& soa, RenderableUbo& renderableUbo,
+        uint32_t const* dirty, size_t count) noexcept {
+    constexpr size_t BATCH = 8;
+    mat4f const* const UTILS_RESTRICT worldTransforms = soa.data<WORLD_TRANSFORM>();
+    bool const* const UTILS_RESTRICT rigidTransforms = soa.data<RIGID_TRANSFORM>();
+    uint32_t const* const UTILS_RESTRICT uboSlots = soa.data<UBO_SLOT>();
+
+    // Rigid and non-rigid transforms are gathered in separate batches, so that the cofactors
+    // are only computed for the non-rigid ones. Unused entries of a batch keep their previous
+    // values which are always valid (or the identity).
+    struct Batch {
+        float c[3][3][BATCH];
+        uint32_t renderables[BATCH];
+        size_t count = 0;
+    } batches[2];
+    for (Batch& batch : batches) {
+        for (size_t j = 0; j < 3; j++) {
+            for (size_t i = 0; i < 3; i++) {
+                std::fill_n(batch.c[j][i], BATCH, i == j ? 1.0f : 0.0f);
+            }
+        }
+    }
+
+    auto flush = [&](Batch& batch, bool rigid) {
+        float n[3][3][BATCH];
+        if (rigid) {
+            computeRigidNormalMatrices(batch.c, n);
+        } else {
+            computeNormalMatrices(batch.c, n);
+        }
+
+        // scatter the results to the UBO
+        for (size_t k = 0; k < batch.count; k++) {
+            const uint32_t slot = uboSlots[batch.renderables[k]];
+            mat3f m;
+            for (size_t j = 0; j < 3; j++) {
+                m[j] = float3{ n[j][0][k], n[j][1][k], n[j][2][k] };
+            }
+            UniformBuffer::setUniform(renderableUbo.getSlotData(slot),
+                    offsetof(PerRenderableUib, worldFromModelNormalMatrix), m);
+        }
+        batch.count = 0;
+    };
+
+    for (size_t index = 0; index < count; index++) {
+        // gather the upper-left 3x3 matrices
+        const uint32_t renderable = dirty[index];
+        const bool rigid = rigidTransforms[renderable];
+        Batch& batch = batches[rigid];
+        mat4f const& model = worldTransforms[renderable];
+        const size_t k = batch.count++;
+        for (size_t j = 0; j < 3; j++) {
+            for (size_t i = 0; i < 3; i++) {
+                batch.c[j][i][k] = model[j][i];
+            }
+        }
+        batch.renderables[k] = renderable;
+        if (batch.count == BATCH) {
+            flush(batch, rigid);
+        }
+    }
+    for (bool rigid : { false, true }) {
+        if (batches[rigid].count) {
+            flush(batches[rigid], rigid);
+        }
+    }
+}
 
+void FScene::updateUBOs(utils::Range<uint32_t> visibleRenderables,
+        RenderableUbo& renderableUbo) noexcept {
+    FEngine& engine = mEngine;
+    FEngine::DriverApi& driver = engine.getDriverApi();
     auto& sceneData = mRenderableData;
+
+    renderableUbo.assignSlots(sceneData);
+
+    // find the renderables whose transform changed, and update their model matrix
+    auto& dirtySlots = renderableUbo.mDirtySlots;
+    auto& dirtyRenderables = renderableUbo.mDirtyRenderables;
+    dirtyRenderables.clear();
     for (uint32_t i : visibleRenderables) {
         mat4f const& model = sceneData.elementAt<WORLD_TRANSFORM>(i);
-        const size_t offset = i * sizeof(PerRenderableUib);
+        const uint32_t slot = sceneData.elementAt<UBO_SLOT>(i);
+        void* const data = renderableUbo.getSlotData(slot);
+
+        // most renderables don't move, in which case their slot is already up-to-date
+        auto& info = renderableUbo.mSlots[slot];
+        if (info.valid && !memcmp(static_cast<char const*>(data) +
+                offsetof(PerRenderableUib, worldFromModelMatrix), &model, sizeof(model))) {
+            continue;
+        }
+        info.valid = true;
+        dirtySlots.push_back(slot);
+        dirtyRenderables.push_back(i);
 
-        UniformBuffer::setUniform(buffer,
-                offset + offsetof(PerRenderableUib, worldFromModelMatrix),
+        UniformBuffer::setUniform(data,
+                offsetof(PerRenderableUib, worldFromModelMatrix),
                 model);
+    }
+
+    // then compute their normal matrices, in parallel if there are many of them
+    uint32_t const* const dirty = dirtyRenderables.data();
+    const uint32_t dirtyCount = uint32_t(dirtyRenderables.size());
+    if (dirtyCount < JOBS_PARALLEL_FOR_NORMAL_MATRICES_COUNT) {
+        updateNormalMatrices(sceneData, renderableUbo, dirty, dirtyCount);
+    } else {
+        auto work = [&sceneData, &renderableUbo, dirty](uint32_t startIndex, uint32_t count) {
+            updateNormalMatrices(sceneData, renderableUbo, dirty + startIndex, count);
+        };
+        JobSystem& js = engine.getJobSystem();
+        auto job = jobs::parallel_for(js, nullptr, 0, dirtyCount, std::cref(work),
+                jobs::CountSplitter<JOBS_PARALLEL_FOR_NORMAL_MATRICES_COUNT, 8>());
+        js.runAndWait(job);
+    }
+
+    renderableUbo.commit(driver);
+    mRenderableViewUbh = renderableUbo.getHandle();
+}
+
+void FScene::RenderableUbo::terminate(backend::DriverApi& driver) noexcept {
+    driver.destroyUniformBuffer(mUbh);
+    mUbh.clear();
+}
+
+void* FScene::RenderableUbo::getSlotData(uint32_t slot) noexcept {
+    return mBuffer.data() + slot * sizeof(PerRenderableUib);
+}
+
+void FScene::RenderableUbo::assignSlots(RenderableSoa& soa) noexcept {
+    const uint32_t frame = ++mFrame;
+    auto& instanceSlots = mInstanceSlots;
+    auto& slots = mSlots;
+
+    auto const* const instances = soa.data<RENDERABLE_INSTANCE>();
+    uint32_t* const uboSlots = soa.data<UBO_SLOT>();
+    for (size_t i = 0, c = soa.size(); i < c; i++) {
+        const uint32_t instance = instances[i].asValue();
+        if (UTILS_UNLIKELY(instance >= instanceSlots.size())) {
+            instanceSlots.resize(instance + 1u, 0);
+        }
+        uint32_t slot = instanceSlots[instance];
+        if (UTILS_UNLIKELY(!slot)) {
+            // this renderable was just added to the scene
+            if (!mFreeSlots.empty()) {
+                slot = mFreeSlots.back();
+                mFreeSlots.pop_back();
+            } else {
+                slot = uint32_t(slots.size());
+                slots.emplace_back();
+            }
+            slots[slot] = { instance, frame, false };
+            instanceSlots[instance] = slot + 1u;
+        } else {
+            slot = slot - 1u;
+            slots[slot].frame = frame;
+        }
+        uboSlots[i] = slot;
+    }
+
+    // release the slots of the renderables that are not in the scene anymore
+    for (uint32_t slot = 0, c = uint32_t(slots.size()); slot < c; slot++) {
+        Slot& info = slots[slot];
+        if (UTILS_UNLIKELY(info.instance && info.frame != frame)) {
+            instanceSlots[info.instance] = 0;
+            info = {};
+            mFreeSlots.push_back(slot);
+        }
+    }
 
-        // Using the inverse-transpose handles non-uniform scaling, but DOESN'T guarantee that
-        // the transformed normals will have unit-length, therefore they need to be normalized
-        // in the shader (that's already the case anyways, since normalization is needed after
-        // interpolation).
-        //
-        // We pre-scale normals by the inverse of the largest scale factor to avoid
-        // large post-transform magnitudes in the shader, especially in the fragment shader, where
-        // we use medium precision.
-        //
-        // Note: if the model matrix is known to be a rigid-transform, we could just use it directly.
-
-        mat3f m = transpose(inverse(model.upperLeft()));
-        m *= mat3f(1.0f / std::sqrt(max(float3{length2(m[0]), length2(m[1]), length2(m[2])})));
-
-        UniformBuffer::setUniform(buffer,
-                offset + offsetof(PerRenderableUib, worldFromModelNormalMatrix), m);
+    // the slots never shrink, so mBuffer is already large enough if mCapacity is
+    if (UTILS_UNLIKELY(slots.size() > mCapacity)) {
+        // allocate 1/3 extra, with a minimum of 16 objects
+        mCapacity = uint32_t(std::max(size_t(16u), (4u * slots.size() + 2u) / 3u));
+        mBuffer.resize(mCapacity * sizeof(PerRenderableUib));
+        mUploadAll = true;
+    }
+}
+
+void FScene::RenderableUbo::commit(backend::DriverApi& driver) noexcept {
+    constexpr size_t SLOT_SIZE = sizeof(PerRenderableUib);
+
+    if (UTILS_UNLIKELY(mUploadAll)) {
+        mUploadAll = false;
+        driver.destroyUniformBuffer(mUbh);
+        mUbh = driver.createUniformBuffer(mCapacity * SLOT_SIZE, backend::BufferUsage::DYNAMIC);
+        mDirtySlots.clear();
+        if (!mSlots.empty()) {
+            // the slots that aren't valid yet are uploaded too, that's okay.
+            const size_t size = mSlots.size() * SLOT_SIZE;
+            void* const buffer = driver.allocate(size);
+            memcpy(buffer, mBuffer.data(), size);
+            driver.updateUniformBuffer(mUbh, { buffer, size }, 0);
+        }
+        return;
     }
 
-    // TODO: handle static objects separately
-    mRenderableViewUbh = renderableUbh;
-    driver.loadUniformBuffer(renderableUbh, { buffer, size });
+    auto& dirtySlots = mDirtySlots;
+    if (dirtySlots.empty()) {
+        return;
+    }
+
+    // Upload the dirty slots in as few ranges as possible. A few clean slots between two dirty
+    // ones are uploaded as well, that's cheaper than issuing an extra command.
+    constexpr uint32_t MAX_CLEAN_SLOTS_IN_RANGE = 4;
+    std::sort(dirtySlots.begin(), dirtySlots.end());
+    auto upload = [&](uint32_t first, uint32_t last) {
+        const size_t size = (last - first + 1u) * SLOT_SIZE;
+        void* const buffer = driver.allocate(size);
+        memcpy(buffer, mBuffer.data() + first * SLOT_SIZE, size);
+        driver.updateUniformBuffer(mUbh, { buffer, size }, uint32_t(first * SLOT_SIZE));
+    };
+    uint32_t first = dirtySlots.front();
+    uint32_t last = first;
+    for (uint32_t slot : dirtySlots) {
+        if (slot - last > MAX_CLEAN_SLOTS_IN_RANGE + 1u) {
+            upload(first, last);
+            first = slot;
+        }
+        last = slot;
+    }
+    upload(first, last);
+    dirtySlots.clear();
 }
 
 void FScene::terminate(FEngine& engine) {
@@ -208,7 +483,9 @@ void FScene::terminate(FEngine& engine) {
     mRenderableViewUbh.clear();
 }
 
-void FScene::prepareDynamicLights(const CameraInfo& camera, ArenaScope& rootArena, backend::Handle<backend::HwUniformBuffer> lightUbh) noexcept {
+void FScene::prepareDynamicLights(const CameraInfo& camera, ArenaScope& rootArena,
+        backend::Handle<backend::HwUniformBuffer> lightUbh,
+        ShadowAtlas const& shadowAtlas) noexcept {
     FEngine::DriverApi& driver = mEngine.getDriverApi();
     FLightManager& lcm = mEngine.getLightManager();
     FScene::LightSoa& lightData = getLightData();
@@ -257,6 +534,7 @@ void FScene::prepareDynamicLights(const CameraInfo& camera, ArenaScope& rootAren
         lp[gpuIndex].colorIntensity       = { lcm.getColor(li), lcm.getIntensity(li) };
         lp[gpuIndex].directionIES         = { directions[i], 0 };
         lp[gpuIndex].spotScaleOffset.xy   = { lcm.getSpotParams(li).scaleOffset };
+        lp[gpuIndex].spotScaleOffset.zw   = shadowAtlas.getShadowParams(li);
     }
 
     driver.loadUniformBuffer(lightUbh, { lp, positionalLightCount * sizeof(LightsUib) });
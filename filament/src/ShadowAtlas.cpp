@@ -0,0 +1,358 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "details/ShadowAtlas.h"
+
+#include "components/LightManager.h"
+
+#include "details/Engine.h"
+#include "details/Scene.h"
+#include "details/ShadowMap.h"
+#include "details/View.h"
+
+#include "RenderPass.h"
+
+#include <private/filament/SibGenerator.h>
+
+#include <backend/DriverEnums.h>
+
+#include <utils/Systrace.h>
+
+#include <algorithm>
+#include <limits>
+
+using namespace filament::math;
+using namespace utils;
+
+namespace filament {
+using namespace backend;
+
+namespace details {
+
+// The near plane of the lights' cameras, relative to their radius. This is a trade-off between
+// depth precision and shadows of casters very close to the light being clipped.
+static constexpr float NEAR_PLANE_RATIO = 1.0f / 256.0f;
+
+// cube faces, in the order expected by the shaders: +x, -x, +y, -y, +z, -z
+static constexpr float3 CUBE_FACES[6] = {
+        {  1,  0,  0 }, { -1,  0,  0 },
+        {  0,  1,  0 }, {  0, -1,  0 },
+        {  0,  0,  1 }, {  0,  0, -1 },
+};
+
+static inline uint32_t floorPowerOfTwo(uint32_t x) noexcept {
+    uint32_t p = 1;
+    while (p <= x / 2) {
+        p *= 2;
+    }
+    return p;
+}
+
+ShadowAtlas::ShadowAtlas(FEngine& engine) noexcept :
+        mEngine(engine),
+        mClipSpaceFlipped(engine.getBackend() == Backend::VULKAN ||
+                          engine.getBackend() == Backend::METAL) {
+}
+
+ShadowAtlas::~ShadowAtlas() = default;
+
+void ShadowAtlas::terminate(DriverApi& driverApi) noexcept {
+    if (mAtlasRenderTarget) {
+        driverApi.destroyRenderTarget(mAtlasRenderTarget);
+    }
+    if (mAtlasHandle) {
+        driverApi.destroyTexture(mAtlasHandle);
+    }
+}
+
+void ShadowAtlas::update(FScene::LightSoa const& lightData, CameraInfo const& camera) noexcept {
+    SYSTRACE_CALL();
+
+    FLightManager const& lcm = mEngine.getLightManager();
+    auto const* UTILS_RESTRICT spheres    = lightData.data<FScene::POSITION_RADIUS>();
+    auto const* UTILS_RESTRICT directions = lightData.data<FScene::DIRECTION>();
+    auto const* UTILS_RESTRICT instances  = lightData.data<FScene::LIGHT_INSTANCE>();
+
+    auto& lights = mLights;
+    size_t lightCount = 0;
+    size_t tileCount = 0;
+
+    /*
+     * Gather the most important shadow casting lights, at most one per tile. A light's
+     * importance is an estimate of its coverage of the screen.
+     */
+
+    const float3 cameraPosition = camera.getPosition();
+    for (size_t i = FScene::DIRECTIONAL_LIGHTS_COUNT, c = lightData.size(); i < c; i++) {
+        FLightManager::Instance li = instances[i];
+        if (!lcm.isShadowCaster(li)) {
+            continue;
+        }
+        const float4 sphere = spheres[i];
+        const float d = length(sphere.xyz - cameraPosition);
+        const float importance = d <= sphere.w ? 1.0f : sphere.w / d;
+
+        size_t slot = lightCount;
+        if (lightCount == lights.size()) {
+            // we're full, replace the least important light if this one is more important
+            auto least = std::min_element(lights.begin(), lights.end(),
+                    [](ShadowLight const& lhs, ShadowLight const& rhs) {
+                        return lhs.importance < rhs.importance;
+                    });
+            if (least->importance >= importance) {
+                continue;
+            }
+            slot = size_t(least - lights.begin());
+        } else {
+            lightCount++;
+        }
+
+        const uint32_t mapSize = std::min(floorPowerOfTwo(lcm.getShadowMapSize(li)), ATLAS_SIZE);
+        const uint32_t size = floorPowerOfTwo(uint32_t(float(mapSize) * importance));
+        lights[slot] = {
+                .instance = li,
+                .sphere = sphere,
+                .direction = directions[i],
+                .importance = importance,
+                .size = clamp(size, MIN_TILE_SIZE, std::max(mapSize, MIN_TILE_SIZE)),
+                .tileCount = uint8_t(lcm.isPointLight(li) ? 6 : 1),
+        };
+    }
+
+    std::sort(lights.begin(), lights.begin() + lightCount,
+            [](ShadowLight const& lhs, ShadowLight const& rhs) {
+                return lhs.importance > rhs.importance;
+            });
+
+    // drop the least important lights that don't fit in the tiles budget
+    size_t kept = 0;
+    for (size_t i = 0; i < lightCount; i++) {
+        if (tileCount + lights[i].tileCount <= CONFIG_MAX_SHADOW_TILES) {
+            tileCount += lights[i].tileCount;
+            lights[kept++] = lights[i];
+        }
+    }
+    lightCount = kept;
+
+    // make the tiles fit in the atlas, by reducing the least important lights' tiles first
+    auto area = [&lights](size_t count) {
+        size_t a = 0;
+        for (size_t i = 0; i < count; i++) {
+            a += size_t(lights[i].size) * lights[i].size * lights[i].tileCount;
+        }
+        return a;
+    };
+    while (area(lightCount) > size_t(ATLAS_SIZE) * ATLAS_SIZE) {
+        auto first = lights.rbegin() + (lights.size() - lightCount);
+        auto it = std::find_if(first, lights.rend(),
+                [](ShadowLight const& light) { return light.size > MIN_TILE_SIZE; });
+        if (it != lights.rend()) {
+            it->size /= 2;
+        } else {
+            tileCount -= lights[--lightCount].tileCount;
+        }
+    }
+
+    /*
+     * Allocate the tiles. Tiles are power-of-two sized and laid out in Morton order from the
+     * largest to the smallest, which guarantees that they're aligned to their size and that
+     * they don't overlap.
+     */
+
+    std::stable_sort(lights.begin(), lights.begin() + lightCount,
+            [](ShadowLight const& lhs, ShadowLight const& rhs) {
+                return lhs.size > rhs.size;
+            });
+
+    uint32_t mortonIndex = 0;
+    size_t tile = 0;
+    for (size_t i = 0; i < lightCount; i++) {
+        ShadowLight& light = lights[i];
+        light.firstTile = uint8_t(tile);
+        const uint32_t units = light.size / MIN_TILE_SIZE;
+        if (light.tileCount == 1) {
+            // spot light, the cone's angle is the angle between the axis and the outer cone
+            const float cosOuter = std::sqrt(lcm.getCosOuterSquared(light.instance));
+            const float fov = 2.0f * std::acos(cosOuter) * float(180.0 / M_PI);
+            updateTile(mTiles[tile], mLightSpace[tile], light, light.direction,
+                    std::min(fov, 179.0f), getTilePosition(mortonIndex));
+            mortonIndex += units * units;
+            tile++;
+        } else {
+            for (float3 const& face : CUBE_FACES) {
+                updateTile(mTiles[tile], mLightSpace[tile], light, face,
+                        90.0f, getTilePosition(mortonIndex));
+                mortonIndex += units * units;
+                tile++;
+            }
+        }
+    }
+    assert(tile == tileCount);
+
+    mLightCount = lightCount;
+    mTileCount = tileCount;
+}
+
+void ShadowAtlas::updateTile(Tile& tile, mat4f& lightSpace, ShadowLight const& light,
+        float3 const& direction, float fov, float2 position) noexcept {
+    const float3 lightPosition = light.sphere.xyz;
+    const float far = light.sphere.w;
+    const float near = far * NEAR_PLANE_RATIO;
+
+    // pick an up vector that's not parallel to the light's direction
+    const float3 up = std::abs(direction.y) < 0.9f ? float3{ 0, 1, 0 } : float3{ 1, 0, 0 };
+    const mat4f model = mat4f::lookAt(lightPosition, lightPosition + direction, up);
+    const mat4f view = FCamera::rigidTransformInverse(model);
+    const mat4f projection = mat4f::perspective(fov, 1.0f, near, far);
+
+    tile.camera = {
+            .projection = projection,
+            .cullingProjection = projection,
+            .model = model,
+            .view = view,
+            .zn = near,
+            .zf = far,
+    };
+    tile.frustum = Frustum(projection * view);
+
+    // we set a viewport with a 1-texel border for when we index outside of the tile,
+    // see ShadowMap::prepare()
+    const uint32_t dim = light.size - 2;
+    tile.viewport = { int32_t(position.x) + 1, int32_t(position.y) + 1, dim, dim };
+
+    auto const& options = mEngine.getLightManager().getShadowOptions(light.instance);
+    tile.polygonOffset = {
+            .constant = options.polygonOffsetConstant,
+            .slope = options.polygonOffsetSlope
+    };
+
+    const mat4f Mt(ShadowMap::getTextureCoordsMapping(mClipSpaceFlipped));
+
+    // remapping from the tile to the atlas texture coordinates, when the clip space is flipped
+    // the texture's origin is at the top, but the viewport's is still at the bottom.
+    const float s = float(dim) / ATLAS_SIZE;
+    const float ox = float(tile.viewport.left) / ATLAS_SIZE;
+    const float oy = mClipSpaceFlipped ?
+            float(ATLAS_SIZE - tile.viewport.bottom - dim) / ATLAS_SIZE :
+            float(tile.viewport.bottom) / ATLAS_SIZE;
+    const mat4f Mb(mat4f::row_major_init{
+             s, 0, 0, ox,
+             0, s, 0, oy,
+             0, 0, 1, 0,
+             0, 0, 0, 1
+    });
+
+    lightSpace = Mb * Mt * projection * view;
+}
+
+float2 ShadowAtlas::getTilePosition(uint32_t index) noexcept {
+    // de-interleave the bits of the Morton index
+    auto compact = [](uint32_t x) -> uint32_t {
+        x &= 0x55555555u;
+        x = (x | (x >> 1u)) & 0x33333333u;
+        x = (x | (x >> 2u)) & 0x0F0F0F0Fu;
+        x = (x | (x >> 4u)) & 0x00FF00FFu;
+        x = (x | (x >> 8u)) & 0x0000FFFFu;
+        return x;
+    };
+    return float2{ compact(index), compact(index >> 1u) } * float(MIN_TILE_SIZE);
+}
+
+float2 ShadowAtlas::getShadowParams(FLightManager::Instance li) const noexcept {
+    for (size_t i = 0, c = mLightCount; i < c; i++) {
+        if (mLights[i].instance == li) {
+            const float bias = mEngine.getLightManager().getShadowConstantBias(li);
+            return { float(mLights[i].firstTile + 1), bias };
+        }
+    }
+    return {};
+}
+
+void ShadowAtlas::prepare(DriverApi& driver, SamplerGroup& sb) noexcept {
+    if (!mAtlasHandle) {
+        // the atlas is allocated the first time it's needed and kept around
+        mAtlasHandle = driver.createTexture(
+                SamplerType::SAMPLER_2D, 1, TextureFormat::DEPTH16, 1, ATLAS_SIZE, ATLAS_SIZE, 1,
+                TextureUsage::DEPTH_ATTACHMENT | TextureUsage::SAMPLEABLE);
+
+        mAtlasRenderTarget = driver.createRenderTarget(
+                TargetBufferFlags::DEPTH, ATLAS_SIZE, ATLAS_SIZE, 1,
+                {}, { mAtlasHandle }, {});
+    }
+
+    SamplerParams s;
+    s.filterMag = SamplerMagFilter::LINEAR;
+    s.filterMin = SamplerMinFilter::LINEAR;
+    s.compareFunc = SamplerCompareFunc::LE;
+    s.compareMode = SamplerCompareMode::COMPARE_TO_TEXTURE;
+    s.depthStencil = true;
+    sb.setSampler(PerViewSib::SHADOW_ATLAS, { mAtlasHandle, s });
+}
+
+void ShadowAtlas::render(DriverApi& driver, RenderPass& pass, FView& view) noexcept {
+    SYSTRACE_CALL();
+
+    FEngine& engine = mEngine;
+    JobSystem& js = engine.getJobSystem();
+    FScene& scene = *view.getScene();
+    FScene::RenderableSoa& soa = scene.getRenderableData();
+    FView::Range const visibleRenderables = view.getVisibleShadowCasters();
+    auto& commands = pass.getCommands();
+
+    // FIXME: in the future this will come from the framegraph
+    RenderPassParams params = {};
+    params.flags.clear = TargetBufferFlags::DEPTH;
+    params.flags.discardStart = TargetBufferFlags::DEPTH;
+    params.flags.discardEnd = TargetBufferFlags::COLOR_AND_STENCIL;
+    params.clearDepth = 1.0;
+    // clear the whole atlas once, including the tiles' borders
+    params.flags.clear |= RenderPassFlags::IGNORE_SCISSOR;
+
+    pass.setGeometry(scene, visibleRenderables);
+
+    // the tiles are processed one light at a time: culling and commands generation for each
+    // tile are spread across the JobSystem.
+    uint8_t* const visibleMask = soa.data<FScene::VISIBLE_MASK>();
+    constexpr uint8_t tileMask = 1u << FScene::VISIBLE_SHADOW_TILE_BIT;
+    for (size_t i = 0, c = mTileCount; i < c; i++) {
+        Tile const& tile = mTiles[i];
+
+        for (uint32_t index : visibleRenderables) {
+            visibleMask[index] &= ~tileMask;
+        }
+        FView::cullRenderables(js, soa, tile.frustum, FScene::VISIBLE_SHADOW_TILE_BIT);
+
+        pass.setCamera(tile.camera);
+        view.updatePrimitivesLod(engine, tile.camera, soa, visibleRenderables);
+        view.prepareCamera(tile.camera, tile.viewport);
+        view.commitUniforms(driver);
+
+        params.viewport = tile.viewport;
+        pass.overridePolygonOffset(&tile.polygonOffset);
+        const size_t first = commands.size();
+        pass.appendSortedCommands(RenderPass::SHADOW_TILE);
+        pass.execute("Shadow atlas Pass", mAtlasRenderTarget, params,
+                commands.begin() + first, commands.end());
+
+        // the next tiles are rendered on top of the previous ones
+        params.flags.clear = TargetBufferFlags::NONE;
+        params.flags.discardStart = TargetBufferFlags::NONE;
+    }
+    pass.overridePolygonOffset(nullptr);
+}
+
+} // namespace details
+} // namespace filament
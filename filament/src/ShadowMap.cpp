@@ -47,7 +47,9 @@ static constexpr bool ENABLE_LISPSM = true;
 ShadowMap::ShadowMap(FEngine& engine) noexcept :
         mEngine(engine),
         mClipSpaceFlipped(engine.getBackend() == Backend::VULKAN ||
-                          engine.getBackend() == Backend::METAL) {
+                          engine.getBackend() == Backend::METAL),
+        // the static casters cache relies on blitting depth buffers
+        mStaticCacheSupported(engine.getBackend() == Backend::OPENGL) {
     mCamera = mEngine.createCamera(EntityManager::get().create());
     mDebugCamera = mEngine.createCamera(EntityManager::get().create());
     FDebugRegistry& debugRegistry = engine.getDebugRegistry();
@@ -86,7 +88,7 @@ void ShadowMap::prepare(DriverApi& driver, SamplerGroup& sb) noexcept {
 
     uint32_t dim = mShadowMapDimension;
     uint32_t currentDimension = mViewport.width + 2;
-    if (currentDimension == dim) {
+    if (currentDimension == dim && bool(mStaticCacheRenderTarget) == mUseStaticCache) {
         // nothing to do here.
         assert(mShadowMapHandle);
         return;
@@ -99,6 +101,14 @@ void ShadowMap::prepare(DriverApi& driver, SamplerGroup& sb) noexcept {
     if (mShadowMapHandle) {
         driver.destroyTexture(mShadowMapHandle);
     }
+    if (mStaticCacheRenderTarget) {
+        driver.destroyRenderTarget(mStaticCacheRenderTarget);
+        mStaticCacheRenderTarget.clear();
+    }
+    if (mStaticCacheHandle) {
+        driver.destroyTexture(mStaticCacheHandle);
+        mStaticCacheHandle.clear();
+    }
 
     // allocate new ones...
     // we set a viewport with a 1-texel border for when we index outside of the texture
@@ -109,7 +119,6 @@ void ShadowMap::prepare(DriverApi& driver, SamplerGroup& sb) noexcept {
     // don't seem let us clear depth attachments to anything greater than 1.0, so we'd need a way to
     // do this other than clearing.
     mViewport = { 1, 1, dim - 2, dim - 2 };
-    mShadowMapResolution.xy = 1.0f / (dim - 2);
 
     // 16-bits seems enough. TODO: make it an option.
     TextureFormat format = TextureFormat::DEPTH16;
@@ -135,6 +144,19 @@ void ShadowMap::prepare(DriverApi& driver, SamplerGroup& sb) noexcept {
             TargetBufferFlags::DEPTH, dim, dim, 1,
             {}, { mShadowMapHandle }, {});
 
+    if (mUseStaticCache) {
+        // the static casters cache is only ever blitted into the shadow map
+        mStaticCacheHandle = driver.createTexture(
+                SamplerType::SAMPLER_2D, 1, format, 1, dim, dim, 1,
+                TextureUsage::DEPTH_ATTACHMENT);
+
+        mStaticCacheRenderTarget = driver.createRenderTarget(
+                TargetBufferFlags::DEPTH, dim, dim, 1,
+                {}, { mStaticCacheHandle }, {});
+
+        mStaticCache.dirty = true;
+    }
+
     SamplerParams s;
     s.filterMag = SamplerMagFilter::LINEAR;
     s.filterMin = SamplerMinFilter::LINEAR;
@@ -186,9 +208,34 @@ void ShadowMap::render(DriverApi& driver, RenderPass& pass, FView& view) noexcep
     view.commitUniforms(driver);
 
     pass.overridePolygonOffset(&mPolygonOffset);
-    pass.appendSortedCommands(RenderPass::SHADOW);
-    pass.execute("Shadow map Pass", getRenderTarget(), params,
-            pass.getCommands().begin(), pass.getCommands().end());
+    if (mUseStaticCache) {
+        auto& commands = pass.getCommands();
+        if (mStaticCache.dirty) {
+            const size_t first = commands.size();
+            pass.appendSortedCommands(RenderPass::SHADOW_STATIC_CASTERS);
+            pass.execute("Shadow map static casters Pass", mStaticCacheRenderTarget, params,
+                    commands.begin() + first, commands.end());
+            mStaticCache.dirty = false;
+        }
+
+        // start from the cached static casters and render the dynamic ones on top
+        const uint32_t dim = mShadowMapDimension;
+        driver.blit(TargetBufferFlags::DEPTH,
+                getRenderTarget(), { 0, 0, dim, dim },
+                mStaticCacheRenderTarget, { 0, 0, dim, dim },
+                SamplerMagFilter::NEAREST);
+
+        params.flags.clear = TargetBufferFlags::NONE;
+        params.flags.discardStart = TargetBufferFlags::NONE;
+        const size_t first = commands.size();
+        pass.appendSortedCommands(RenderPass::SHADOW_DYNAMIC_CASTERS);
+        pass.execute("Shadow map Pass", getRenderTarget(), params,
+                commands.begin() + first, commands.end());
+    } else {
+        pass.appendSortedCommands(RenderPass::SHADOW);
+        pass.execute("Shadow map Pass", getRenderTarget(), params,
+                pass.getCommands().begin(), pass.getCommands().end());
+    }
     pass.overridePolygonOffset(nullptr);
 }
 
@@ -199,6 +246,12 @@ void ShadowMap::terminate(DriverApi& driverApi) noexcept {
     if (mShadowMapHandle) {
         driverApi.destroyTexture(mShadowMapHandle);
     }
+    if (mStaticCacheRenderTarget) {
+        driverApi.destroyRenderTarget(mStaticCacheRenderTarget);
+    }
+    if (mStaticCacheHandle) {
+        driverApi.destroyTexture(mStaticCacheHandle);
+    }
 }
 
 void ShadowMap::update(
@@ -210,6 +263,7 @@ void ShadowMap::update(
 
     FLightManager::Instance li = lightData.elementAt<FScene::LIGHT_INSTANCE>(index);
     mShadowMapDimension = std::max(1u, lcm.getShadowMapSize(li));
+    mShadowMapResolution.xy = 1.0f / (mShadowMapDimension - 2);
 
     FLightManager::ShadowParams params = lcm.getShadowParams(li);
     mPolygonOffset = {
@@ -255,9 +309,18 @@ void ShadowMap::update(
     switch (lcm.getType(li)) {
         case Type::SUN:
         case Type::DIRECTIONAL:
-            computeShadowCameraDirectional(
-                    lightData.elementAt<FScene::DIRECTION>(index), scene, cameraInfo, params,
-                    visibleLayers);
+            mUseStaticCache = params.options.cacheStaticCasters && mStaticCacheSupported &&
+                              !mEngine.debug.shadowmap.checkerboard;
+            if (mUseStaticCache) {
+                computeShadowCameraDirectionalCached(
+                        lightData.elementAt<FScene::DIRECTION>(index), scene, cameraInfo, params,
+                        visibleLayers);
+            } else {
+                mStaticCache.valid = false;
+                computeShadowCameraDirectional(
+                        lightData.elementAt<FScene::DIRECTION>(index), scene, cameraInfo, params,
+                        visibleLayers);
+            }
             break;
         case Type::FOCUSED_SPOT:
         case Type::SPOT:
@@ -524,6 +587,133 @@ void ShadowMap::computeShadowCameraDirectional(
     }
 }
 
+void ShadowMap::computeShadowCameraDirectionalCached(
+        float3 const& dir, FScene const* scene, CameraInfo const& camera,
+        FLightManager::ShadowParams const& params,
+        uint8_t visibleLayers) noexcept {
+
+    /*
+     * The static shadow casters cache can only be reused if the light's camera doesn't change,
+     * so it can't depend on the view frustum. Instead we use an orthographic projection
+     * covering a sphere centered on the camera, large enough to contain the view frustum in any
+     * orientation and as long as the camera stays within staticCacheDistance of that center.
+     *
+     * The world origin follows the camera, so the cached state is kept in absolute world
+     * space and converted to the current world space each frame.
+     */
+
+    StaticCache& cache = mStaticCache;
+    const mat4f worldOriginInverse = FCamera::rigidTransformInverse(camera.worldOrigin);
+    const float3 wsCameraPosition = mat4f::project(worldOriginInverse, camera.getPosition());
+    const float3 wsDirection = normalize(worldOriginInverse.upperLeft() * dir);
+
+    bool invalidate = !cache.valid
+            || dot(wsDirection, cache.direction) < 0.99999f
+            || length(wsCameraPosition - cache.anchor) > params.options.staticCacheDistance
+            || scene->getStaticShadowCastersHash() != cache.castersHash
+            || visibleLayers != cache.visibleLayers
+            || !isStaticCacheCompatible(params.options, cache.options);
+
+    // the light's view matrix, if the cache was computed from here
+    const mat4f M = mat4f::lookAt(wsCameraPosition, wsCameraPosition + wsDirection,
+            float3{ 0, 1, 0 });
+    const mat4f Mv = invalidate ? FCamera::rigidTransformInverse(M) : cache.lightView;
+
+    // transforms from current world space to light space
+    const mat4f MvWo = Mv * worldOriginInverse;
+
+    // shadow casters near plane in light space
+    float nearZ = std::numeric_limits<float>::lowest();
+    bool hasCasters = false;
+    bool hasReceivers = false;
+    visitScene(*scene, visibleLayers,
+            [&nearZ, &hasCasters, &MvWo](Aabb caster) {
+                nearZ = std::max(nearZ, computeNearFar(MvWo, caster).x);
+                hasCasters = true;
+            },
+            [&hasReceivers](Aabb) {
+                hasReceivers = true;
+            }
+    );
+
+    if (!hasCasters || !hasReceivers) {
+        mHasVisibleShadows = false;
+        return;
+    }
+
+    // a dynamic shadow caster moved in front of the cached near plane
+    invalidate = invalidate || (-nearZ < cache.znear);
+
+    if (invalidate) {
+        // view frustum vertices in world-space
+        float3 wsViewFrustumVertices[8];
+        computeFrustumCorners(wsViewFrustumVertices,
+                camera.model * FCamera::inverseProjection(camera.projection));
+
+        float radius = 0.0f;
+        for (float3 const& v : wsViewFrustumVertices) {
+            radius = std::max(radius, length(v - camera.getPosition()));
+        }
+        radius += params.options.staticCacheDistance;
+
+        // The light is placed at the center of the sphere, so the sphere's bounds in light-space
+        // are simply [-radius, radius]. Casters closer to the light than the sphere can
+        // still shadow it, so the near plane comes from the shadow casters.
+        const float znear = std::min(-nearZ, -radius);
+        const float zfar = radius;
+
+        const mat4f Mp = directionalLightFrustum(znear, zfar);
+
+        float2 s = 1.0f / radius;
+        float2 o = 0.0f;
+        snapLightFrustum(s, o, Mv, float3{}, mShadowMapResolution.xy);
+
+        const mat4f F(mat4f::row_major_init {
+                 s.x,   0,  0, o.x,
+                   0, s.y,  0, o.y,
+                   0,   0,  1,   0,
+                   0,   0,  0,   1,
+        });
+
+        const mat4f S = F * Mp * Mv;
+        const mat4f St = getTextureCoordsMapping() * S;
+
+        cache.lightSpace = St;
+        cache.projection = S * mat4f::translation(wsDirection * params.options.constantBias);
+        cache.lightView = Mv;
+        cache.direction = wsDirection;
+        cache.anchor = wsCameraPosition;
+        cache.texelSizeWs = texelSizeWorldSpace(St.upperLeft());
+        cache.znear = znear;
+        cache.zfar = zfar;
+        cache.castersHash = scene->getStaticShadowCastersHash();
+        cache.visibleLayers = visibleLayers;
+        cache.options = params.options;
+        cache.valid = true;
+        cache.dirty = true;
+    }
+
+    mHasVisibleShadows = true;
+    mLightSpace = cache.lightSpace * worldOriginInverse;
+    mTexelSizeWs = cache.texelSizeWs;
+    mCamera->setCustomProjection(mat4(cache.projection * worldOriginInverse),
+            cache.znear, cache.zfar);
+
+    // the debug camera doesn't have the world origin applied
+    mDebugCamera->setCustomProjection(mat4(cache.projection), cache.znear, cache.zfar);
+}
+
+bool ShadowMap::isStaticCacheCompatible(LightManager::ShadowOptions const& lhs,
+        LightManager::ShadowOptions const& rhs) noexcept {
+    // only the options that affect the content of the static casters cache matter here
+    return lhs.mapSize == rhs.mapSize &&
+           lhs.constantBias == rhs.constantBias &&
+           lhs.polygonOffsetConstant == rhs.polygonOffsetConstant &&
+           lhs.polygonOffsetSlope == rhs.polygonOffsetSlope &&
+           lhs.shadowFar == rhs.shadowFar &&
+           lhs.staticCacheDistance == rhs.staticCacheDistance;
+}
+
 mat4f ShadowMap::applyLISPSM(math::mat4f& Wp,
         CameraInfo const& camera, FLightManager::ShadowParams const& params,
         mat4f const& LMpMv,
@@ -600,9 +790,9 @@ mat4f ShadowMap::applyLISPSM(math::mat4f& Wp,
 }
 
 
-mat4f ShadowMap::getTextureCoordsMapping() const noexcept {
+mat4f ShadowMap::getTextureCoordsMapping(bool clipSpaceFlipped) noexcept {
     // remapping from NDC to texture coordinates (i.e. [-1,1] -> [0, 1])
-    const mat4f Mt(mClipSpaceFlipped ? mat4f::row_major_init{
+    return mat4f(clipSpaceFlipped ? mat4f::row_major_init{
             0.5f,   0,    0,  0.5f,
               0, -0.5f,   0,  0.5f,
               0,    0,  0.5f, 0.5f,
@@ -613,6 +803,10 @@ mat4f ShadowMap::getTextureCoordsMapping() const noexcept {
               0,    0,  0.5f, 0.5f,
               0,    0,    0,    1
     });
+}
+
+mat4f ShadowMap::getTextureCoordsMapping() const noexcept {
+    const mat4f Mt(getTextureCoordsMapping(mClipSpaceFlipped));
 
     // apply the 1-texel border viewport transform
     const float o = 1.0f / mShadowMapDimension;
@@ -30,6 +30,7 @@
 #include <math/mat4.h>
 
 #include <stddef.h>
+#include <stdint.h>
 #include <assert.h>
 
 
@@ -68,7 +69,8 @@ public:
     // invalidate a range of uniforms and return a pointer to it. offset and size given in bytes
     void* invalidateUniforms(size_t offset, size_t size) {
         assert(offset + size <= mSize);
-        mSomethingDirty = true;
+        mDirtyBegin = std::min(mDirtyBegin, uint32_t(offset));
+        mDirtyEnd = std::max(mDirtyEnd, uint32_t(offset + size));
         return static_cast<char*>(mBuffer) + offset;
     }
 
@@ -83,10 +85,14 @@ public:
     size_t getSize() const noexcept { return mSize; }
 
     // return if any uniform has been changed
-    bool isDirty() const noexcept { return mSomethingDirty; }
+    bool isDirty() const noexcept { return mDirtyBegin < mDirtyEnd; }
+
+    // the smallest range of bytes covering all the changed uniforms, valid if isDirty()
+    size_t getDirtyOffset() const noexcept { return mDirtyBegin; }
+    size_t getDirtySize() const noexcept { return mDirtyEnd - mDirtyBegin; }
 
     // mark the whole buffer as clean (no modified uniforms)
-    void clean() const noexcept { mSomethingDirty = false; }
+    void clean() const noexcept { mDirtyBegin = UINT32_MAX; mDirtyEnd = 0; }
 
     /*
      * -----------------------------------------------
@@ -155,6 +161,13 @@ public:
         return toBufferDescriptor(driver, 0, getSize());
     }
 
+    // copy the changed uniforms and cleans the dirty bits, the data must be uploaded at offset.
+    backend::BufferDescriptor toDirtyBufferDescriptor(
+            backend::DriverApi& driver, uint32_t* offset) const noexcept {
+        *offset = mDirtyBegin;
+        return toBufferDescriptor(driver, mDirtyBegin, getDirtySize());
+    }
+
     // copy the UBO data and cleans the dirty bits
     backend::BufferDescriptor toBufferDescriptor(
             backend::DriverApi& driver, size_t offset, size_t size) const noexcept {
@@ -181,7 +194,8 @@ private:
     char mStorage[96];
     void *mBuffer = nullptr;
     uint32_t mSize = 0;
-    mutable bool mSomethingDirty = false;
+    mutable uint32_t mDirtyBegin = UINT32_MAX;
+    mutable uint32_t mDirtyEnd = 0;
 };
 
 // specialization for float3 (which has a different alignment)
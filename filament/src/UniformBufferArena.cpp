@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "UniformBufferArena.h"
+
+#include "private/backend/DriverApi.h"
+
+#include <utils/compiler.h>
+
+namespace filament {
+
+using namespace backend;
+
+void UniformBufferArena::terminate(DriverApi& driver) noexcept {
+    for (Handle<HwUniformBuffer> ubh : mPages) {
+        driver.destroyUniformBuffer(ubh);
+    }
+    mPages.clear();
+    mFreeLists.clear();
+    mPageOffset = PAGE_SIZE;
+}
+
+UniformBufferArena::Allocation UniformBufferArena::allocate(DriverApi& driver,
+        size_t size) noexcept {
+    if (UTILS_UNLIKELY(!isSuballocated(size))) {
+        return { driver.createUniformBuffer(size, BufferUsage::DYNAMIC), 0 };
+    }
+
+    // reuse a freed allocation of the same size class if we can
+    const size_t sizeClass = getSizeClass(size);
+    if (sizeClass < mFreeLists.size() && !mFreeLists[sizeClass].empty()) {
+        Allocation allocation = mFreeLists[sizeClass].back();
+        mFreeLists[sizeClass].pop_back();
+        return allocation;
+    }
+
+    const uint32_t alignedSize = uint32_t(sizeClass + 1u) * ALIGNMENT;
+    if (UTILS_UNLIKELY(mPageOffset + alignedSize > PAGE_SIZE)) {
+        // the end of the last page is lost, it's at most MAX_SUBALLOCATION_SIZE
+        mPages.push_back(driver.createUniformBuffer(PAGE_SIZE, BufferUsage::DYNAMIC));
+        mPageOffset = 0;
+    }
+    Allocation allocation{ mPages.back(), mPageOffset };
+    mPageOffset += alignedSize;
+    return allocation;
+}
+
+void UniformBufferArena::free(DriverApi& driver, Allocation const& allocation,
+        size_t size) noexcept {
+    if (!allocation.ubh) {
+        return;
+    }
+    if (UTILS_UNLIKELY(!isSuballocated(size))) {
+        driver.destroyUniformBuffer(allocation.ubh);
+        return;
+    }
+    const size_t sizeClass = getSizeClass(size);
+    if (sizeClass >= mFreeLists.size()) {
+        mFreeLists.resize(sizeClass + 1u);
+    }
+    mFreeLists[sizeClass].push_back(allocation);
+}
+
+} // namespace filament
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_UNIFORMBUFFERARENA_H
+#define TNT_FILAMENT_UNIFORMBUFFERARENA_H
+
+#include <backend/Handle.h>
+
+#include "private/backend/DriverApiForward.h"
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+
+/*
+ * Sub-allocates small uniform buffers, e.g. the material instances', in a few large GPU
+ * buffers. Each allocation is bound with bindUniformBufferRange() at its offset.
+ *
+ * Allocations are rounded up to ALIGNMENT, which is compatible with all versions of GLES. Freed
+ * allocations are kept in a free-list per size and reused by the next allocation of the same
+ * size. Allocations larger than MAX_SUBALLOCATION_SIZE get their own buffer.
+ *
+ * Sub-allocation only pays off when the backend can update a range of a buffer without touching
+ * the rest of it. When it can't (e.g. Metal, which copies the whole buffer on each update), it
+ * can be disabled with init() and every allocation then gets its own buffer.
+ */
+class UniformBufferArena {
+public:
+    struct Allocation {
+        backend::Handle<backend::HwUniformBuffer> ubh;
+        uint32_t offset = 0;
+    };
+
+    static constexpr uint32_t ALIGNMENT = 256;
+    static constexpr uint32_t PAGE_SIZE = 64 * 1024;
+    static constexpr uint32_t MAX_SUBALLOCATION_SIZE = 16 * 1024;
+
+    UniformBufferArena() noexcept = default;
+    UniformBufferArena(UniformBufferArena const& rhs) = delete;
+    UniformBufferArena& operator=(UniformBufferArena const& rhs) = delete;
+
+    // must be called before the first allocation, sub-allocation is enabled by default
+    void init(bool suballocate) noexcept { mSuballocate = suballocate; }
+
+    // all allocations must have been freed
+    void terminate(backend::DriverApi& driver) noexcept;
+
+    Allocation allocate(backend::DriverApi& driver, size_t size) noexcept;
+
+    // size must be the size given to allocate()
+    void free(backend::DriverApi& driver, Allocation const& allocation, size_t size) noexcept;
+
+private:
+    bool isSuballocated(size_t size) const noexcept {
+        return mSuballocate && size <= MAX_SUBALLOCATION_SIZE;
+    }
+
+    static size_t getSizeClass(size_t size) noexcept {
+        return (size + ALIGNMENT - 1u) / ALIGNMENT - 1u;
+    }
+
+    std::vector<backend::Handle<backend::HwUniformBuffer>> mPages;
+    uint32_t mPageOffset = PAGE_SIZE;   // first unused byte of the last page
+    std::vector<std::vector<Allocation>> mFreeLists;    // indexed by size class
+    bool mSuballocate = true;
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_UNIFORMBUFFERARENA_H
@@ -62,7 +62,8 @@ FView::FView(FEngine& engine)
     : mFroxelizer(engine),
       mPerViewUb(PerViewUib::getUib().getSize()),
       mPerViewSb(PerViewSib::SAMPLER_COUNT),
-      mDirectionalShadowMap(engine) {
+      mDirectionalShadowMap(engine),
+      mShadowAtlas(engine) {
     DriverApi& driver = engine.getDriverApi();
 
     FDebugRegistry& debugRegistry = engine.getDebugRegistry();
@@ -94,8 +95,9 @@ void FView::terminate(FEngine& engine) {
     driver.destroyUniformBuffer(mPerViewUbh);
     driver.destroyUniformBuffer(mLightUbh);
     driver.destroySamplerGroup(mPerViewSbh);
-    driver.destroyUniformBuffer(mRenderableUbh);
+    mRenderableUbo.terminate(driver);
     mDirectionalShadowMap.terminate(driver);
+    mShadowAtlas.terminate(driver);
     mFroxelizer.terminate(driver);
 }
 
@@ -286,6 +288,7 @@ void FView::prepareShadowing(FEngine& engine, backend::DriverApi& driver,
     // TODO: for now we only consider THE directional light
 
     auto& lcm = engine.getLightManager();
+    UniformBuffer& u = mPerViewUb;
 
     // dominant directional light is always as index 0
     FLightManager::Instance directionalLight = lightData.elementAt<FScene::LIGHT_INSTANCE>(0);
@@ -296,7 +299,6 @@ void FView::prepareShadowing(FEngine& engine, backend::DriverApi& driver,
         shadowMap.update(lightData, 0, mScene, mViewingCameraInfo, mVisibleLayers);
         if (shadowMap.hasVisibleShadows()) {
             // Cull shadow casters
-            UniformBuffer& u = mPerViewUb;
             Frustum const& frustum = shadowMap.getCamera().getFrustum();
             FView::prepareVisibleShadowCasters(engine.getJobSystem(), frustum, renderableData);
 
@@ -312,6 +314,32 @@ void FView::prepareShadowing(FEngine& engine, backend::DriverApi& driver,
                     float3{ 0, normalBias * texelSizeWorldSpace, 0 });
         }
     }
+
+    // shadow receivers may only receive the spot and point lights shadows
+    u.setUniform(offsetof(PerViewUib, directionalShadows), uint32_t(hasShadowing()));
+
+    // setup the shadow atlas for the spot and point lights
+    // (this relies on prepareVisibleLights() having culled the lights)
+    ShadowAtlas& shadowAtlas = mShadowAtlas;
+    if (mShadowingEnabled) {
+        shadowAtlas.update(lightData, mViewingCameraInfo);
+    } else {
+        shadowAtlas.clear();
+    }
+    if (UTILS_UNLIKELY(shadowAtlas.hasVisibleShadows())) {
+        // Cull shadow casters, all the casters of all the tiles are flagged as shadow casters
+        // here, each tile is culled again when it's rendered.
+        for (size_t i = 0, c = shadowAtlas.getTileCount(); i < c; i++) {
+            FView::prepareVisibleShadowCasters(engine.getJobSystem(),
+                    shadowAtlas.getTileFrustum(i), renderableData);
+        }
+
+        // allocates the atlas driver resources
+        shadowAtlas.prepare(driver, mPerViewSb);
+
+        u.setUniformArray(offsetof(PerViewUib, shadowTileFromWorldMatrix),
+                shadowAtlas.getLightSpaceMatrices(), shadowAtlas.getTileCount());
+    }
 }
 
 void FView::prepareLighting(FEngine& engine, FEngine::DriverApi& driver, ArenaScope& arena,
@@ -322,7 +350,7 @@ void FView::prepareLighting(FEngine& engine, FEngine::DriverApi& driver, ArenaSc
     const CameraInfo& camera = mViewingCameraInfo;
     FScene* const scene = mScene;
 
-    scene->prepareDynamicLights(camera, arena, mLightUbh);
+    scene->prepareDynamicLights(camera, arena, mLightUbh, mShadowAtlas);
 
     // here the array of visible lights has been shrunk to CONFIG_MAX_LIGHT_COUNT
     auto const& lightData = scene->getLightData();
@@ -496,10 +524,12 @@ void FView::prepare(FEngine& engine, backend::DriverApi& driver, ArenaScope& are
 
 
         /*
-         * Shadowing: compute the shadow camera and cull shadow casters
+         * Shadowing: compute the shadow cameras and cull shadow casters
          * (this will set the VISIBLE_SHADOW_CASTER bit)
+         * The shadow atlas relies on prepareVisibleLights()
          */
 
+        js.waitAndRelease(prepareVisibleLightsJob);
         prepareShadowing(engine, driver, renderableData, scene->getLightData());
 
         /*
@@ -529,19 +559,8 @@ void FView::prepare(FEngine& engine, backend::DriverApi& driver, ArenaScope& are
         mVisibleShadowCasters = Range{ uint32_t(beginCasters - beginRenderables), iEnd };
         merged = Range{ 0, iEnd };
 
-        // update those UBOs
-        const size_t size = merged.size() * sizeof(PerRenderableUib);
-        if (mRenderableUBOSize < size) {
-            // allocate 1/3 extra, with a minimum of 16 objects
-            const size_t count = std::max(size_t(16u), (4u * merged.size() + 2u) / 3u);
-            mRenderableUBOSize = uint32_t(count * sizeof(PerRenderableUib));
-            driver.destroyUniformBuffer(mRenderableUbh);
-            mRenderableUbh = driver.createUniformBuffer(mRenderableUBOSize,
-                    backend::BufferUsage::STREAM);
-        } else {
-            // TODO: should we shrink the underlying UBO at some point?
-        }
-        scene->updateUBOs(merged, mRenderableUbh);
+        // update those UBOs, see FScene::RenderableUbo for the UBO's sizing policy
+        scene->updateUBOs(merged, mRenderableUbo);
     }
 
     /*
@@ -550,7 +569,6 @@ void FView::prepare(FEngine& engine, backend::DriverApi& driver, ArenaScope& are
      * Relies on FScene::prepare() and prepareVisibleLights()
      */
 
-    js.waitAndRelease(prepareVisibleLightsJob);
     prepareLighting(engine, driver, arena, viewport);
 
     /*
@@ -173,6 +173,9 @@ void FLightManager::create(const FLightManager::Builder& builder, utils::Entity
         shadowParams.options.shadowFar      = std::max(builder->mShadowOptions.shadowFar, 0.0f);
         shadowParams.options.shadowNearHint = std::max(builder->mShadowOptions.shadowNearHint, 0.0f);
         shadowParams.options.shadowFarHint  = std::max(builder->mShadowOptions.shadowFarHint, 0.0f);
+        shadowParams.options.cacheStaticCasters  = builder->mShadowOptions.cacheStaticCasters;
+        shadowParams.options.staticCacheDistance =
+                std::max(builder->mShadowOptions.staticCacheDistance, 0.0f);
 
         // set default values by calling the setters
         setLocalPosition(i, builder->mPosition);
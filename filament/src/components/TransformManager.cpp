@@ -16,6 +16,10 @@
 
 #include "components/TransformManager.h"
 
+#include <algorithm>
+
+#include <math.h>
+
 using namespace utils;
 using namespace filament::math;
 
@@ -50,6 +54,7 @@ void FTransformManager::create(Entity entity, Instance parent, const mat4f& loca
         manager[i].next = 0;
         manager[i].prev = 0;
         manager[i].firstChild = 0;
+        manager[i].flags = 0;
         insertNode(i, parent);
         setTransform(i, localTransform);
     }
@@ -123,6 +128,7 @@ void FTransformManager::setTransform(Instance ci, const mat4f& model) noexcept {
         auto& manager = mManager;
         // store our local transform
         manager[ci].local = model;
+        manager[ci].flags = isRigidTransform(model) ? 0 : LOCAL_NOT_RIGID;
         updateNodeTransform(ci);
     }
 }
@@ -149,9 +155,11 @@ void FTransformManager::updateNodeTransform(Instance i) noexcept {
     // note: by using the raw_array() we don't need to check that parent is valid.
     Instance parent = manager[i].parent;
     mat4f const& pt = manager.raw_array<WORLD>()[parent];
+    uint8_t const pf = manager.raw_array<FLAGS>()[parent];
 
     // compute our world transform
     manager[i].world = pt * static_cast<mat4f const&>(manager[i].local);
+    manager[i].flags = getWorldFlags(pf, manager[i].flags);
 
     // update our children's world transforms
     Instance child = manager[i].firstChild;
@@ -174,6 +182,7 @@ void FTransformManager::commitLocalTransformTransaction() noexcept {
         soa.ensureCapacity(soa.size() + 1);
 
         mat4f const* const UTILS_RESTRICT world = manager.raw_array<WORLD>();
+        uint8_t const* const UTILS_RESTRICT flags = manager.raw_array<FLAGS>();
         for (Instance i = manager.begin(), e = manager.end(); i != e; ++i) {
             // Ensure that children are always sorted after their parent.
             if (UTILS_UNLIKELY(Instance(manager[i].parent) > i)) {
@@ -182,6 +191,7 @@ void FTransformManager::commitLocalTransformTransaction() noexcept {
             Instance parent = manager[i].parent;
             assert(parent < i);
             manager[i].world = world[parent] * static_cast<mat4f const&>(manager[i].local);
+            manager[i].flags = getWorldFlags(flags[parent], manager[i].flags);
         }
     }
 }
@@ -219,6 +229,7 @@ void FTransformManager::swapNode(Instance i, Instance j) noexcept {
     // swap the content of the nodes directly
     std::swap(manager.elementAt<LOCAL>(i), manager.elementAt<LOCAL>(j));
     std::swap(manager.elementAt<WORLD>(i), manager.elementAt<WORLD>(j));
+    std::swap(manager.elementAt<FLAGS>(i), manager.elementAt<FLAGS>(j));
     manager.swap(i, j); // this swaps the data relative to SingleInstanceComponentManager
 
     // now swap the linked-list references, to do that correctly we must use a temporary
@@ -312,6 +323,7 @@ void FTransformManager::transformChildren(Sim& manager, Instance ci) noexcept {
         mat4f const& pt = manager[parent].world;
         mat4f const& local = manager[ci].local;
         manager[ci].world = pt * local;
+        manager[ci].flags = getWorldFlags(manager[parent].flags, manager[ci].flags);
 
         // assume we don't have a deep hierarchy
         Instance child = manager[ci].firstChild;
@@ -324,6 +336,25 @@ void FTransformManager::transformChildren(Sim& manager, Instance ci) noexcept {
     }
 }
 
+bool FTransformManager::isRigidTransform(mat4f const& m) noexcept {
+    // the columns of the upper-left 3x3 must be orthogonal and have the same length
+    constexpr float EPSILON = 1e-5f;
+    const float3 c0 = m[0].xyz;
+    const float3 c1 = m[1].xyz;
+    const float3 c2 = m[2].xyz;
+    const float l0 = length2(c0);
+    const float l1 = length2(c1);
+    const float l2 = length2(c2);
+    const float tolerance = EPSILON * std::max(l0, std::max(l1, l2));
+    return fabsf(dot(c0, c1)) <= tolerance &&
+           fabsf(dot(c1, c2)) <= tolerance &&
+           fabsf(dot(c2, c0)) <= tolerance &&
+           fabsf(l0 - l1) <= tolerance &&
+           fabsf(l0 - l2) <= tolerance &&
+           // and it must be affine
+           m[0].w == 0 && m[1].w == 0 && m[2].w == 0 && m[3].w == 1;
+}
+
 void FTransformManager::validateNode(Instance i) noexcept {
 #ifndef NDEBUG
     auto& manager = mManager;
@@ -28,6 +28,8 @@
 
 #include <math/mat4.h>
 
+#include <stdint.h>
+
 namespace filament {
 namespace details {
 
@@ -88,6 +90,15 @@ public:
         return mManager[ci].world;
     }
 
+    // Whether the world transform is rigid, i.e. made of a rotation, a translation and
+    // a uniform scale. The normal matrix of a rigid transform is its (normalized) upper-left
+    // 3x3 matrix, which is much cheaper to compute than the inverse-transpose.
+    bool isWorldTransformRigid(Instance ci) const noexcept {
+        return !(mManager[ci].flags & WORLD_NOT_RIGID);
+    }
+
+    static bool isRigidTransform(math::mat4f const& m) noexcept;
+
 private:
     struct Sim;
 
@@ -99,6 +110,16 @@ private:
     void swapNode(Instance i, Instance j) noexcept;
     static void transformChildren(Sim& manager, Instance firstChild) noexcept;
 
+    // FLAGS bits. They're set when the transforms are *not* rigid, so that the "null" instance
+    // (i.e. the parent of root nodes) is rigid, like its identity world transform.
+    static constexpr uint8_t LOCAL_NOT_RIGID = 0x1;
+    static constexpr uint8_t WORLD_NOT_RIGID = 0x2;
+
+    static uint8_t getWorldFlags(uint8_t parentFlags, uint8_t flags) noexcept {
+        const bool rigid = !(parentFlags & WORLD_NOT_RIGID) && !(flags & LOCAL_NOT_RIGID);
+        return uint8_t((flags & LOCAL_NOT_RIGID) | (rigid ? 0 : WORLD_NOT_RIGID));
+    }
+
 
     enum {
         LOCAL,          // local transform (relative to parent), world if no parent
@@ -107,6 +128,7 @@ private:
         FIRST_CHILD,    // instance to our first child
         NEXT,           // instance to our next sibling
         PREV,           // instance to our previous sibling
+        FLAGS,          // whether the local and world transforms are rigid
     };
 
     using Base = utils::SingleInstanceComponentManager<
@@ -115,7 +137,8 @@ private:
             Instance,
             Instance,
             Instance,
-            Instance
+            Instance,
+            uint8_t
     >;
 
     struct Sim : public Base {
@@ -138,6 +161,7 @@ private:
                 Field<FIRST_CHILD>  firstChild;
                 Field<NEXT>         next;
                 Field<PREV>         prev;
+                Field<FLAGS>        flags;
             };
         };
 
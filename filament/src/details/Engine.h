@@ -19,6 +19,7 @@
 
 #include "upcast.h"
 #include "PostProcessManager.h"
+#include "UniformBufferArena.h"
 
 #include "components/CameraManager.h"
 #include "components/LightManager.h"
@@ -58,6 +59,7 @@
 #include <chrono>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace filament {
 
@@ -77,6 +79,7 @@ namespace details {
 
 class FFence;
 class FMaterialInstance;
+class FMaterialLibrary;
 class FRenderer;
 class FScene;
 class FSwapChain;
@@ -134,6 +137,9 @@ public:
     uint32_t getMaterialId() const noexcept { return mMaterialId++; }
 
     const FMaterial* getDefaultMaterial() const noexcept { return mDefaultMaterial; }
+
+    // whether materials can compile their programs asynchronously
+    bool isParallelShaderCompileSupported() const noexcept { return mParallelShaderCompile; }
     const FMaterial* getSkyboxMaterial(bool rgbm) const noexcept;
     const FIndirectLight* getDefaultIndirectLight() const noexcept { return mDefaultIbl; }
 
@@ -166,6 +172,11 @@ public:
         return mPostProcessManager;
     }
 
+    // the material instances' uniform buffers are allocated here
+    UniformBufferArena& getUniformBufferArena() noexcept {
+        return mUniformBufferArena;
+    }
+
     FRenderableManager& getRenderableManager() noexcept {
         return mRenderableManager;
     }
@@ -223,9 +234,17 @@ public:
     FRenderer* createRenderer() noexcept;
     FMaterialInstance* createMaterialInstance(const FMaterial* material) noexcept;
 
+    // material instances whose uniforms or samplers need to be committed, see prepare()
+    void addDirtyMaterialInstance(FMaterialInstance const* instance) noexcept {
+        mDirtyMaterialInstances.push_back(instance);
+    }
+    void removeDirtyMaterialInstance(FMaterialInstance const* instance) noexcept;
+
     FScene* createScene() noexcept;
     FView* createView() noexcept;
     FFence* createFence(Fence::Type type = Fence::Type::SOFT) noexcept;
+    FMaterialLibrary* createMaterialLibrary(const void* payload, size_t size,
+            bool copy, backend::BufferDescriptor::Callback callback, void* user) noexcept;
     FSwapChain* createSwapChain(void* nativeWindow, uint64_t flags) noexcept;
 
     FCamera* createCamera(utils::Entity entity) noexcept;
@@ -239,6 +258,7 @@ public:
     void destroy(const FIndirectLight* p);
     void destroy(const FMaterial* p);
     void destroy(const FMaterialInstance* p);
+    void destroy(const FMaterialLibrary* p);
     void destroy(const FRenderer* p);
     void destroy(const FScene* p);
     void destroy(const FSkybox* p);
@@ -291,11 +311,13 @@ private:
     bool mOwnPlatform = false;
     void* mSharedGLContext = nullptr;
     bool mTerminated = false;
+    bool mParallelShaderCompile = false;
     backend::Handle<backend::HwRenderPrimitive> mFullScreenTriangleRph;
     FVertexBuffer* mFullScreenTriangleVb = nullptr;
     FIndexBuffer* mFullScreenTriangleIb = nullptr;
 
     PostProcessManager mPostProcessManager;
+    UniformBufferArena mUniformBufferArena;
 
     utils::EntityManager& mEntityManager;
     FRenderableManager mRenderableManager;
@@ -313,6 +335,7 @@ private:
     ResourceList<FVertexBuffer> mVertexBuffers{ "VertexBuffer" };
     ResourceList<FIndirectLight> mIndirectLights{ "IndirectLight" };
     ResourceList<FMaterial> mMaterials{ "Material" };
+    ResourceList<FMaterialLibrary> mMaterialLibraries{ "MaterialLibrary" };
     ResourceList<FTexture> mTextures{ "Texture" };
     ResourceList<FSkybox> mSkyboxes{ "Skybox" };
 
@@ -320,6 +343,7 @@ private:
 
     // FMaterialInstance are handled directly by FMaterial
     std::unordered_map<const FMaterial*, ResourceList<FMaterialInstance>> mMaterialInstances;
+    std::vector<FMaterialInstance const*> mDirtyMaterialInstances;
 
     std::unique_ptr<DFG> mDFG;
 
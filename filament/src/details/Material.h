@@ -23,6 +23,8 @@
 
 #include <filament/Material.h>
 
+#include "private/backend/Program.h"
+
 #include <private/filament/SamplerBindingMap.h>
 #include <private/filament/SamplerInterfaceBlock.h>
 #include <private/filament/Variant.h>
@@ -31,6 +33,7 @@
 
 #include <utils/compiler.h>
 
+#include <vector>
 
 namespace filament {
 
@@ -39,6 +42,7 @@ class MaterialParser;
 namespace details {
 
 class  FEngine;
+class  FMaterialLibrary;
 
 class FMaterial : public Material {
 public:
@@ -74,21 +78,32 @@ public:
     FEngine& getEngine() const noexcept  { return mEngine; }
 
     backend::Handle<backend::HwProgram> getProgramSlow(uint8_t variantKey) const noexcept;
+    backend::Program getProgramBuilder(uint8_t variantKey) const noexcept;
+
+    void compile(uint8_t variants, CompilationCallback callback, void* user) noexcept;
     backend::Handle<backend::HwProgram> getProgram(uint8_t variantKey) const noexcept {
 
         // filterVariant() has already been applied in generateCommands(), shouldn't be needed here
         assert( variantKey == Variant::filterVariant(variantKey, isVariantLit()) );
 
+        mUsedVariants |= 1u << variantKey;
+
         backend::Handle<backend::HwProgram> const entry = mCachedPrograms[variantKey];
         return UTILS_LIKELY(entry) ? entry : getProgramSlow(variantKey);
     }
 
     bool isVariantLit() const noexcept { return mIsVariantLit; }
 
+    // bitmask of the variants this material was rendered with so far
+    uint32_t getUsedVariants() const noexcept { return mUsedVariants; }
+
     const utils::CString& getName() const noexcept { return mName; }
     backend::RasterState getRasterState() const noexcept  { return mRasterState; }
     uint32_t getId() const noexcept { return mMaterialId; }
 
+    // the library this material was created from, if any
+    FMaterialLibrary const* getLibrary() const noexcept { return mLibrary; }
+
     Shading getShading() const noexcept { return mShading; }
     Interpolation getInterpolation() const noexcept { return mInterpolation; }
     BlendingMode getBlendingMode() const noexcept { return mBlendingMode; }
@@ -119,9 +134,38 @@ public:
 
     uint32_t generateMaterialInstanceId() const noexcept { return mMaterialInstanceId++; }
 
+    // the variant of compiledVariants (a bitmask) closest to the requested variant
+    static uint8_t findClosestVariant(uint32_t compiledVariants, uint8_t variantKey) noexcept;
+
 private:
+    // a program being compiled asynchronously
+    struct CompilationToken {
+        FMaterial const* material;      // null if the material was destroyed in the meantime
+        backend::Handle<backend::HwProgram> program;
+        uint8_t variant;
+    };
+
+    // called on the engine thread once a program compiled asynchronously is ready
+    static void onProgramCompiled(void* user);
+
+    // a call to compile() waiting for programs compiled asynchronously
+    struct CompilationRequest {
+        uint32_t pending;               // bitmask of the variants we're waiting for
+        size_t total;
+        CompilationCallback callback;
+        void* user;
+    };
+
+    void updateCompilationRequests(uint8_t variant) const noexcept;
+
+    // the closest variant whose shaders are in the package, the package may only have the
+    // variants used in production, see MaterialBuilder::usedVariants()
+    uint8_t getCompiledVariant(uint8_t variantKey) const noexcept;
+
     // try to order by frequency of use
     mutable std::array<backend::Handle<backend::HwProgram>, VARIANT_COUNT> mCachedPrograms;
+    mutable std::array<CompilationToken*, VARIANT_COUNT> mCompilationTokens = {};
+    mutable std::vector<CompilationRequest> mCompilationRequests;
 
     backend::RasterState mRasterState;
     BlendingMode mRenderBlendingMode;
@@ -145,6 +189,7 @@ private:
     bool mHasCustomDepthShader = false;
     bool mIsDefaultMaterial = false;
     bool mSpecularAntiAliasing = false;
+    bool mAsynchronousCompilation = false;
 
     FMaterialInstance mDefaultInstance;
     SamplerInterfaceBlock mSamplerInterfaceBlock;
@@ -154,8 +199,12 @@ private:
     utils::CString mName;
     FEngine& mEngine;
     const uint32_t mMaterialId;
+    uint64_t mCacheId = 0;
+    uint32_t mCompiledVariants = 0;
+    mutable uint32_t mUsedVariants = 0;
     mutable uint32_t mMaterialInstanceId = 0;
     MaterialParser* mMaterialParser = nullptr;
+    FMaterialLibrary const* mLibrary = nullptr;
 };
 
 
@@ -52,9 +52,16 @@ public:
         }
     }
 
+    // called by FEngine::prepare() for each instance of its dirty list
+    void commitDirty(FEngine::DriverApi& driver) const {
+        mInDirtyList = false;
+        commit(driver);
+    }
+
     void use(FEngine::DriverApi& driver) const {
         if (mUbHandle) {
-            driver.bindUniformBuffer(BindingPoints::PER_MATERIAL_INSTANCE, mUbHandle);
+            driver.bindUniformBufferRange(BindingPoints::PER_MATERIAL_INSTANCE,
+                    mUbHandle, mUbOffset, mUniforms.getSize());
         }
         if (mSbHandle) {
             driver.bindSamplers(BindingPoints::PER_MATERIAL_INSTANCE, mSbHandle);
@@ -125,11 +132,21 @@ private:
     void initParameters(FMaterial const* material);
 
     void commitSlow(FEngine::DriverApi& driver) const;
+    void allocateUniformBuffer(FEngine& engine) noexcept;
+
+    // adds this instance to the engine's list of instances to commit, see FEngine::prepare()
+    void invalidate() noexcept {
+        if (UTILS_UNLIKELY(!mInDirtyList)) {
+            mInDirtyList = true;
+            mEngine->addDirtyMaterialInstance(this);
+        }
+    }
 
     // keep these grouped, they're accessed together in the render-loop
     FMaterial const* mMaterial = nullptr;
-    backend::Handle<backend::HwUniformBuffer> mUbHandle;
+    backend::Handle<backend::HwUniformBuffer> mUbHandle;   // allocated in the engine's arena
     backend::Handle<backend::HwSamplerGroup> mSbHandle;
+    uint32_t mUbOffset = 0;
 
     UniformBuffer mUniforms;
     backend::SamplerGroup mSamplers;
@@ -137,6 +154,9 @@ private:
 
     uint64_t mMaterialSortingKey = 0;
 
+    FEngine* mEngine = nullptr;
+    mutable bool mInDirtyList = false;
+
     // Scissor rectangle is specified as: Left Bottom Width Height.
     backend::Viewport mScissorRect = { 0, 0,
             (uint32_t)std::numeric_limits<int32_t>::max(),
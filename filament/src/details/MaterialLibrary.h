@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_DETAILS_MATERIALLIBRARY_H
+#define TNT_FILAMENT_DETAILS_MATERIALLIBRARY_H
+
+#include "upcast.h"
+
+#include <filament/MaterialLibrary.h>
+
+#include <backend/BufferDescriptor.h>
+
+#include <filaflat/BlobDictionary.h>
+#include <filaflat/ChunkContainer.h>
+
+#include <utils/compiler.h>
+
+#include <vector>
+
+#include <stdint.h>
+
+namespace filament {
+namespace details {
+
+class FEngine;
+
+class FMaterialLibrary : public MaterialLibrary {
+public:
+    using Callback = backend::BufferDescriptor::Callback;
+
+    // the library data is copied if copy is true, otherwise it is used in place and callback
+    // is called when the library is destroyed.
+    FMaterialLibrary(const void* data, size_t size, bool copy, Callback callback, void* user);
+    ~FMaterialLibrary() noexcept;
+
+    FMaterialLibrary(FMaterialLibrary const& rhs) = delete;
+    FMaterialLibrary& operator=(FMaterialLibrary const& rhs) = delete;
+
+    // reads the materials and the dictionary for the engine's backend, returns false on failure.
+    bool parse(FEngine& engine) noexcept;
+
+    void terminate(FEngine& engine) noexcept { }
+
+    size_t getMaterialCount() const noexcept { return mMaterials.size(); }
+
+    const char* getMaterialName(size_t index) const noexcept { return mMaterials[index].name; }
+
+    size_t getMaterialIndex(const char* name) const noexcept;
+
+    // the package of a material, which uses the dictionary below
+    const void* getMaterialData(size_t index) const noexcept { return mMaterials[index].data; }
+    size_t getMaterialSize(size_t index) const noexcept { return mMaterials[index].size; }
+
+    filaflat::BlobDictionary const& getDictionary() const noexcept { return mDictionary; }
+
+    // hash of the dictionary, which identifies the shaders along with each material's package
+    uint64_t getDictionaryHash() const noexcept { return mDictionaryHash; }
+
+private:
+    struct Entry {
+        const char* name;
+        const char* data;
+        size_t size;
+    };
+
+    void* mData;
+    size_t mSize;
+    Callback mCallback;
+    void* mUser;
+    bool mOwned;
+
+    filaflat::ChunkContainer mChunkContainer;
+    filaflat::BlobDictionary mDictionary;
+    std::vector<Entry> mMaterials;
+    uint64_t mDictionaryHash = 0;
+};
+
+FILAMENT_UPCAST(MaterialLibrary)
+
+} // namespace details
+} // namespace filament
+
+#endif // TNT_FILAMENT_DETAILS_MATERIALLIBRARY_H
@@ -26,6 +26,8 @@
 
 #include "Allocators.h"
 
+#include "private/backend/DriverApiForward.h"
+
 #include <filament/Box.h>
 #include <filament/Scene.h>
 
@@ -36,6 +38,8 @@
 #include <utils/Range.h>
 
 #include <cstddef>
+#include <vector>
+
 #include <tsl/robin_set.h>
 
 namespace filament {
@@ -46,6 +50,7 @@ class FEngine;
 class FIndirectLight;
 class FRenderer;
 class FSkybox;
+class ShadowAtlas;
 
 
 class FScene : public Scene {
@@ -78,12 +83,18 @@ public:
     // for that in a few places.
     static constexpr size_t DIRECTIONAL_LIGHTS_COUNT = 1;
 
+    // bit of the VISIBLE_MASK used while rendering the tiles of the shadow atlas, the bits
+    // before this one are used for the camera and the directional shadow map culling.
+    static constexpr size_t VISIBLE_SHADOW_TILE_BIT = 2;
+
     explicit FScene(FEngine& engine);
     ~FScene() noexcept;
     void terminate(FEngine& engine);
 
     void prepare(const math::mat4f& worldOriginTransform);
-    void prepareDynamicLights(const CameraInfo& camera, ArenaScope& arena, backend::Handle<backend::HwUniformBuffer> lightUbh) noexcept;
+    void prepareDynamicLights(const CameraInfo& camera, ArenaScope& arena,
+            backend::Handle<backend::HwUniformBuffer> lightUbh,
+            ShadowAtlas const& shadowAtlas) noexcept;
 
 
     filament::backend::Handle<backend::HwUniformBuffer> getRenderableUBO() const noexcept {
@@ -101,6 +112,8 @@ public:
         BONES_UBH,              //  4 bones uniform buffer handle
         WORLD_AABB_CENTER,      // 12 world-space bounding box center of the renderable
         VISIBLE_MASK,           //  1 each bit represents a visibility in a pass
+        UBO_SLOT,               //  4 index of the renderable in the per-renderable UBO
+        RIGID_TRANSFORM,        //  1 whether WORLD_TRANSFORM is a rigid transform
 
         // These are not needed anymore after culling
         LAYERS,                 //  1 layers
@@ -118,6 +131,8 @@ public:
             backend::Handle<backend::HwUniformBuffer>,
             math::float3,
             Culler::result_type,
+            uint32_t,
+            bool,
             uint8_t,
             math::float3,
             utils::Slice<FRenderPrimitive>,
@@ -162,9 +177,62 @@ public:
     LightSoa const& getLightData() const noexcept { return mLightData; }
     LightSoa& getLightData() noexcept { return mLightData; }
 
-    void updateUBOs(utils::Range<uint32_t> visibleRenderables, backend::Handle<backend::HwUniformBuffer> renderableUbh) noexcept;
+    // Signature of the static shadow casters' transforms and layers. Valid after prepare().
+    uint32_t getStaticShadowCastersHash() const noexcept { return mStaticShadowCastersHash; }
+
+    /*
+     * The per-renderable UBO. It persists across frames: each renderable keeps its slot for as
+     * long as it stays in the scene, so that only the slots of the renderables whose transform
+     * changed need to be computed and uploaded again.
+     * The UBO never shrinks, its capacity is the largest number of renderables the scene has had
+     * (plus 1/3). The slots of the renderables that left the scene are reused by the next ones,
+     * and shrinking would require moving the slots in use, i.e. uploading them all again.
+     * It is owned by the View, because its content depends on the camera's world origin.
+     */
+    class RenderableUbo {
+    public:
+        void terminate(backend::DriverApi& driver) noexcept;
+
+        backend::Handle<backend::HwUniformBuffer> getHandle() const noexcept { return mUbh; }
+
+    private:
+        friend class FScene;
+
+        struct Slot {
+            uint32_t instance = 0;  // the renderable using this slot, 0 if the slot is free
+            uint32_t frame = 0;     // last frame this slot was used
+            bool valid = false;     // whether mBuffer holds this renderable's data
+        };
+
+        // assigns a slot to each renderable of the scene, and releases the unused slots
+        void assignSlots(RenderableSoa& soa) noexcept;
+
+        // uploads the dirty slots
+        void commit(backend::DriverApi& driver) noexcept;
+
+        void* getSlotData(uint32_t slot) noexcept;
+
+        backend::Handle<backend::HwUniformBuffer> mUbh;
+        uint32_t mCapacity = 0;                     // capacity of the UBO in slots
+        uint32_t mFrame = 0;
+        bool mUploadAll = false;                    // set when the UBO is reallocated
+        std::vector<uint32_t> mInstanceSlots;       // slot + 1 of each renderable instance, or 0
+        std::vector<Slot> mSlots;
+        std::vector<uint32_t> mFreeSlots;
+        std::vector<uint32_t> mDirtySlots;
+        std::vector<uint32_t> mDirtyRenderables;    // scene index of the dirty renderables
+        std::vector<uint8_t> mBuffer;               // CPU copy of the UBO
+    };
+
+    void updateUBOs(utils::Range<uint32_t> visibleRenderables, RenderableUbo& renderableUbo) noexcept;
 
 private:
+    // below this many dirty renderables, normal matrices are computed on the calling thread
+    static constexpr size_t JOBS_PARALLEL_FOR_NORMAL_MATRICES_COUNT = 256;
+
+    static void updateNormalMatrices(RenderableSoa const& soa, RenderableUbo& renderableUbo,
+            uint32_t const* dirty, size_t count) noexcept;
+
     static inline void computeLightRanges(math::float2* zrange,
             CameraInfo const& camera, const math::float4* spheres, size_t count) noexcept;
 
@@ -191,6 +259,7 @@ private:
      */
     RenderableSoa mRenderableData;
     LightSoa mLightData;
+    uint32_t mStaticShadowCastersHash = 0;
     backend::Handle<backend::HwUniformBuffer> mRenderableViewUbh; // This is actually owned by the view.
 };
 
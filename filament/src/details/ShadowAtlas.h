@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_DETAILS_SHADOWATLAS_H
+#define TNT_FILAMENT_DETAILS_SHADOWATLAS_H
+
+#include "components/LightManager.h"
+
+#include "details/Camera.h"
+#include "details/Scene.h"
+
+#include "private/backend/DriverApiForward.h"
+#include "private/backend/SamplerGroup.h"
+
+#include <private/filament/EngineEnums.h>
+
+#include <filament/Viewport.h>
+
+#include <math/mat4.h>
+#include <math/vec2.h>
+
+#include <array>
+
+namespace filament {
+namespace details {
+
+class FView;
+class RenderPass;
+
+/*
+ * The shadow atlas holds the shadow maps of the spot and point lights.
+ *
+ * Each shadow casting spot light uses one tile of the atlas, point lights use six tiles, one
+ * per cube face. Tiles are square and their size is a power-of-two, picked from the light's
+ * shadow map size and its coverage of the screen. When the atlas is full, the size of the least
+ * important lights' tiles is reduced first, and they're dropped as a last resort.
+ */
+class ShadowAtlas {
+public:
+    explicit ShadowAtlas(FEngine& engine) noexcept;
+    ~ShadowAtlas();
+
+    void terminate(backend::DriverApi& driverApi) noexcept;
+
+    // Call once per frame, after light culling. This selects the shadow casting spot and point
+    // lights, allocates their tiles and computes their cameras.
+    void update(FScene::LightSoa const& lightData, CameraInfo const& camera) noexcept;
+
+    // Releases all the tiles, e.g. when shadows are disabled.
+    void clear() noexcept { mTileCount = 0; mLightCount = 0; }
+
+    // Do we have shadow casting spot or point lights. Valid after calling update().
+    bool hasVisibleShadows() const noexcept { return mTileCount > 0; }
+
+    // Number of tiles in use. Valid after calling update().
+    size_t getTileCount() const noexcept { return mTileCount; }
+
+    // The frustum of a tile, used to cull shadow casters. Valid after calling update().
+    Frustum const& getTileFrustum(size_t tile) const noexcept { return mTiles[tile].frustum; }
+
+    // The transforms from world space to the atlas texture, for each tile.
+    // Valid after calling update().
+    math::mat4f const* getLightSpaceMatrices() const noexcept { return mLightSpace.data(); }
+
+    // Returns the index of the first tile of this light plus one, or 0 if this light doesn't
+    // have a shadow map; as well as its shadow bias. Valid after calling update().
+    math::float2 getShadowParams(FLightManager::Instance li) const noexcept;
+
+    // Allocates the atlas texture.
+    void prepare(backend::DriverApi& driver, backend::SamplerGroup& buffer) noexcept;
+
+    backend::Handle<backend::HwTexture> getTexture() const noexcept { return mAtlasHandle; }
+
+    void render(backend::DriverApi& driver, RenderPass& pass, FView& view) noexcept;
+
+    // size of the atlas texture
+    static constexpr uint32_t ATLAS_SIZE = 2048;
+
+    // smallest tile size, each tile is a power-of-two multiple of this size
+    static constexpr uint32_t MIN_TILE_SIZE = 64;
+
+private:
+    struct Tile {
+        CameraInfo camera;
+        Frustum frustum;
+        Viewport viewport;
+        backend::PolygonOffset polygonOffset;
+    };
+
+    struct ShadowLight {
+        FLightManager::Instance instance;
+        math::float4 sphere;            // position, radius
+        math::float3 direction;
+        float importance;
+        uint32_t size;                  // size of each tile
+        uint8_t tileCount;              // 1 for spot lights, 6 for point lights
+        uint8_t firstTile;
+    };
+
+    void updateTile(Tile& tile, math::mat4f& lightSpace, ShadowLight const& light,
+            math::float3 const& direction, float fov, math::float2 position) noexcept;
+
+    static math::float2 getTilePosition(uint32_t index) noexcept;
+
+    std::array<Tile, CONFIG_MAX_SHADOW_TILES> mTiles;
+    std::array<math::mat4f, CONFIG_MAX_SHADOW_TILES> mLightSpace;
+    std::array<ShadowLight, CONFIG_MAX_SHADOW_TILES> mLights;
+    size_t mTileCount = 0;
+    size_t mLightCount = 0;
+
+    // set-up in prepare()
+    backend::Handle<backend::HwTexture> mAtlasHandle;
+    backend::Handle<backend::HwRenderTarget> mAtlasRenderTarget;
+
+    FEngine& mEngine;
+    const bool mClipSpaceFlipped;
+};
+
+} // namespace details
+} // namespace filament
+
+#endif // TNT_FILAMENT_DETAILS_SHADOWATLAS_H
@@ -74,6 +74,9 @@ public:
     // use only for debugging
     FCamera const& getDebugCamera() const noexcept { return *mDebugCamera; }
 
+    // Returns the remapping from NDC to texture coordinates (i.e. [-1,1] -> [0, 1])
+    static math::mat4f getTextureCoordsMapping(bool clipSpaceFlipped) noexcept;
+
 private:
     struct CameraInfo {
         math::mat4f projection;
@@ -102,11 +105,37 @@ private:
     // 8 corners, 12 segments w/ 2 intersection max -- all of this twice (8 + 12 * 2) * 2 (768 bytes)
     using FrustumBoxIntersection = std::array<math::float3, 64>;
 
+    // State of the static shadow casters cache. All matrices are in absolute world space
+    // (i.e. without the world origin applied), since the world origin follows the camera.
+    struct StaticCache {
+        math::mat4f lightSpace;         // St
+        math::mat4f projection;         // Sb
+        math::mat4f lightView;          // Mv
+        math::float3 direction = {};
+        math::float3 anchor = {};       // camera position when the cache was computed
+        float texelSizeWs = 0.0f;
+        float znear = 0.0f;
+        float zfar = 0.0f;
+        uint32_t castersHash = 0;
+        uint8_t visibleLayers = 0;
+        LightManager::ShadowOptions options;
+        bool valid = false;             // the light's camera above is valid
+        bool dirty = true;              // the cached depth needs to be rendered again
+    };
+
     void computeShadowCameraDirectional(
             math::float3 const& direction, FScene const* scene,
             CameraInfo const& camera, FLightManager::ShadowParams const& params,
             uint8_t visibleLayers) noexcept;
 
+    void computeShadowCameraDirectionalCached(
+            math::float3 const& direction, FScene const* scene,
+            CameraInfo const& camera, FLightManager::ShadowParams const& params,
+            uint8_t visibleLayers) noexcept;
+
+    static bool isStaticCacheCompatible(LightManager::ShadowOptions const& lhs,
+            LightManager::ShadowOptions const& rhs) noexcept;
+
     static math::mat4f applyLISPSM(math::mat4f& Wp,
             CameraInfo const& camera, FLightManager::ShadowParams const& params,
             const math::mat4f& LMpMv,
@@ -167,6 +196,7 @@ private:
 
     static math::mat4f directionalLightFrustum(float n, float f) noexcept;
 
+    // same as above, followed by the 1-texel border viewport transform
     math::mat4f getTextureCoordsMapping() const noexcept;
 
     float texelSizeWorldSpace(const math::mat3f& worldToShadowTexture) const noexcept;
@@ -197,12 +227,16 @@ private:
     Viewport mViewport;
     backend::Handle<backend::HwTexture> mShadowMapHandle;
     backend::Handle<backend::HwRenderTarget> mShadowMapRenderTarget;
+    backend::Handle<backend::HwTexture> mStaticCacheHandle;
+    backend::Handle<backend::HwRenderTarget> mStaticCacheRenderTarget;
 
     // set-up in update()
     uint32_t mShadowMapDimension = 0;
     math::float3 mShadowMapResolution = {};     // 1 / effective resolution
     bool mHasVisibleShadows = false;
     backend::PolygonOffset mPolygonOffset{};
+    bool mUseStaticCache = false;
+    StaticCache mStaticCache;
 
     // use a member here (instead of stack) because we don't want to pay the
     // initialization of the float3 each time
@@ -210,6 +244,7 @@ private:
 
     FEngine& mEngine;
     const bool mClipSpaceFlipped;
+    const bool mStaticCacheSupported;
 };
 
 } // namespace details
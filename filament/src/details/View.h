@@ -26,6 +26,7 @@
 #include "details/Allocators.h"
 #include "details/Camera.h"
 #include "details/Froxelizer.h"
+#include "details/ShadowAtlas.h"
 #include "details/ShadowMap.h"
 #include "details/Scene.h"
 
@@ -134,6 +135,7 @@ public:
     bool hasDirectionalLight() const noexcept { return mHasDirectionalLight; }
     bool hasDynamicLighting() const noexcept { return mHasDynamicLighting; }
     bool hasShadowing() const noexcept { return mHasShadowing & mDirectionalShadowMap.hasVisibleShadows(); }
+    bool hasLocalShadowing() const noexcept { return mShadowAtlas.hasVisibleShadows(); }
 
     void updatePrimitivesLod(
             FEngine& engine, const CameraInfo& camera,
@@ -144,6 +146,9 @@ public:
     ShadowMap const& getShadowMap() const { return mDirectionalShadowMap; }
     ShadowMap& getShadowMap() { return mDirectionalShadowMap; }
 
+    ShadowAtlas const& getShadowAtlas() const { return mShadowAtlas; }
+    ShadowAtlas& getShadowAtlas() { return mShadowAtlas; }
+
     FCamera const* getDirectionalLightCamera() const noexcept {
         return &mDirectionalShadowMap.getDebugCamera();
     }
@@ -266,6 +271,10 @@ public:
     FCamera& getCameraUser() noexcept { return *mCullingCamera; }
     void setCameraUser(FCamera* camera) noexcept { setCullingCamera(camera); }
 
+    // culls renderableData against the frustum, and sets the given bit of VISIBLE_MASK
+    static void cullRenderables(utils::JobSystem& js,
+            FScene::RenderableSoa& renderableData, Frustum const& frustum, size_t bit) noexcept;
+
 private:
     static constexpr size_t MAX_FRAMETIME_HISTORY = 32u;
 
@@ -279,9 +288,6 @@ private:
             FLightManager const& lcm, utils::JobSystem& js, Frustum const& frustum,
             FScene::LightSoa& lightData) noexcept;
 
-    static void cullRenderables(utils::JobSystem& js,
-            FScene::RenderableSoa& renderableData, Frustum const& frustum, size_t bit) noexcept;
-
     void computeVisibilityMasks(
             uint8_t visibleLayers, uint8_t const* layers,
             FRenderableManager::Visibility const* visibility, uint8_t* visibleMask,
@@ -302,7 +308,7 @@ private:
     backend::Handle<backend::HwSamplerGroup> mPerViewSbh;
     backend::Handle<backend::HwUniformBuffer> mPerViewUbh;
     backend::Handle<backend::HwUniformBuffer> mLightUbh;
-    backend::Handle<backend::HwUniformBuffer> mRenderableUbh;
+    FScene::RenderableUbo mRenderableUbo;
 
     backend::Handle<backend::HwSamplerGroup> getUsh() const noexcept { return mPerViewSbh; }
     backend::Handle<backend::HwUniformBuffer> getUbh() const noexcept { return mPerViewUbh; }
@@ -355,11 +361,11 @@ private:
     // the following values are set by prepare()
     Range mVisibleRenderables;
     Range mVisibleShadowCasters;
-    uint32_t mRenderableUBOSize = 0;
     mutable bool mHasDirectionalLight = false;
     mutable bool mHasDynamicLighting = false;
     mutable bool mHasShadowing = false;
     mutable ShadowMap mDirectionalShadowMap;
+    mutable ShadowAtlas mShadowAtlas;
 };
 
 FILAMENT_UPCAST(View)
@@ -40,6 +40,7 @@
 #include "components/RenderableManager.h"
 #include "components/TransformManager.h"
 #include "UniformBuffer.h"
+#include "UniformBufferArena.h"
 
 using namespace filament;
 using namespace filament::math;
@@ -146,6 +147,41 @@ TEST(FilamentTest, TransformManager) {
     EXPECT_EQ(tcm.getWorldTransform(child), mat4f{ float4{ 8 }});
 }
 
+TEST(FilamentTest, TransformManagerRigidTransforms) {
+    filament::details::FTransformManager tcm;
+    EntityManager& em = EntityManager::get();
+    std::array<Entity, 2> entities;
+    em.create(entities.size(), entities.data());
+
+    tcm.create(entities[0]);
+    TransformManager::Instance parent = tcm.getInstance(entities[0]);
+    tcm.create(entities[1], parent, mat4f::translation(float3{ 1, 2, 3 }));
+    TransformManager::Instance child = tcm.getInstance(entities[1]);
+
+    // identity and translations are rigid
+    EXPECT_TRUE(tcm.isWorldTransformRigid(parent));
+    EXPECT_TRUE(tcm.isWorldTransformRigid(child));
+
+    // so are rotations and uniform scales
+    tcm.setTransform(parent, mat4f::rotation(0.5f, float3{ 1, 1, 0 }) * mat4f::scaling(3.0f));
+    EXPECT_TRUE(tcm.isWorldTransformRigid(parent));
+    EXPECT_TRUE(tcm.isWorldTransformRigid(child));
+
+    // a non-uniform scale is propagated to the children
+    tcm.setTransform(parent, mat4f::scaling(float3{ 1, 2, 1 }));
+    EXPECT_FALSE(tcm.isWorldTransformRigid(parent));
+    EXPECT_FALSE(tcm.isWorldTransformRigid(child));
+
+    // and so is its removal
+    tcm.setTransform(parent, mat4f{});
+    EXPECT_TRUE(tcm.isWorldTransformRigid(parent));
+    EXPECT_TRUE(tcm.isWorldTransformRigid(child));
+
+    // projections aren't rigid
+    EXPECT_FALSE(filament::details::FTransformManager::isRigidTransform(
+            mat4f::perspective(45.0f, 1.0f, 0.1f, 100.0f)));
+}
+
 TEST(FilamentTest, UniformInterfaceBlock) {
 
     UniformInterfaceBlock::Builder b;
@@ -330,6 +366,101 @@ TEST(FilamentTest, UniformBuffer) {
     //buffer.log(std::cout, ib);
 }
 
+TEST(FilamentTest, UniformBufferDirtyRange) {
+    UniformBuffer buffer(64);
+
+    // a new buffer is entirely dirty
+    EXPECT_TRUE(buffer.isDirty());
+    EXPECT_EQ(0, buffer.getDirtyOffset());
+    EXPECT_EQ(64, buffer.getDirtySize());
+
+    buffer.clean();
+    EXPECT_FALSE(buffer.isDirty());
+
+    buffer.setUniform(16, 1.0f);
+    EXPECT_TRUE(buffer.isDirty());
+    EXPECT_EQ(16, buffer.getDirtyOffset());
+    EXPECT_EQ(4, buffer.getDirtySize());
+
+    // the dirty range covers all the changed uniforms
+    buffer.setUniform(32, float4{ 1, 2, 3, 4 });
+    buffer.setUniform(8, 2.0f);
+    EXPECT_EQ(8, buffer.getDirtyOffset());
+    EXPECT_EQ(40, buffer.getDirtySize());
+
+    buffer.clean();
+    EXPECT_FALSE(buffer.isDirty());
+}
+
+TEST(FilamentTest, UniformBufferArena) {
+    using namespace filament::details;
+    constexpr uint32_t ALIGNMENT = UniformBufferArena::ALIGNMENT;
+    constexpr uint32_t PAGE_SIZE = UniformBufferArena::PAGE_SIZE;
+    constexpr uint32_t MAX_SUBALLOCATION_SIZE = UniformBufferArena::MAX_SUBALLOCATION_SIZE;
+
+    FEngine* engine = FEngine::create(Engine::Backend::NOOP);
+    FEngine::DriverApi& driver = engine->getDriverApi();
+
+    {
+        UniformBufferArena arena;
+
+        // allocations are packed at aligned offsets
+        auto a = arena.allocate(driver, 100);
+        auto b = arena.allocate(driver, ALIGNMENT + 1);
+        auto c = arena.allocate(driver, 100);
+        EXPECT_TRUE(a.ubh);
+        EXPECT_EQ(0u, a.offset);
+        EXPECT_EQ(ALIGNMENT, b.offset);
+        EXPECT_EQ(3 * ALIGNMENT, c.offset);
+
+        // freed allocations are reused by allocations of the same size class only
+        arena.free(driver, a, 100);
+        auto d = arena.allocate(driver, ALIGNMENT + 1);
+        EXPECT_EQ(4 * ALIGNMENT, d.offset);
+        auto e = arena.allocate(driver, ALIGNMENT);
+        EXPECT_EQ(0u, e.offset);
+
+        // a new page is started when the current one is full
+        std::vector<UniformBufferArena::Allocation> allocations;
+        for (uint32_t offset = 6 * ALIGNMENT; offset + MAX_SUBALLOCATION_SIZE <= PAGE_SIZE;
+                offset += MAX_SUBALLOCATION_SIZE) {
+            allocations.push_back(arena.allocate(driver, MAX_SUBALLOCATION_SIZE));
+        }
+        EXPECT_EQ(6 * ALIGNMENT + 2 * MAX_SUBALLOCATION_SIZE, allocations.back().offset);
+        auto f = arena.allocate(driver, MAX_SUBALLOCATION_SIZE);
+        EXPECT_EQ(0u, f.offset);
+        auto g = arena.allocate(driver, 100);
+        EXPECT_EQ(MAX_SUBALLOCATION_SIZE, g.offset);
+
+        // large allocations get their own buffer, and are never reused
+        auto h = arena.allocate(driver, MAX_SUBALLOCATION_SIZE + 1);
+        EXPECT_TRUE(h.ubh);
+        EXPECT_EQ(0u, h.offset);
+        arena.free(driver, h, MAX_SUBALLOCATION_SIZE + 1);
+        auto i = arena.allocate(driver, 100);
+        EXPECT_EQ(MAX_SUBALLOCATION_SIZE + ALIGNMENT, i.offset);
+
+        arena.terminate(driver);
+    }
+
+    {
+        // without sub-allocation, all allocations get their own buffer
+        UniformBufferArena arena;
+        arena.init(false);
+        auto a = arena.allocate(driver, 100);
+        auto b = arena.allocate(driver, 100);
+        EXPECT_TRUE(a.ubh);
+        EXPECT_EQ(0u, a.offset);
+        EXPECT_EQ(0u, b.offset);
+        arena.free(driver, a, 100);
+        arena.free(driver, b, 100);
+        arena.terminate(driver);
+    }
+
+    engine->shutdown();
+    delete engine;
+}
+
 TEST(FilamentTest, BoxCulling) {
     Frustum frustum(mat4f::frustum(-1, 1, -1, 1, 1, 100));
 
@@ -693,6 +824,42 @@ TEST(FilamentTest, Bones) {
     }
 }
 
+TEST(FilamentTest, ClosestVariant) {
+    using details::FMaterial;
+    constexpr uint8_t DIR = Variant::DIRECTIONAL_LIGHTING;
+    constexpr uint8_t DYN = Variant::DYNAMIC_LIGHTING;
+    constexpr uint8_t SRE = Variant::SHADOW_RECEIVER;
+    constexpr uint8_t SKN = Variant::SKINNING;
+    constexpr uint8_t DEPTH = Variant::DEPTH_VARIANT;
+    auto variants = [](std::initializer_list<uint8_t> keys) {
+        uint32_t mask = 0;
+        for (uint8_t key : keys) {
+            mask |= 1u << key;
+        }
+        return mask;
+    };
+
+    // compiled variants are used as is
+    EXPECT_EQ(DIR | SRE, FMaterial::findClosestVariant(variants({ 0, DIR, DIR | SRE }), DIR | SRE));
+
+    // the variant with the most requested features is used, never one with other features
+    EXPECT_EQ(DIR | DYN, FMaterial::findClosestVariant(
+            variants({ 0, DIR, DIR | DYN }), DIR | DYN | SRE));
+    EXPECT_EQ(0, FMaterial::findClosestVariant(variants({ 0, DIR | DYN, SKN }), DIR));
+
+    // skinning is preferred over any other feature
+    EXPECT_EQ(SKN, FMaterial::findClosestVariant(
+            variants({ 0, DIR | DYN, SKN }), DIR | DYN | SKN));
+
+    // a missing skinned depth variant falls back to the skinned variant, not the depth variant
+    EXPECT_EQ(SKN, FMaterial::findClosestVariant(
+            variants({ 0, DEPTH, SKN }), DEPTH | SKN));
+
+    // a missing depth variant falls back to a depth variant if possible
+    EXPECT_EQ(DEPTH, FMaterial::findClosestVariant(
+            variants({ 0, DEPTH, DIR | SKN }), DEPTH | SKN));
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
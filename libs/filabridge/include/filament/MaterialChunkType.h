@@ -75,6 +75,8 @@ enum UTILS_PUBLIC ChunkType : uint64_t {
 
     PostProcessVersion = charTo64bitNum("POSP_VER"),
 
+    MaterialLibrary = charTo64bitNum("MAT_LIBR"),
+
     DictionaryGlsl = charTo64bitNum("DIC_GLSL"),
     DictionarySpirv = charTo64bitNum("DIC_SPIR"),
     DictionaryMetal = charTo64bitNum("DIC_METL")
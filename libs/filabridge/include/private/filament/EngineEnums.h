@@ -55,6 +55,11 @@ constexpr size_t CONFIG_MAX_LIGHT_INDEX = CONFIG_MAX_LIGHT_COUNT - 1;
 // We store 64 bytes per bone.
 constexpr size_t CONFIG_MAX_BONE_COUNT = 256;
 
+// Number of shadow map tiles in the shadow atlas used by spot and point lights.
+// A spot light uses one tile, a point light uses six (one per cube face).
+// This is also limited by UBO size, we store 64 bytes per tile.
+constexpr size_t CONFIG_MAX_SHADOW_TILES = 16;
+
 // TODO This should be injected by the engine as a define of the shader.
 static constexpr bool   CONFIG_IBL_RGBM  = true;
 static constexpr size_t CONFIG_IBL_SIZE  = 256;
@@ -18,6 +18,8 @@
 #define TNT_FILABRIDGE_UIBGENERATOR_H
 
 
+#include <private/filament/EngineEnums.h>
+
 #include <math/mat4.h>
 #include <math/vec4.h>
 
@@ -80,6 +82,11 @@ struct PerViewUib { // NOLINT(cppcoreguidelines-pro-type-member-init)
     alignas(16) filament::math::float4 iblSH[9]; // actually float3 entries (std140 requires float4 alignment)
 
     filament::math::float4 userTime;  // time(s), (double)time - (float)time, 0, 0
+
+    uint32_t directionalShadows; // 1 if the directional light's shadow map is valid
+
+    // spot and point lights shadow atlas tiles
+    alignas(16) filament::math::mat4f shadowTileFromWorldMatrix[CONFIG_MAX_SHADOW_TILES];
 };
 
 
@@ -96,7 +103,7 @@ struct LightsUib {
     filament::math::float4 positionFalloff;   // { float3(pos), 1/falloff^2 }
     filament::math::float4 colorIntensity;    // { float3(col), intensity }
     filament::math::float4 directionIES;      // { float3(dir), IES index }
-    filament::math::float4 spotScaleOffset;   // { scale, offset, unused, unused }
+    filament::math::float4 spotScaleOffset;   // { scale, offset, shadow tile + 1, shadow bias }
 };
 
 struct PostProcessingUib {
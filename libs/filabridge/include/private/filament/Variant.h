@@ -39,11 +39,13 @@ namespace filament {
         //                    ...-----+-----+-----+-----+-----+
         // Reserved variants:
         //       Depth shader            X     1     0     0
-        //           Reserved            X     1     1     0
         //
         // Standard variants:
-        //      Vertex shader            X     X     0     X
+        //      Vertex shader            X     X     0     X    (SRE requires DIR)
         //    Fragment shader            0     X     X     X
+        //
+        // Without DIR, SRE only affects the fragment shader (spot and point lights shadows),
+        // the vertex shader is the same as without SRE.
 
         uint8_t key = 0;
 
@@ -90,14 +92,16 @@ namespace filament {
             return (key & DEPTH_MASK) == DEPTH_VARIANT;
         }
 
-        static constexpr bool isReserved(uint8_t variantKey) noexcept {
-            // reserved variants that should just be skipped.
-            return (variantKey & DEPTH_MASK) == (SHADOW_RECEIVER | DYNAMIC_LIGHTING);
-        }
-
         static constexpr uint8_t filterVariantVertex(uint8_t variantKey) noexcept {
             // filter out vertex variants that are not needed. For e.g. dynamic lighting
             // doesn't affect the vertex shader.
+            if ((variantKey & DEPTH_MASK) == DEPTH_VARIANT) {
+                return variantKey & VERTEX_MASK;
+            }
+            // shadow receivers only need a specific vertex shader for the directional light
+            if (!(variantKey & DIRECTIONAL_LIGHTING)) {
+                variantKey &= ~SHADOW_RECEIVER;
+            }
             return variantKey & VERTEX_MASK;
         }
 
@@ -36,6 +36,7 @@ SamplerInterfaceBlock const& SibGenerator::getPerViewSib() noexcept {
             .add("iblDFG",        Type::SAMPLER_2D,      Format::FLOAT, Precision::MEDIUM)
             .add("iblSpecular",   Type::SAMPLER_CUBEMAP, Format::FLOAT, Precision::MEDIUM)
             .add("ssao",          Type::SAMPLER_2D,      Format::FLOAT, Precision::MEDIUM)
+            .add("shadowAtlas",   Type::SAMPLER_2D,      Format::SHADOW,Precision::LOW)
             .build();
 
     assert(sib.getSize() == PerViewSib::SAMPLER_COUNT);
@@ -73,6 +73,11 @@ UniformInterfaceBlock const& UibGenerator::getPerViewUib() noexcept  {
             .add("iblSH",                   9, UniformInterfaceBlock::Type::FLOAT3)
             // user time
             .add("userTime",                1, UniformInterfaceBlock::Type::FLOAT4)
+            // shadow
+            .add("directionalShadows",      1, UniformInterfaceBlock::Type::UINT)
+            // spot and point lights shadows
+            .add("shadowTileFromWorldMatrix", CONFIG_MAX_SHADOW_TILES,
+                    UniformInterfaceBlock::Type::MAT4, Precision::HIGH)
             .build();
     return uib;
 }
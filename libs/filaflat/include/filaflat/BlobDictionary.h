@@ -25,6 +25,8 @@
 namespace filaflat {
 
 // Flat list of blobs that can be referenced by index.
+// Blobs are either owned by the dictionary, or reference external memory (e.g. the material
+// package itself), which must then outlive the dictionary.
 class BlobDictionary {
 public:
     BlobDictionary() = default;
@@ -33,32 +35,59 @@ public:
     using Blob = std::vector<uint8_t>;
 
     inline void addBlob(const char* blob, size_t len) noexcept {
-        mBlobs.emplace_back(blob, blob + len);
+        addBlob(Blob(blob, blob + len));
     }
 
     inline void addBlob(Blob&& blob) noexcept {
-        mBlobs.push_back(std::move(blob));
+        // the blob's data doesn't move when mStorage grows
+        mStorage.push_back(std::move(blob));
+        mEntries.push_back({ (const char*)mStorage.back().data(), mStorage.back().size() });
+    }
+
+    // Adds a reference to a blob, without copying it.
+    inline void addBlobReference(const char* blob, size_t len) noexcept {
+        mEntries.push_back({ blob, len });
+    }
+
+    // Adds a reference to a null-terminated string, without copying it. The string's length,
+    // not including the null terminator, is stored so it never needs to be computed again.
+    inline void addString(const char* str, size_t length) noexcept {
+        addBlobReference(str, length + 1);
     }
 
     inline bool isEmpty() const noexcept {
-        return mBlobs.empty();
+        return mEntries.empty();
     }
 
     inline void reserve(size_t size) {
-        mBlobs.reserve(size);
+        mEntries.reserve(size);
     }
 
     inline const char* getBlob(size_t index, size_t* size) const noexcept {
-        *size = mBlobs[index].size();
-        return (const char*) mBlobs[index].data();
+        *size = mEntries[index].size;
+        return mEntries[index].data;
     }
 
     inline const char* getString(size_t index) const noexcept {
-        return (const char*) mBlobs[index].data();
+        return mEntries[index].data;
+    }
+
+    // length of the string at index, not including the null terminator
+    inline size_t getStringLength(size_t index) const noexcept {
+        return mEntries[index].size - 1;
+    }
+
+    inline size_t size() const noexcept {
+        return mEntries.size();
     }
 
 private:
-    std::vector<Blob> mBlobs;
+    struct Entry {
+        const char* data;
+        size_t size;
+    };
+    std::vector<Entry> mEntries;
+    std::vector<Blob> mStorage;
 };
 
 } // namespace filaflat
@@ -22,7 +22,10 @@
 
 #include <filaflat/Unflattener.h>
 
-#include <tsl/robin_map.h>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
 
 namespace filaflat {
 
@@ -42,12 +45,19 @@ public:
             BlobDictionary const& dictionary,
             uint8_t shaderModel, uint8_t variant, uint8_t stage);
 
+    // whether the package holds this shader, without loading it
+    bool hasShader(uint8_t shaderModel, uint8_t variant, uint8_t stage) const noexcept;
+
 private:
     ChunkContainer const& mContainer;
     filamat::ChunkType mMaterialTag = filamat::ChunkType::Unknown;
     Unflattener mUnflattener{nullptr, nullptr};
     const uint8_t* mBase = nullptr;
-    tsl::robin_map<uint32_t, uint32_t> mOffsets;
+    // (key, offset) pairs sorted by key
+    std::vector<std::pair<uint32_t, uint32_t>> mOffsets;
+
+    bool getOffset(uint8_t shaderModel, uint8_t variant, uint8_t stage,
+            uint32_t* offset) const noexcept;
 
     bool getTextShader(Unflattener unflattener,
             BlobDictionary const& dictionary, ShaderBuilder& shaderBuilder,
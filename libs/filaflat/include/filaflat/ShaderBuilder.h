@@ -40,6 +40,10 @@ public:
     // Append a data blob to the shader. Returns true if successful.
     void append(const char* data, size_t size) noexcept;
 
+    // Append size bytes to the shader and return a pointer to them, so they can be written
+    // in place.
+    char* append(size_t size) noexcept;
+
     // returns the shader blob. valid until next api call.
     void const* data() const noexcept { return mShader; }
 
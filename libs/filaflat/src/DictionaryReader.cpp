@@ -61,15 +61,13 @@ bool DictionaryReader::unflatten(ChunkContainer const& container,
             }
 
 #if defined (FILAMENT_DRIVER_SUPPORTS_VULKAN)
+            // The blobs are decompressed when they're used, which is only for a few variants
+            // typically, so we just check they're valid SMOL-V here.
             size_t spirvSize = smolv::GetDecodedBufferSize(compressed, compressedSize);
             if (spirvSize == 0) {
                 return false;
             }
-            BlobDictionary::Blob spirv(spirvSize);
-            if (!smolv::Decode(compressed, compressedSize, spirv.data(), spirvSize)) {
-                return false;
-            }
-            dictionary.addBlob(std::move(spirv));
+            dictionary.addBlobReference(compressed, compressedSize);
 #else
             return false;
 #endif
@@ -86,12 +84,13 @@ bool DictionaryReader::unflatten(ChunkContainer const& container,
         dictionary.reserve(stringCount);
         for (uint32_t i = 0; i < stringCount; i++) {
             const char* str;
+            const uint8_t* start = unflattener.getCursor();
             if (!unflattener.read(&str)) {
                 return false;
             }
-            // BlobDictionary hold binary chunks and does not care if the data holds text, it is
-            // therefore crucial to include the trailing null.
-            dictionary.addBlob(str, strlen(str) + 1);
+            // The strings are referenced directly from the package, which must outlive the
+            // dictionary, the cursor moved past the string and its trailing null.
+            dictionary.addString(str, size_t(unflattener.getCursor() - start) - 1);
         }
         return true;
     }
@@ -19,8 +19,15 @@
 #include <filaflat/ChunkContainer.h>
 #include <filaflat/ShaderBuilder.h>
 
+#include <utils/compiler.h>
 #include <utils/Log.h>
 
+#if defined (FILAMENT_DRIVER_SUPPORTS_VULKAN)
+#include <smolv.h>
+#endif
+
+#include <algorithm>
+
 namespace filaflat {
 
 static inline uint32_t makeKey(uint8_t shaderModel, uint8_t variant, uint8_t type) noexcept {
@@ -53,6 +60,7 @@ bool MaterialChunk::readIndex(filamat::ChunkType materialTag) {
     }
 
     // Read all index entries.
+    mOffsets.reserve(numShaders);
     for (uint64_t i = 0 ; i < numShaders; i++) {
         uint8_t shaderModelValue;
         uint8_t variantValue;
@@ -76,11 +84,34 @@ bool MaterialChunk::readIndex(filamat::ChunkType materialTag) {
         }
 
         uint32_t key = makeKey(shaderModelValue, variantValue, pipelineStageValue);
-        mOffsets[key] = offsetValue;
+        mOffsets.emplace_back(key, offsetValue);
+    }
+
+    // the index is small and looked-up often, a sorted array is both compact and fast to search
+    std::sort(mOffsets.begin(), mOffsets.end());
+    return true;
+}
+
+bool MaterialChunk::getOffset(uint8_t shaderModel, uint8_t variant, uint8_t stage,
+        uint32_t* offset) const noexcept {
+    const uint32_t key = makeKey(shaderModel, variant, stage);
+    auto pos = std::lower_bound(mOffsets.begin(), mOffsets.end(), key,
+            [](std::pair<uint32_t, uint32_t> const& lhs, uint32_t key) {
+                return lhs.first < key;
+            });
+    if (pos == mOffsets.end() || pos->first != key) {
+        return false;
     }
+    *offset = pos->second;
     return true;
 }
 
+bool MaterialChunk::hasShader(uint8_t shaderModel, uint8_t variant,
+        uint8_t stage) const noexcept {
+    uint32_t offset;
+    return getOffset(shaderModel, variant, stage, &offset);
+}
+
 bool MaterialChunk::getTextShader(Unflattener unflattener, BlobDictionary const& dictionary,
         ShaderBuilder& shaderBuilder, uint8_t shaderModel, uint8_t variant, uint8_t ps) {
     if (mBase == nullptr) {
@@ -90,14 +121,8 @@ bool MaterialChunk::getTextShader(Unflattener unflattener, BlobDictionary const&
     shaderBuilder.reset();
 
     // Jump and read
-    uint32_t key = makeKey(shaderModel, variant, ps);
-    auto pos = mOffsets.find(key);
-    if (pos == mOffsets.end()) {
-        return false;
-    }
-
-    size_t offset = pos->second;
-    if (offset == 0) {
+    uint32_t offset;
+    if (!getOffset(shaderModel, variant, ps, &offset) || offset == 0) {
         // This shader was not found.
         return false;
     }
@@ -118,14 +143,21 @@ bool MaterialChunk::getTextShader(Unflattener unflattener, BlobDictionary const&
         return false;
     }
 
-    // Read all lines.
-    for(int32_t i = 0 ; i < lineCount; i++) {
-        uint16_t lineIndex;
-        if (!unflattener.read(&lineIndex)) {
+    // The line indices are read straight from the package.
+    const uint8_t* const lines = unflattener.getCursor();
+    if (unflattener.willOverflow(lineCount * sizeof(uint16_t))) {
+        return false;
+    }
+
+    // Read all lines, their length is known, no need to scan them.
+    const size_t dictionarySize = dictionary.size();
+    for (uint32_t i = 0; i < lineCount; i++) {
+        const size_t lineIndex = lines[i * 2] | (lines[i * 2 + 1] << 8);
+        if (UTILS_UNLIKELY(lineIndex >= dictionarySize)) {
             return false;
         }
-        const char* string = dictionary.getString(lineIndex);
-        shaderBuilder.append(string, strlen(string));
+        shaderBuilder.append(dictionary.getString(lineIndex),
+                dictionary.getStringLength(lineIndex));
         shaderBuilder.append("\n", 1);
     }
 
@@ -143,20 +175,27 @@ bool MaterialChunk::getSpirvShader(BlobDictionary const& dictionary,
         return false;
     }
 
-    uint32_t key = makeKey(shaderModel, variant, stage);
-    auto pos = mOffsets.find(key);
-    if (pos == mOffsets.end()) {
+    uint32_t index;
+    if (!getOffset(shaderModel, variant, stage, &index)) {
         return false;
     }
 
-    size_t index = pos->second;
-    size_t shaderSize;
-    const char* shaderContent = dictionary.getBlob(index, &shaderSize);
+    // The SPIR-V dictionary holds SMOL-V compressed blobs, which are decompressed on demand,
+    // straight into the ShaderBuilder.
+#if defined (FILAMENT_DRIVER_SUPPORTS_VULKAN)
+    size_t compressedSize;
+    const char* compressed = dictionary.getBlob(index, &compressedSize);
+    const size_t shaderSize = smolv::GetDecodedBufferSize(compressed, compressedSize);
+    if (shaderSize == 0) {
+        return false;
+    }
 
     shaderBuilder.reset();
     shaderBuilder.announce(shaderSize);
-    shaderBuilder.append(shaderContent, shaderSize);
-    return true;
+    return smolv::Decode(compressed, compressedSize, shaderBuilder.append(shaderSize), shaderSize);
+#else
+    return false;
+#endif
 }
 
 bool MaterialChunk::getShader(ShaderBuilder& shaderBuilder,
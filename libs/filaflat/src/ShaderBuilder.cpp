@@ -49,4 +49,12 @@ void ShaderBuilder::append(const char* data, size_t size) noexcept {
     mCursor += size;
 }
 
+char* ShaderBuilder::append(size_t size) noexcept {
+    size_t available = mCapacity - mCursor;
+    assert(size <= available);
+    char* const p = mShader + mCursor;
+    mCursor += size;
+    return p;
+}
+
 }
@@ -35,7 +35,10 @@
 
 namespace filamat {
 
+struct MaterialDictionaries;
 struct MaterialInfo;
+class ShaderCache;
+class ShaderGenerator;
 
 class UTILS_PUBLIC MaterialBuilderBase {
 public:
@@ -90,6 +93,7 @@ protected:
     };
     std::vector<CodeGenParams> mCodeGenPermutations;
     uint8_t mVariantFilter = 0;
+    uint32_t mUsedVariants = UINT32_MAX;
 
     // Keeps track of how many times MaterialBuilder::init() has been called without a call to
     // MaterialBuilder::shutdown(). Internally, glslang does something similar. We keep track for
@@ -281,6 +285,17 @@ public:
     // specifies a list of variants that should be filtered out during code generation.
     MaterialBuilder& variantFilter(uint8_t variantFilter) noexcept;
 
+    // specifies the variants this material is actually used with, as a bitmask where bit N is
+    // set when variant N is used, e.g. as returned by filament::Material::getUsedVariants().
+    // Only the shaders needed by these variants are generated, other variants fall back to the
+    // closest variant available at runtime. The base variant (0) is always generated.
+    MaterialBuilder& usedVariants(uint32_t usedVariants) noexcept;
+
+    // specifies a directory where the compiled shaders are cached. Shaders whose generated code
+    // and compilation parameters didn't change since a previous build are not compiled again.
+    // This is ignored by filamat_lite.
+    MaterialBuilder& shaderCache(const char* directory) noexcept;
+
     // build the material
     Package build() noexcept;
 
@@ -329,7 +344,17 @@ public:
 
     uint8_t getVariantFilter() const { return mVariantFilter; }
 
+    uint32_t getUsedVariants() const { return mUsedVariants; }
+
+    const utils::CString& getMaterialName() const noexcept { return mMaterialName; }
+
 private:
+    friend class MaterialLibraryBuilder;
+
+    // builds the material, adding its shaders to the given dictionaries. When the dictionaries
+    // are shared, they're not emitted in the package, see MaterialLibraryBuilder.
+    Package build(MaterialDictionaries& dictionaries, bool sharedDictionaries) noexcept;
+
     void prepareToBuild(MaterialInfo& info) noexcept;
 
     // Return true if:
@@ -338,9 +363,15 @@ private:
 
     bool checkLiteRequirements() noexcept;
 
+    // a shader to generate and compile for a given variant and code generation permutation
+    struct ShaderJob;
+    void generateShader(ShaderGenerator const& sg, MaterialInfo const& info,
+            ShaderCache const* cache, ShaderJob& shader) const noexcept;
+
     bool isLit() const noexcept { return mShading != filament::Shading::UNLIT; }
 
     utils::CString mMaterialName;
+    utils::CString mShaderCacheDirectory;
 
     utils::CString mMaterialCode;
     utils::CString mMaterialVertexCode;
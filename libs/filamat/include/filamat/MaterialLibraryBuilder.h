@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMAT_MATERIAL_LIBRARY_BUILDER_H
+#define TNT_FILAMAT_MATERIAL_LIBRARY_BUILDER_H
+
+#include <cstddef>
+
+#include <memory>
+
+#include <filamat/MaterialBuilder.h>
+#include <filamat/Package.h>
+
+#include <utils/compiler.h>
+
+namespace filamat {
+
+// Builds a material library: a single package holding several materials, whose shaders share the
+// same dictionaries. Materials built from the same shading models usually have most of their
+// shader code in common, which is then stored only once.
+//
+// A library is loaded at runtime with Engine::createMaterialLibrary(), and its materials are
+// created with Material::Builder::library().
+class UTILS_PUBLIC MaterialLibraryBuilder {
+public:
+    MaterialLibraryBuilder();
+    ~MaterialLibraryBuilder();
+
+    MaterialLibraryBuilder(MaterialLibraryBuilder const& rhs) = delete;
+    MaterialLibraryBuilder& operator=(MaterialLibraryBuilder const& rhs) = delete;
+
+    // Builds a material and adds it to the library. The materials of a library must be built
+    // for the same target APIs. Returns false if the material couldn't be built, or if the
+    // library's dictionaries are full, in which case the library is not valid anymore.
+    bool add(MaterialBuilder& builder) noexcept;
+
+    // Number of materials added to the library.
+    size_t getMaterialCount() const noexcept;
+
+    // Builds the library. The package is invalid if adding a material failed.
+    Package build() noexcept;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> mImpl;
+};
+
+} // namespace filamat
+
+#endif // TNT_FILAMAT_MATERIAL_LIBRARY_BUILDER_H
@@ -16,8 +16,10 @@
 
 #include "filamat/MaterialBuilder.h"
 
+#include <memory>
 #include <vector>
 
+#include <utils/JobSystem.h>
 #include <utils/Panic.h>
 #include <utils/Log.h>
 
@@ -40,8 +42,11 @@
 #include "eiff/DictionaryTextChunk.h"
 #include "eiff/DictionarySpirvChunk.h"
 
+#include "MaterialDictionaries.h"
+
 #ifndef FILAMAT_LITE
 #include "GLSLPostProcessor.h"
+#include "ShaderCache.h"
 #include "sca/GLSLTools.h"
 #else
 #include "sca/GLSLToolsLite.h"
@@ -309,6 +314,16 @@ MaterialBuilder& MaterialBuilder::variantFilter(uint8_t variantFilter) noexcept
     return *this;
 }
 
+MaterialBuilder& MaterialBuilder::usedVariants(uint32_t usedVariants) noexcept {
+    mUsedVariants = usedVariants;
+    return *this;
+}
+
+MaterialBuilder& MaterialBuilder::shaderCache(const char* directory) noexcept {
+    mShaderCacheDirectory = CString(directory);
+    return *this;
+}
+
 bool MaterialBuilder::hasExternalSampler() const noexcept {
     for (size_t i = 0, c = mParameterCount; i < c; i++) {
         auto const& param = mParameters[i];
@@ -432,7 +447,75 @@ static void showErrorMessage(const char* materialName, uint8_t variant,
             << shaderCode;
 }
 
+struct MaterialBuilder::ShaderJob {
+    CodeGenParams const* params;
+    uint8_t variant;
+    filament::backend::ShaderType stage;
+    bool ok = false;
+    std::string glsl;               // or the shader that failed to compile
+    std::vector<uint32_t> spirv;
+    std::string msl;
+};
+
+void MaterialBuilder::generateShader(ShaderGenerator const& sg, MaterialInfo const& info,
+        ShaderCache const* cache, ShaderJob& shader) const noexcept {
+    const ShaderModel shaderModel = ShaderModel(shader.params->shaderModel);
+    const TargetApi targetApi = shader.params->targetApi;
+    const TargetLanguage targetLanguage = shader.params->targetLanguage;
+
+    if (shader.stage == filament::backend::ShaderType::VERTEX) {
+        shader.glsl = sg.createVertexProgram(shaderModel, targetApi, targetLanguage, info,
+                shader.variant, mInterpolation, mVertexDomain);
+    } else {
+        shader.glsl = sg.createFragmentProgram(shaderModel, targetApi, targetLanguage, info,
+                shader.variant, mInterpolation);
+    }
+
+#ifndef FILAMAT_LITE
+    // the generated code includes everything the compiled shaders depend on, except for the
+    // compilation parameters
+    const std::string source = cache ? shader.glsl : std::string();
+    const ShaderCache::Key key{ source, shader.stage, shaderModel, targetApi, targetLanguage,
+            mOptimization };
+    if (cache && cache->get(key, &shader.glsl, &shader.spirv, &shader.msl)) {
+        shader.ok = true;
+        return;
+    }
+
+    // Metal Shading Language is cross-compiled from Vulkan.
+    const bool targetApiNeedsSpirv =
+            (targetApi == TargetApi::VULKAN || targetApi == TargetApi::METAL);
+    const bool targetApiNeedsMsl = targetApi == TargetApi::METAL;
+    std::vector<uint32_t>* pSpirv = targetApiNeedsSpirv ? &shader.spirv : nullptr;
+    std::string* pMsl = targetApiNeedsMsl ? &shader.msl : nullptr;
+
+    // the post-processor is stateful, so we need one per shader
+    GLSLPostProcessor postProcessor(mOptimization, mPrintShaders);
+    shader.ok = postProcessor.process(shader.glsl, shader.stage, shaderModel,
+            &shader.glsl, pSpirv, pMsl);
+#else
+    shader.ok = true;
+#endif
+
+    if (shader.ok && targetApi == TargetApi::OPENGL &&
+            targetLanguage == TargetLanguage::SPIRV) {
+        sg.fixupExternalSamplers(shaderModel, shader.glsl, info);
+    }
+
+#ifndef FILAMAT_LITE
+    if (shader.ok && cache) {
+        cache->put(key, shader.glsl, shader.spirv, shader.msl);
+    }
+#endif
+}
+
 Package MaterialBuilder::build() noexcept {
+    MaterialDictionaries dictionaries;
+    return build(dictionaries, false);
+}
+
+Package MaterialBuilder::build(MaterialDictionaries& dictionaries,
+        bool sharedDictionaries) noexcept {
     if (materialBuilderClients == 0) {
         utils::slog.e << "Error: MaterialBuilder::init() must be called before build()."
             << utils::io::endl;
@@ -455,11 +538,6 @@ Package MaterialBuilder::build() noexcept {
     MaterialInfo info;
     prepareToBuild(info);
 
-    // Create a postprocessor to optimize / compile to Spir-V if necessary.
-#ifndef FILAMAT_LITE
-    GLSLPostProcessor postProcessor(mOptimization, mPrintShaders);
-#endif
-
     // Create chunk tree.
     ChunkContainer container;
 
@@ -556,13 +634,11 @@ Package MaterialBuilder::build() noexcept {
     std::vector<TextEntry> glslEntries;
     std::vector<SpirvEntry> spirvEntries;
     std::vector<TextEntry> metalEntries;
-    LineDictionary glslDictionary;
+    LineDictionary& glslDictionary = dictionaries.glsl;
 #ifndef FILAMAT_LITE
-    BlobDictionary spirvDictionary;
-    LineDictionary metalDictionary;
+    BlobDictionary& spirvDictionary = dictionaries.spirv;
+    LineDictionary& metalDictionary = dictionaries.metal;
 #endif
-    std::vector<uint32_t> spirv;
-    std::string msl;
 
     ShaderGenerator sg(mProperties, mVariables,
             mMaterialCode, mMaterialLineOffset, mMaterialVertexCode, mMaterialVertexLineOffset);
@@ -577,158 +653,136 @@ Package MaterialBuilder::build() noexcept {
     map.populate(&info.sib, mMaterialName.c_str());
     info.samplerBindings = std::move(map);
 
-    for (const auto& params : mCodeGenPermutations) {
-        const ShaderModel shaderModel = ShaderModel(params.shaderModel);
-        const TargetApi targetApi = params.targetApi;
-        const TargetLanguage targetLanguage = params.targetLanguage;
-
-        // Metal Shading Language is cross-compiled from Vulkan.
-        const bool targetApiNeedsSpirv =
-                (targetApi == TargetApi::VULKAN || targetApi == TargetApi::METAL);
-        const bool targetApiNeedsMsl = targetApi == TargetApi::METAL;
-        std::vector<uint32_t>* pSpirv = targetApiNeedsSpirv ? &spirv : nullptr;
-        std::string* pMsl = targetApiNeedsMsl ? &msl : nullptr;
-
-        TextEntry glslEntry{0};
-        SpirvEntry spirvEntry{0};
-        TextEntry metalEntry{0};
-
-        glslEntry.shaderModel = static_cast<uint8_t>(params.shaderModel);
-        spirvEntry.shaderModel = static_cast<uint8_t>(params.shaderModel);
-        metalEntry.shaderModel = static_cast<uint8_t>(params.shaderModel);
-
-        // apply custom variants filters
-        uint8_t variantMask = ~mVariantFilter;
+    // apply custom variants filters
+    const uint8_t variantMask = ~mVariantFilter;
+    const bool isVariantLit = isLit() || mShadowMultiplier;
+
+    // The vertex and fragment shaders needed by the variants in use, the base variant is always
+    // kept since it's the last resort fallback at runtime.
+    uint32_t usedVertexShaders = 1u;
+    uint32_t usedFragmentShaders = 1u;
+    for (uint8_t k = 0; k < filament::VARIANT_COUNT; k++) {
+        if (!(mUsedVariants & (1u << k))) {
+            continue;
+        }
+        uint8_t v = filament::Variant::filterVariant(k & variantMask, isVariantLit);
+        usedVertexShaders |= 1u << filament::Variant::filterVariantVertex(v);
+        usedFragmentShaders |= 1u << filament::Variant::filterVariantFragment(v);
+    }
 
+    // List all the shaders to generate, in the order they're stored in the package.
+    std::vector<ShaderJob> shaders;
+    for (const auto& params : mCodeGenPermutations) {
         for (uint8_t k = 0; k < filament::VARIANT_COUNT; k++) {
+            // Remove variants for unlit materials
+            uint8_t v = filament::Variant::filterVariant(k & variantMask, isVariantLit);
 
-            if (filament::Variant::isReserved(k)) {
-                continue;
+            if (filament::Variant::filterVariantVertex(v) == k &&
+                    (usedVertexShaders & (1u << k))) {
+                shaders.push_back({ &params, k, filament::backend::ShaderType::VERTEX });
             }
+            if (filament::Variant::filterVariantFragment(v) == k &&
+                    (usedFragmentShaders & (1u << k))) {
+                shaders.push_back({ &params, k, filament::backend::ShaderType::FRAGMENT });
+            }
+        }
+    }
 
-            glslEntry.variant = k;
-            spirvEntry.variant = k;
-            metalEntry.variant = k;
-
-            // Remove variants for unlit materials
-            uint8_t v = filament::Variant::filterVariant(
-                    k & variantMask, isLit() || mShadowMultiplier);
-
-            if (filament::Variant::filterVariantVertex(v) == k) {
-                // Vertex Shader
-                std::string vs = sg.createVertexProgram(
-                        shaderModel, targetApi, targetLanguage, info, k,
-                        mInterpolation, mVertexDomain);
+    // Generate and compile the shaders, these are independent of each other so they're spread
+    // over all cores. The output is kept in order of course.
+    ShaderCache const* cache = nullptr;
 #ifndef FILAMAT_LITE
-                bool ok = postProcessor.process(vs, filament::backend::ShaderType::VERTEX,
-                        shaderModel, &vs, pSpirv, pMsl);
-#else
-                bool ok = true;
+    std::unique_ptr<ShaderCache> diskCache;
+    if (!mShaderCacheDirectory.empty()) {
+        diskCache.reset(new ShaderCache(mShaderCacheDirectory.c_str()));
+        cache = diskCache.get();
+    }
 #endif
-                if (!ok) {
-                    showErrorMessage(mMaterialName.c_str_safe(), k, targetApi,
-                            filament::backend::ShaderType::VERTEX, vs);
-                    errorOccured = true;
-                    break;
-                }
-
-                if (targetApi == TargetApi::OPENGL) {
-                    if (targetLanguage == TargetLanguage::SPIRV) {
-                        sg.fixupExternalSamplers(shaderModel, vs, info);
-                    }
-
-                    glslEntry.stage = filament::backend::ShaderType::VERTEX;
-                    glslEntry.shaderSize = vs.size();
-                    glslEntry.shader = (char*) malloc(glslEntry.shaderSize + 1);
-                    strcpy(glslEntry.shader, vs.c_str());
-                    glslDictionary.addText(glslEntry.shader);
-                    glslEntries.push_back(glslEntry);
-                }
+    auto work = [this, &sg, &info, cache, &shaders](uint32_t first, uint32_t count) {
+        for (uint32_t i = first, e = first + count; i < e; i++) {
+            generateShader(sg, info, cache, shaders[i]);
+        }
+    };
+    if (mPrintShaders || shaders.size() < 2) {
+        // when printing the shaders, keep them in order
+        work(0, uint32_t(shaders.size()));
+    } else {
+        JobSystem js;
+        js.adopt();
+        auto job = jobs::parallel_for(js, nullptr, 0, uint32_t(shaders.size()),
+                std::cref(work), jobs::CountSplitter<1, 16>());
+        js.runAndWait(job);
+        js.emancipate();
+    }
 
-#ifndef FILAMAT_LITE
-                if (targetApi == TargetApi::VULKAN) {
-                    assert(!spirv.empty());
-                    spirvEntry.stage = filament::backend::ShaderType::VERTEX;
-                    spirvEntry.dictionaryIndex = spirvDictionary.addBlob(spirv);
-                    spirv.clear();
-                    spirvEntries.push_back(spirvEntry);
-                }
-                if (targetApi == TargetApi::METAL) {
-                    assert(spirv.size() > 0);
-                    assert(msl.length() > 0);
-                    metalEntry.stage = filament::backend::ShaderType::VERTEX;
-                    metalEntry.shaderSize = msl.length();
-                    metalEntry.shader = (char*)malloc(metalEntry.shaderSize + 1);
-                    strcpy(metalEntry.shader, msl.c_str());
-                    spirv.clear();
-                    msl.clear();
-                    metalDictionary.addText(metalEntry.shader);
-                    metalEntries.push_back(metalEntry);
-                }
-#endif
-            }
+    // Gather the shaders into the dictionaries.
+    CodeGenParams const* failedPermutation = nullptr;
+    for (ShaderJob& shader : shaders) {
+        CodeGenParams const& params = *shader.params;
+        const TargetApi targetApi = params.targetApi;
+        const uint8_t shaderModel = static_cast<uint8_t>(params.shaderModel);
 
-            if (filament::Variant::filterVariantFragment(v) == k) {
-                // Fragment Shader
-                std::string fs = sg.createFragmentProgram(
-                        shaderModel, targetApi, targetLanguage, info, k, mInterpolation);
+        // only report the first error of each permutation
+        if (&params == failedPermutation) {
+            continue;
+        }
+        if (!shader.ok) {
+            showErrorMessage(mMaterialName.c_str_safe(), shader.variant, targetApi,
+                    shader.stage, shader.glsl);
+            errorOccured = true;
+            failedPermutation = &params;
+            continue;
+        }
 
-#ifndef FILAMAT_LITE
-                bool ok = postProcessor.process(fs, filament::backend::ShaderType::FRAGMENT,
-                        shaderModel, &fs, pSpirv, pMsl);
-#else
-                bool ok = true;
-#endif
-                if (!ok) {
-                    showErrorMessage(mMaterialName.c_str_safe(), k, targetApi,
-                            filament::backend::ShaderType::FRAGMENT, fs);
-                    errorOccured = true;
-                    break;
-                }
-
-                if (targetApi == TargetApi::OPENGL) {
-                    if (targetLanguage == TargetLanguage::SPIRV) {
-                        sg.fixupExternalSamplers(shaderModel, fs, info);
-                    }
-
-                    glslEntry.stage = filament::backend::ShaderType::FRAGMENT;
-                    glslEntry.shaderSize = fs.size();
-                    glslEntry.shader = (char*) malloc(glslEntry.shaderSize + 1);
-                    strcpy(glslEntry.shader, fs.c_str());
-                    glslDictionary.addText(glslEntry.shader);
-                    glslEntries.push_back(glslEntry);
-                }
+        if (targetApi == TargetApi::OPENGL) {
+            TextEntry glslEntry{0};
+            glslEntry.shaderModel = shaderModel;
+            glslEntry.variant = shader.variant;
+            glslEntry.stage = shader.stage;
+            glslEntry.shaderSize = shader.glsl.size();
+            glslEntry.shader = (char*) malloc(glslEntry.shaderSize + 1);
+            strcpy(glslEntry.shader, shader.glsl.c_str());
+            glslDictionary.addText(glslEntry.shader);
+            glslEntries.push_back(glslEntry);
+        }
 
 #ifndef FILAMAT_LITE
-                if (targetApi == TargetApi::VULKAN) {
-                    assert(!spirv.empty());
-                    spirvEntry.stage = filament::backend::ShaderType::FRAGMENT;
-                    spirvEntry.dictionaryIndex = spirvDictionary.addBlob(spirv);
-                    spirv.clear();
-                    spirvEntries.push_back(spirvEntry);
-                }
-                if (targetApi == TargetApi::METAL) {
-                    assert(spirv.size() > 0);
-                    assert(msl.length() > 0);
-                    metalEntry.stage = filament::backend::ShaderType::FRAGMENT;
-                    metalEntry.shaderSize = msl.length();
-                    metalEntry.shader = (char*)malloc(metalEntry.shaderSize + 1);
-                    strcpy(metalEntry.shader, msl.c_str());
-                    spirv.clear();
-                    msl.clear();
-                    metalDictionary.addText(metalEntry.shader);
-                    metalEntries.push_back(metalEntry);
-                }
-#endif
-            }
+        if (targetApi == TargetApi::VULKAN) {
+            assert(!shader.spirv.empty());
+            SpirvEntry spirvEntry{0};
+            spirvEntry.shaderModel = shaderModel;
+            spirvEntry.variant = shader.variant;
+            spirvEntry.stage = shader.stage;
+            spirvEntry.dictionaryIndex = spirvDictionary.addBlob(shader.spirv);
+            spirvEntries.push_back(spirvEntry);
         }
+        if (targetApi == TargetApi::METAL) {
+            assert(!shader.spirv.empty());
+            assert(!shader.msl.empty());
+            TextEntry metalEntry{0};
+            metalEntry.shaderModel = shaderModel;
+            metalEntry.variant = shader.variant;
+            metalEntry.stage = shader.stage;
+            metalEntry.shaderSize = shader.msl.length();
+            metalEntry.shader = (char*)malloc(metalEntry.shaderSize + 1);
+            strcpy(metalEntry.shader, shader.msl.c_str());
+            metalDictionary.addText(metalEntry.shader);
+            metalEntries.push_back(metalEntry);
+        }
+#endif
+
+        // we don't need this shader anymore
+        shader = { shader.params, shader.variant, shader.stage };
     }
 
     // Emit GLSL chunks (TextDictionaryReader and MaterialTextChunk).
+    // Shared dictionaries are emitted once by the library instead.
     filamat::DictionaryTextChunk dicGlslChunk(glslDictionary, ChunkType::DictionaryGlsl);
     MaterialTextChunk glslChunk(glslEntries, glslDictionary, ChunkType::MaterialGlsl);
     if (!glslEntries.empty()) {
-        container.addChild(&dicGlslChunk);
+        if (!sharedDictionaries) {
+            container.addChild(&dicGlslChunk);
+        }
         container.addChild(&glslChunk);
     }
 
@@ -737,7 +791,9 @@ Package MaterialBuilder::build() noexcept {
     filamat::DictionarySpirvChunk dicSpirvChunk(spirvDictionary);
     MaterialSpirvChunk spirvChunk(spirvEntries);
     if (!spirvEntries.empty()) {
-        container.addChild(&dicSpirvChunk);
+        if (!sharedDictionaries) {
+            container.addChild(&dicSpirvChunk);
+        }
         container.addChild(&spirvChunk);
     }
 
@@ -745,7 +801,9 @@ Package MaterialBuilder::build() noexcept {
     filamat::DictionaryTextChunk dicMetalChunk(metalDictionary, ChunkType::DictionaryMetal);
     MaterialTextChunk metalChunk(metalEntries, metalDictionary, ChunkType::MaterialMetal);
     if (!metalEntries.empty()) {
-        container.addChild(&dicMetalChunk);
+        if (!sharedDictionaries) {
+            container.addChild(&dicMetalChunk);
+        }
         container.addChild(&metalChunk);
     }
 #endif
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMAT_MATERIALDICTIONARIES_H
+#define TNT_FILAMAT_MATERIALDICTIONARIES_H
+
+#include "eiff/LineDictionary.h"
+
+#ifndef FILAMAT_LITE
+#include "eiff/BlobDictionary.h"
+#endif
+
+namespace filamat {
+
+// The dictionaries holding the shaders of a material, or of all the materials of a library.
+struct MaterialDictionaries {
+    LineDictionary glsl;
+#ifndef FILAMAT_LITE
+    BlobDictionary spirv;
+    LineDictionary metal;
+#endif
+};
+
+} // namespace filamat
+
+#endif // TNT_FILAMAT_MATERIALDICTIONARIES_H
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "filamat/MaterialLibraryBuilder.h"
+
+#include "MaterialDictionaries.h"
+
+#include "eiff/ChunkContainer.h"
+#include "eiff/DictionaryTextChunk.h"
+#include "eiff/MaterialLibraryChunk.h"
+#include "eiff/SimpleFieldChunk.h"
+
+#ifndef FILAMAT_LITE
+#include "eiff/DictionarySpirvChunk.h"
+#endif
+
+#include <filament/MaterialEnums.h>
+
+#include <utils/Log.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <stdint.h>
+
+namespace filamat {
+
+struct MaterialLibraryBuilder::Impl {
+    MaterialDictionaries dictionaries;
+    std::vector<LibraryEntry> entries;
+    bool valid = true;
+};
+
+MaterialLibraryBuilder::MaterialLibraryBuilder() : mImpl(new Impl) {
+}
+
+MaterialLibraryBuilder::~MaterialLibraryBuilder() = default;
+
+bool MaterialLibraryBuilder::add(MaterialBuilder& builder) noexcept {
+    MaterialDictionaries& dictionaries = mImpl->dictionaries;
+    Package package = builder.build(dictionaries, true);
+    if (!package.isValid()) {
+        mImpl->valid = false;
+        return false;
+    }
+
+    // shaders reference the lines of the text dictionaries with 16-bits indices
+    size_t lineCount = dictionaries.glsl.getLineCount();
+#ifndef FILAMAT_LITE
+    lineCount = std::max(lineCount, dictionaries.metal.getLineCount());
+#endif
+    if (lineCount > UINT16_MAX + 1u) {
+        utils::slog.e << "Error: material library is full, can't add material '"
+                << builder.mMaterialName.c_str_safe() << "'." << utils::io::endl;
+        mImpl->valid = false;
+        return false;
+    }
+
+    mImpl->entries.push_back({ builder.mMaterialName.c_str_safe(), std::move(package) });
+    return true;
+}
+
+size_t MaterialLibraryBuilder::getMaterialCount() const noexcept {
+    return mImpl->entries.size();
+}
+
+Package MaterialLibraryBuilder::build() noexcept {
+    MaterialDictionaries& dictionaries = mImpl->dictionaries;
+
+    ChunkContainer container;
+
+    SimpleFieldChunk<uint32_t> matVersion(ChunkType::MaterialVersion, filament::MATERIAL_VERSION);
+    container.addChild(&matVersion);
+
+    DictionaryTextChunk dicGlslChunk(dictionaries.glsl, ChunkType::DictionaryGlsl);
+    if (!dictionaries.glsl.isEmpty()) {
+        container.addChild(&dicGlslChunk);
+    }
+
+#ifndef FILAMAT_LITE
+    DictionarySpirvChunk dicSpirvChunk(dictionaries.spirv);
+    if (!dictionaries.spirv.isEmpty()) {
+        container.addChild(&dicSpirvChunk);
+    }
+
+    DictionaryTextChunk dicMetalChunk(dictionaries.metal, ChunkType::DictionaryMetal);
+    if (!dictionaries.metal.isEmpty()) {
+        container.addChild(&dicMetalChunk);
+    }
+#endif
+
+    MaterialLibraryChunk libraryChunk(mImpl->entries);
+    container.addChild(&libraryChunk);
+
+    Package package(container.getSize());
+    Flattener f(package);
+    container.flatten(f);
+    package.setValid(mImpl->valid);
+    return package;
+}
+
+} // namespace filamat
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ShaderCache.h"
+
+#include <filament/MaterialEnums.h>
+
+#include <glslang/Include/revision.h>
+#include <ShaderLang.h>
+#include <spirv-tools/libspirv.h>
+
+#include <memory>
+
+#include <string.h>
+
+using namespace utils;
+
+namespace filamat {
+
+// Each entry starts with this header, followed by the GLSL, SPIR-V and MSL shaders.
+struct EntryHeader {
+    uint32_t glslSize;
+    uint32_t spirvSize;     // in words
+    uint32_t mslSize;
+};
+
+ShaderCache::ShaderCache(const char* directory) : mStore(directory) {
+}
+
+std::string ShaderCache::getKeyData(Key const& key) noexcept {
+    // The material version and the compilers' versions are part of the key, so that the cache
+    // is invalidated when the material format or the compilers change. SPIRV-Cross doesn't have
+    // a version, it's updated along with the other compilers.
+    const uint8_t params[] = {
+            uint8_t(key.stage),
+            uint8_t(key.shaderModel),
+            uint8_t(key.targetApi),
+            uint8_t(key.targetLanguage),
+            uint8_t(key.optimization)
+    };
+    const uint32_t versions[] = {
+            filament::MATERIAL_VERSION,
+            GLSLANG_MINOR_VERSION,
+            GLSLANG_PATCH_LEVEL
+    };
+    std::string data((char const*)versions, sizeof(versions));
+    data.append(spvSoftwareVersionDetailsString());
+    data.push_back('\0');
+    data.append((char const*)params, sizeof(params));
+    data.append(key.shader);
+    return data;
+}
+
+bool ShaderCache::get(Key const& key, std::string* outputGlsl,
+        std::vector<uint32_t>* outputSpirv, std::string* outputMsl) const noexcept {
+    const std::string keyData = getKeyData(key);
+    const size_t size = mStore.retrieve(keyData.data(), keyData.size(), nullptr, 0);
+    if (size < sizeof(EntryHeader)) {
+        return false;
+    }
+
+    std::unique_ptr<uint8_t[]> entry(new uint8_t[size]);
+    if (mStore.retrieve(keyData.data(), keyData.size(), entry.get(), size) != size) {
+        return false;
+    }
+
+    EntryHeader header;
+    memcpy(&header, entry.get(), sizeof(header));
+    if (size != sizeof(header) + header.glslSize + header.spirvSize * sizeof(uint32_t) +
+            header.mslSize) {
+        return false;
+    }
+
+    uint8_t const* data = entry.get() + sizeof(header);
+    std::string glsl((char const*)data, header.glslSize);
+    data += header.glslSize;
+    std::vector<uint32_t> spirv(header.spirvSize);
+    memcpy(spirv.data(), data, header.spirvSize * sizeof(uint32_t));
+    data += header.spirvSize * sizeof(uint32_t);
+    std::string msl((char const*)data, header.mslSize);
+
+    if (outputGlsl) *outputGlsl = std::move(glsl);
+    if (outputSpirv) *outputSpirv = std::move(spirv);
+    if (outputMsl) *outputMsl = std::move(msl);
+    return true;
+}
+
+void ShaderCache::put(Key const& key, std::string const& glsl,
+        std::vector<uint32_t> const& spirv, std::string const& msl) const noexcept {
+    const std::string keyData = getKeyData(key);
+
+    const EntryHeader header{
+            uint32_t(glsl.size()), uint32_t(spirv.size()), uint32_t(msl.size()) };
+    std::string entry((char const*)&header, sizeof(header));
+    entry.append(glsl);
+    entry.append((char const*)spirv.data(), spirv.size() * sizeof(uint32_t));
+    entry.append(msl);
+
+    mStore.insert(keyData.data(), keyData.size(), entry.data(), entry.size());
+}
+
+} // namespace filamat
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMAT_SHADERCACHE_H
+#define TNT_FILAMAT_SHADERCACHE_H
+
+#include <backend/DriverEnums.h>
+
+#include "filamat/MaterialBuilder.h"
+
+#include <utils/FileBlobStore.h>
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace filamat {
+
+/*
+ * An on-disk cache of compiled shaders, stored in a utils::FileBlobStore.
+ *
+ * Entries are keyed on the generated shader text, which includes all the material's code and
+ * the variant's defines, as well as the compilation parameters and the versions of the shader
+ * compilers. The cache only grows, it is up to the user to clear it. The cache can be shared
+ * between concurrent builds.
+ */
+class ShaderCache {
+public:
+    struct Key {
+        std::string const& shader;
+        filament::backend::ShaderType stage;
+        filament::backend::ShaderModel shaderModel;
+        MaterialBuilder::TargetApi targetApi;
+        MaterialBuilder::TargetLanguage targetLanguage;
+        MaterialBuilder::Optimization optimization;
+    };
+
+    explicit ShaderCache(const char* directory);
+
+    // Returns true and the compiled shaders if the key is in the cache.
+    bool get(Key const& key, std::string* outputGlsl,
+            std::vector<uint32_t>* outputSpirv, std::string* outputMsl) const noexcept;
+
+    void put(Key const& key, std::string const& glsl,
+            std::vector<uint32_t> const& spirv, std::string const& msl) const noexcept;
+
+private:
+    static std::string getKeyData(Key const& key) noexcept;
+
+    mutable utils::FileBlobStore mStore;
+};
+
+} // namespace filamat
+
+#endif // TNT_FILAMAT_SHADERCACHE_H
@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MaterialLibraryChunk.h"
+
+namespace filamat {
+
+MaterialLibraryChunk::MaterialLibraryChunk(std::vector<LibraryEntry> const& entries) :
+        Chunk(ChunkType::MaterialLibrary), mEntries(entries) {
+}
+
+void MaterialLibraryChunk::flatten(Flattener& f) {
+    f.writeUint32(static_cast<uint32_t>(mEntries.size()));
+    for (LibraryEntry const& entry : mEntries) {
+        f.writeString(entry.name.c_str());
+        f.writeBlob((const char*) entry.package.getData(), entry.package.getSize());
+    }
+}
+
+} // namespace filamat
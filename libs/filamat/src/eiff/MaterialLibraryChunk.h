@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMAT_MATERIAL_LIBRARY_CHUNK_H
+#define TNT_FILAMAT_MATERIAL_LIBRARY_CHUNK_H
+
+#include <string>
+#include <vector>
+
+#include "Chunk.h"
+#include "Flattener.h"
+
+#include "filamat/Package.h"
+
+namespace filamat {
+
+struct LibraryEntry {
+    std::string name;
+    Package package;
+};
+
+// The materials of a library: their count, then for each material its name and its package.
+// The packages don't contain dictionaries, they use the ones of the library.
+class MaterialLibraryChunk final : public Chunk {
+public:
+    explicit MaterialLibraryChunk(std::vector<LibraryEntry> const& entries);
+    ~MaterialLibraryChunk() = default;
+
+private:
+    void flatten(Flattener& f) override;
+
+    std::vector<LibraryEntry> const& mEntries;
+};
+
+} // namespace filamat
+
+#endif // TNT_FILAMAT_MATERIAL_LIBRARY_CHUNK_H
@@ -19,6 +19,16 @@
 #include "sca/ASTHelpers.h"
 
 #include <filamat/Enums.h>
+#include <filamat/MaterialLibraryBuilder.h>
+
+#include <private/filament/Variant.h>
+
+#include <utils/Path.h>
+
+#include <vector>
+
+#include <stdio.h>
+#include <string.h>
 
 using namespace ASTUtils;
 
@@ -536,6 +546,127 @@ TEST_F(MaterialCompiler, Uv0AndUv1) {
     EXPECT_TRUE(result.isValid());
 }
 
+TEST_F(MaterialCompiler, ShaderCache) {
+    std::string shaderCode(R"(
+        void material(inout MaterialInputs material) {
+            prepareMaterial(material);
+            material.baseColor = vec4(0.8);
+        }
+    )");
+
+    utils::Path cacheDirectory = utils::Path::getTemporaryDirectory().concat("filamat_test_cache");
+    auto clearCache = [&]() {
+        for (utils::Path entry : cacheDirectory.listContents()) {
+            entry.unlinkFile();
+        }
+    };
+    auto build = [&](const char* cache) {
+        filamat::MaterialBuilder builder = makeBuilder(shaderCode);
+        builder.targetApi(filamat::MaterialBuilder::TargetApi::ALL);
+        if (cache) {
+            builder.shaderCache(cache);
+        }
+        return builder.build();
+    };
+
+    clearCache();
+    filamat::Package reference = build(nullptr);
+    filamat::Package uncached = build(cacheDirectory.c_str());
+
+    // Entries ignore trailing bytes, but an entry written again would lose them. Mark all the
+    // entries with a trailing byte to check that the next build only reads from the cache.
+    std::vector<utils::Path> entries = cacheDirectory.listContents();
+    EXPECT_FALSE(entries.empty());
+    std::vector<long> sizes;
+    for (utils::Path const& entry : entries) {
+        FILE* file = fopen(entry.c_str(), "ab");
+        ASSERT_TRUE(file);
+        fputc(0, file);
+        sizes.push_back(ftell(file));
+        fclose(file);
+    }
+
+    filamat::Package cached = build(cacheDirectory.c_str());
+    ASSERT_TRUE(reference.isValid());
+    ASSERT_TRUE(uncached.isValid());
+    ASSERT_TRUE(cached.isValid());
+
+    // the second build was a cache hit
+    EXPECT_EQ(entries.size(), cacheDirectory.listContents().size());
+    for (size_t i = 0; i < entries.size(); i++) {
+        FILE* file = fopen(entries[i].c_str(), "rb");
+        ASSERT_TRUE(file);
+        fseek(file, 0, SEEK_END);
+        EXPECT_EQ(sizes[i], ftell(file));
+        fclose(file);
+    }
+
+    // the packages built with and without the cache are identical
+    ASSERT_EQ(reference.getSize(), uncached.getSize());
+    ASSERT_EQ(reference.getSize(), cached.getSize());
+    EXPECT_EQ(0, memcmp(reference.getData(), uncached.getData(), reference.getSize()));
+    EXPECT_EQ(0, memcmp(reference.getData(), cached.getData(), reference.getSize()));
+
+    clearCache();
+    EXPECT_TRUE(cacheDirectory.rmdir());
+}
+
+TEST_F(MaterialCompiler, MaterialLibrary) {
+    std::string shaderCode0(R"(
+        void material(inout MaterialInputs material) {
+            prepareMaterial(material);
+            material.baseColor = vec4(0.8);
+        }
+    )");
+    std::string shaderCode1(R"(
+        void material(inout MaterialInputs material) {
+            prepareMaterial(material);
+            material.baseColor = vec4(0.2);
+        }
+    )");
+
+    filamat::MaterialBuilder builder0 = makeBuilder(shaderCode0);
+    filamat::MaterialBuilder builder1 = makeBuilder(shaderCode1);
+    builder0.name("material0");
+    builder1.name("material1");
+
+    filamat::MaterialLibraryBuilder libraryBuilder;
+    EXPECT_TRUE(libraryBuilder.add(builder0));
+    EXPECT_TRUE(libraryBuilder.add(builder1));
+    EXPECT_EQ(2, libraryBuilder.getMaterialCount());
+
+    filamat::Package library = libraryBuilder.build();
+    filamat::Package package0 = builder0.build();
+    filamat::Package package1 = builder1.build();
+    ASSERT_TRUE(library.isValid());
+    ASSERT_TRUE(package0.isValid());
+    ASSERT_TRUE(package1.isValid());
+
+    // the shaders of both materials are almost identical, they're stored only once
+    EXPECT_LT(library.getSize(), package0.getSize() + package1.getSize());
+}
+
+TEST_F(MaterialCompiler, UsedVariants) {
+    std::string shaderCode(R"(
+        void material(inout MaterialInputs material) {
+            prepareMaterial(material);
+            material.baseColor = vec4(0.8);
+        }
+    )");
+
+    filamat::MaterialBuilder allBuilder = makeBuilder(shaderCode);
+    filamat::MaterialBuilder usedBuilder = makeBuilder(shaderCode);
+    usedBuilder.usedVariants(1u << filament::Variant::DIRECTIONAL_LIGHTING);
+
+    filamat::Package all = allBuilder.build();
+    filamat::Package used = usedBuilder.build();
+    ASSERT_TRUE(all.isValid());
+    ASSERT_TRUE(used.isValid());
+
+    // only the base and directional lighting variants are compiled
+    EXPECT_LT(used.getSize(), all.getSize());
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -128,6 +128,12 @@ SurfaceOrientation Builder::build() {
     return mImpl->buildWithUvs();
 }
 
+// Returns the element at the given index of an array with the given stride in bytes.
+template<typename T>
+static const T& at(const T* array, size_t stride, size_t index) {
+    return *(const T*) (((const uint8_t*) array) + stride * index);
+}
+
 static float3 randomPerp(const float3& n) {
     float3 perp = cross(n, float3{1, 0, 0});
     float sqrlen = dot(perp, perp);
@@ -187,22 +193,21 @@ SurfaceOrientation OrientationBuilderImpl::buildWithSuppliedTangents() {
 // re-indexing via meshoptimizer and is therefore a bit heavyweight.
 //
 SurfaceOrientation OrientationBuilderImpl::buildWithUvs() {
-    ASSERT_PRECONDITION(this->normalStride == 0, "Non-zero normal stride not yet supported.");
-    ASSERT_PRECONDITION(this->tangentStride == 0, "Non-zero tangent stride not yet supported.");
-    ASSERT_PRECONDITION(this->uvStride == 0, "Non-zero uv stride not yet supported.");
-    ASSERT_PRECONDITION(this->positionStride == 0, "Non-zero positions stride not yet supported.");
+    const size_t nstride = this->normalStride ? this->normalStride : sizeof(float3);
+    const size_t pstride = this->positionStride ? this->positionStride : sizeof(float3);
+    const size_t uvstride = this->uvStride ? this->uvStride : sizeof(float2);
     vector<float3> tan1(vertexCount);
     vector<float3> tan2(vertexCount);
     memset(tan1.data(), 0, sizeof(float3) * vertexCount);
     memset(tan2.data(), 0, sizeof(float3) * vertexCount);
     for (size_t a = 0; a < triangleCount; ++a) {
         uint3 tri = triangles16 ? uint3(triangles16[a]) : triangles32[a];
-        const float3& v1 = positions[tri.x];
-        const float3& v2 = positions[tri.y];
-        const float3& v3 = positions[tri.z];
-        const float2& w1 = uvs[tri.x];
-        const float2& w2 = uvs[tri.y];
-        const float2& w3 = uvs[tri.z];
+        const float3& v1 = at(positions, pstride, tri.x);
+        const float3& v2 = at(positions, pstride, tri.y);
+        const float3& v3 = at(positions, pstride, tri.z);
+        const float2& w1 = at(uvs, uvstride, tri.x);
+        const float2& w2 = at(uvs, uvstride, tri.y);
+        const float2& w3 = at(uvs, uvstride, tri.z);
         float x1 = v2.x - v1.x;
         float x2 = v3.x - v1.x;
         float y1 = v2.y - v1.y;
@@ -218,7 +223,7 @@ SurfaceOrientation OrientationBuilderImpl::buildWithUvs() {
         // In general we can't guarantee smooth tangents when the UV's are non-smooth, but let's at
         // least avoid divide-by-zero and fall back to normals-only method.
         if (d == 0.0) {
-            const float3& n1 = normals[tri.x];
+            const float3& n1 = at(normals, nstride, tri.x);
             sdir = randomPerp(n1);
             tdir = cross(n1, sdir);
         } else {
@@ -238,7 +243,7 @@ SurfaceOrientation OrientationBuilderImpl::buildWithUvs() {
 
     vector<quatf> quats(vertexCount);
     for (size_t a = 0; a < vertexCount; a++) {
-        const float3& n = normals[a];
+        const float3& n = at(normals, nstride, a);
         const float3& t1 = tan1[a];
         const float3& t2 = tan2[a];
 
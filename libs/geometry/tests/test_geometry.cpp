@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <geometry/SurfaceOrientation.h>
+
+#include <math/quat.h>
+#include <math/vec2.h>
+#include <math/vec3.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace filament::geometry;
+using namespace filament::math;
+
+class SurfaceOrientationTest : public testing::Test {};
+
+// A unit quad in the XY plane, made of two triangles.
+static const float3 QUAD_POSITIONS[] = { {0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {1, 1, 0} };
+static const float3 QUAD_NORMALS[] = { {0, 0, 1}, {0, 0, 1}, {0, 0, 1}, {0, 0, 1} };
+static const float2 QUAD_UVS[] = { {0, 0}, {1, 0}, {0, 1}, {1, 1} };
+static const uint3 QUAD_TRIANGLES[] = { {0, 1, 2}, {2, 1, 3} };
+
+static std::vector<quatf> getQuats(SurfaceOrientation::Builder& builder, size_t vertexCount) {
+    SurfaceOrientation orientation = builder.build();
+    std::vector<quatf> quats(vertexCount);
+    orientation.getQuats(quats.data(), vertexCount);
+    return quats;
+}
+
+TEST_F(SurfaceOrientationTest, UvsPacked) {
+    SurfaceOrientation::Builder builder;
+    builder.vertexCount(4)
+            .normals(QUAD_NORMALS)
+            .uvs(QUAD_UVS)
+            .positions(QUAD_POSITIONS)
+            .triangleCount(2)
+            .triangles(QUAD_TRIANGLES);
+    std::vector<quatf> quats = getQuats(builder, 4);
+
+    // The tangent follows U, which is aligned with X.
+    for (const quatf& q : quats) {
+        float3 t = q * float3{1, 0, 0};
+        EXPECT_NEAR(t.x, 1.0f, 1e-5f);
+        EXPECT_NEAR(t.y, 0.0f, 1e-5f);
+        EXPECT_NEAR(t.z, 0.0f, 1e-5f);
+    }
+}
+
+TEST_F(SurfaceOrientationTest, UvsInterleaved) {
+    struct Vertex {
+        float3 position;
+        float3 normal;
+        float2 uv;
+        float padding;
+    };
+    std::vector<Vertex> vertices(4);
+    for (size_t i = 0; i < 4; ++i) {
+        vertices[i] = { QUAD_POSITIONS[i], QUAD_NORMALS[i], QUAD_UVS[i], 0.0f };
+    }
+
+    SurfaceOrientation::Builder packed;
+    packed.vertexCount(4)
+            .normals(QUAD_NORMALS)
+            .uvs(QUAD_UVS)
+            .positions(QUAD_POSITIONS)
+            .triangleCount(2)
+            .triangles(QUAD_TRIANGLES);
+    std::vector<quatf> expected = getQuats(packed, 4);
+
+    SurfaceOrientation::Builder interleaved;
+    interleaved.vertexCount(4)
+            .normals(&vertices[0].normal, sizeof(Vertex))
+            .uvs(&vertices[0].uv, sizeof(Vertex))
+            .positions(&vertices[0].position, sizeof(Vertex))
+            .triangleCount(2)
+            .triangles(QUAD_TRIANGLES);
+    std::vector<quatf> quats = getQuats(interleaved, 4);
+
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(quats[i].xyzw, expected[i].xyzw);
+    }
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -30,24 +30,61 @@ struct AnimatorImpl;
  * according to glTF animation definitions and (2) updating bone matrices in Renderable components
  * according to glTF skin definitions.
  *
- * For a usage example, see the comment block for AssetLoader.
+ * Animations can also drive the weights of morph targets. The positions of morphed primitives are
+ * blended on the CPU, skipping the targets whose weight is zero, and streamed into their vertex
+ * buffer whenever the weights change. Other attributes, such as normals, are not morphed.
  *
- * TODO: add support for morphing.
+ * For a usage example, see the comment block for AssetLoader.
  */
 class Animator {
 public:
     /**
      * Uses TransformManager to apply rotation, translation, and scale to entities that have
      * been targeted by the given animation definition.
+     *
+     * The Animator keeps the rotation, translation and scale of each animated node, starting
+     * from the values found in the glTF file. Components that are not targeted by the animation
+     * keep their last animated value, transforms set on these nodes by the client are replaced.
      */
     void applyAnimation(size_t animationIndex, float time) const;
 
+    /**
+     * One of the animations blended by applyBlendedAnimations().
+     */
+    struct BlendedAnimation {
+        size_t animationIndex;
+        float time;
+        float weight;
+        bool additive;      //!< adds the animation's offset from the rest pose to the blend
+    };
+
+    /**
+     * Blends several animations and applies the result to the TransformManager, setting the
+     * transform of each targeted entity only once.
+     *
+     * The regular animations are blended according to their weights; when the weights of a
+     * component add up to less than 1, the remainder is taken from the rest pose defined in the
+     * glTF file. The additive animations are then applied on top of the result, scaled by their
+     * weight, as an offset from the rest pose.
+     */
+    void applyBlendedAnimations(const BlendedAnimation* animations, size_t count) const;
+
+    /**
+     * Cross-fades between two animations, alpha goes from 0 (previous animation only) to 1
+     * (new animation only).
+     */
+    void applyCrossFade(size_t previousAnimIndex, float previousAnimTime,
+            size_t animationIndex, float animationTime, float alpha) const;
+
     /**
      * Uses TransformManager to compute root-to-node transforms for all bone nodes, then passes
      * the results into RenderableManager::setBones.
      *
      * Note that this operation is actually independent of animation, but the Animator seems
      * like a reasonable place for a utility like this.
+     *
+     * When the asset has several skins, they are processed in parallel on the Engine's
+     * JobSystem, so this must be called from the thread that created the Engine.
      */
     void updateBoneMatrices();
 
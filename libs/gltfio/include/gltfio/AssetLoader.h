@@ -120,6 +120,16 @@ public:
      */
     FilamentAsset* createAssetFromBinary(const uint8_t* bytes, uint32_t nbytes);
 
+    /**
+     * Loads a JSON-based or GLB glTF 2.0 file and returns a bundle of Filament objects. Returns
+     * null on failure.
+     *
+     * Where supported, the file is memory-mapped rather than copied: the buffers of a GLB file
+     * are then uploaded straight from the mapping, which is released with the source data once
+     * the uploads complete.
+     */
+    FilamentAsset* createAssetFromFile(const char* path);
+
     /** Destroys the given asset and all of its associated Filament objects. */
     void destroyAsset(const FilamentAsset* asset);
 
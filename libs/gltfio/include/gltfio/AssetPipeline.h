@@ -97,6 +97,16 @@ public:
      */
     AssetHandle parameterize(AssetHandle source);
 
+    /**
+     * Reorders the triangles and vertices of a flattened asset to make rendering more efficient.
+     *
+     * The triangles are reordered to make good use of the post-transform vertex cache, then to
+     * reduce overdraw, and the vertices are reordered in the order they're fetched. Vertices that
+     * are not referenced by any triangle are removed and all attributes are converted to fp32.
+     * This is best done after parameterization, which modifies the topology.
+     */
+    AssetHandle optimize(AssetHandle source);
+
     /**
      * Strips all textures and materials from a flattened asset, replacing them with a nonlit
      * material that samples from the texture at the given path.
@@ -48,9 +48,12 @@ class Animator;
  * Clients must use ResourceLoader to create Texture objects, compute tangent quaternions, and
  * upload data into vertex buffers and index buffers.
  *
- * TODO: This supports skinning but not morphing.
+ * Quantized vertex data (KHR_mesh_quantization) is uploaded as is, and buffer views compressed
+ * with EXT_meshopt_compression are decoded by ResourceLoader before being uploaded.
+ *
+ * TODO: Morph targets are only applied to positions.
  * TODO: Only the default glTF scene is loaded, other glTF scenes are ignored.
- * TODO: Cameras, extras, and extensions are ignored.
+ * TODO: Cameras, extras, and other extensions are ignored.
  */
 class FilamentAsset {
 public:
@@ -53,7 +53,22 @@ struct ResourceConfiguration {
  * The resource loader must be destroyed on the same thread that calls Renderer::render because it
  * listens to BufferDescriptor callbacks in order to determine when to free CPU-side data blobs.
  *
- * TODO: the GPU upload is asynchronous but the load-from-disk and image decode is not.
+ * Images are decoded in parallel on the Engine's JobSystem, so loadResources() and the async
+ * methods must be called from the thread that created the Engine.
+ *
+ * loadResources() blocks until all the resources are loaded. Alternatively, asyncBeginLoad()
+ * makes the geometry renderable right away and decodes the images in the background, their
+ * textures are then created by calling asyncUpdateLoad() once per frame, e.g.:
+ *
+ * ~~~~~~~~~~~{.cpp}
+ * resourceLoader->asyncBeginLoad(asset);
+ * ...
+ * // in the render loop
+ * resourceLoader->asyncUpdateLoad();
+ * float progress = resourceLoader->asyncGetLoadProgress();
+ * ~~~~~~~~~~~
+ *
+ * TODO: the buffers are still read from disk synchronously.
  */
 class ResourceLoader {
 public:
@@ -72,6 +87,38 @@ public:
      */
     bool loadResources(FilamentAsset* asset);
 
+    /**
+     * Starts an asynchronous resource load.
+     *
+     * The buffers are loaded and uploaded like with loadResources(), so the asset can be
+     * rendered as soon as this returns. The images are decoded in the background and their
+     * textures are created by asyncUpdateLoad().
+     *
+     * Returns false if the load could not start, e.g. if another asynchronous load is still in
+     * progress with this ResourceLoader, or if resources have already been loaded.
+     */
+    bool asyncBeginLoad(FilamentAsset* asset);
+
+    /**
+     * Cancels the asynchronous load, waiting for the images being decoded and the pending buffer
+     * uploads. This must be called before destroying the asset being loaded, other assets loaded
+     * by this ResourceLoader must outlive it.
+     */
+    void asyncCancelLoad();
+
+    /**
+     * Returns the progress of the asynchronous load, between 0 and 1. This is 1 once all the
+     * textures are created, or if there is no load in progress.
+     */
+    float asyncGetLoadProgress() const;
+
+    /**
+     * Creates the textures whose images are decoded and sets them on the asset's material
+     * instances. This should be called regularly, e.g. once per frame, until
+     * asyncGetLoadProgress() returns 1.
+     */
+    void asyncUpdateLoad();
+
     /**
      * Adds raw resource data into a cache for platforms that do not have filesystem or network
      * access.
@@ -79,8 +126,12 @@ public:
     void addResourceData(std::string url, BufferDescriptor&& buffer);
 
 private:
-    bool createTextures(details::FFilamentAsset* asset) const;
+    bool beginLoad(details::FFilamentAsset* asset);
+    bool decodeTextures(details::FFilamentAsset* asset);
+    bool createTextures(bool async);
+    bool decodeMeshoptBuffers(details::FFilamentAsset* asset) const;
     void computeTangents(details::FFilamentAsset* asset) const;
+    void importMorphTargets(details::FFilamentAsset* asset) const;
     void normalizeSkinningWeights(details::FFilamentAsset* asset) const;
     void updateBoundingBoxes(details::FFilamentAsset* asset) const;
     details::AssetPool* mPool;
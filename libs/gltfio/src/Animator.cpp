@@ -23,6 +23,7 @@
 #include <filament/RenderableManager.h>
 #include <filament/TransformManager.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Log.h>
 
 #include <math/mat4.h>
@@ -31,8 +32,9 @@
 #include <math/vec3.h>
 #include <math/vec4.h>
 
-#include <map>
+#include <algorithm>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 using namespace filament;
@@ -44,19 +46,20 @@ namespace gltfio {
 
 using namespace details;
 
-using TimeValues = std::map<float, size_t>;
-using SourceValues = std::vector<float>;
-
+// Keyframes are stored as flat arrays: times holds one entry per keyframe, and values holds the
+// corresponding vec3, quat or morph weight components (three of them per keyframe for cubic
+// splines).
 struct Sampler {
-    TimeValues times;
-    SourceValues values;
+    vector<float> times;
+    vector<float> values;
     enum { LINEAR, STEP, CUBIC } interpolation;
 };
 
 struct Channel {
     const Sampler* sourceData;
-    utils::Entity targetEntity;
-    enum { TRANSLATION, ROTATION, SCALE } transformType;
+    size_t node;            // index into AnimatorImpl::nodes, or into FFilamentAsset::mMorphs
+    size_t cursor;          // index of the last keyframe found, sampling usually starts from here
+    enum { TRANSLATION, ROTATION, SCALE, WEIGHTS } transformType;
 };
 
 struct Animation {
@@ -64,29 +67,74 @@ struct Animation {
     std::string name;
     vector<Sampler> samplers;
     vector<Channel> channels;
+    vector<size_t> nodes;   // nodes targeted by at least one channel
+    vector<size_t> morphs;  // morphed renderables targeted by at least one channel
+};
+
+// Animated nodes keep their transform as TRS, so that applying a channel doesn't need to
+// decompose and recompose the matrix stored in the TransformManager.
+struct NodeTransform {
+    utils::Entity entity;
+    float3 translation;
+    quatf rotation;
+    float3 scale;
+};
+
+// Offsets of a skin's matrices in AnimatorImpl::jointMatrices and AnimatorImpl::boneMatrices.
+struct SkinRange {
+    size_t joints;
+    size_t bones;
+};
+
+// Accumulates the weighted components of a node's transform while blending animations.
+struct BlendedTransform {
+    float3 translation;
+    quatf rotation;
+    float3 scale;
+    float3 weights;         // sum of the translation, rotation and scale weights
+    bool pending;
 };
 
 struct AnimatorImpl {
     vector<Animation> animations;
-    vector<mat4f> boneMatrices;
+    vector<NodeTransform> nodes;
+    vector<NodeTransform> restPose;         // nodes as defined in the glTF file
+    vector<NodeTransform> sampledPose;      // scratch pose used when blending animations
+    vector<BlendedTransform> blendedPose;
+    vector<size_t> blendedNodes;
+    vector<size_t> morphOffsets;        // offset of each morph's weights in the arrays below
+    vector<float> weights;              // morph weights, for all morphed renderables
+    vector<float> restWeights;          // default morph weights
+    vector<float> uploadedWeights;      // morph weights of the positions last uploaded
+    vector<float> sampledWeights;       // scratch weights used when blending animations
+    vector<float> blendedWeights;
+    vector<float> blendedWeightSums;
+    vector<size_t> blendedMorphs;
+    vector<bool> pendingMorphs;
+    vector<SkinRange> skinRanges;
+    vector<mat4f> jointMatrices;    // joint world transform * inverse bind matrix, for all skins
+    vector<mat4f> boneMatrices;     // joint count matrices per skinned target, for all skins
     FFilamentAsset* asset;
     RenderableManager* renderableManager;
     TransformManager* transformManager;
 };
 
 static void createSampler(const cgltf_animation_sampler& src, Sampler& dst) {
-    // Copy the time values into a red-black tree.
+    // Copy the time values into a flat array, glTF requires them to be strictly increasing.
     const cgltf_accessor* timelineAccessor = src.input;
-    const uint8_t* timelineBlob = (const uint8_t*) timelineAccessor->buffer_view->buffer->data;
-    const float* timelineFloats = (const float*) (timelineBlob + timelineAccessor->offset +
-            timelineAccessor->buffer_view->offset);
-    for (size_t i = 0, len = timelineAccessor->count; i < len; ++i) {
-        dst.times[timelineFloats[i]] = i;
-    }
+    const uint8_t* timelineBlob = cgltf_buffer_view_data(timelineAccessor->buffer_view);
+    const float* timelineFloats = (const float*) (timelineBlob + timelineAccessor->offset);
+    dst.times.assign(timelineFloats, timelineFloats + timelineAccessor->count);
 
     // Convert source data to float.
     const cgltf_accessor* valuesAccessor = src.output;
     switch (valuesAccessor->type) {
+        case cgltf_type_scalar:
+            dst.values.resize(valuesAccessor->count);
+            for (cgltf_size i = 0; i < valuesAccessor->count; ++i) {
+                cgltf_accessor_read_float(src.output, i, &dst.values[i], 1);
+            }
+            break;
         case cgltf_type_vec3:
             dst.values.resize(valuesAccessor->count * 3);
             for (cgltf_size i = 0; i < valuesAccessor->count; ++i) {
@@ -117,22 +165,66 @@ static void createSampler(const cgltf_animation_sampler& src, Sampler& dst) {
     }
 }
 
-static void setTransformType(const cgltf_animation_channel& src, Channel& dst) {
+// Returns true if the sampler holds one value of the given number of floats per keyframe, or
+// three of them (in-tangent, value, out-tangent) for cubic splines.
+static bool hasValueCount(const Sampler& sampler, size_t floatsPerValue) {
+    const size_t valuesPerKeyframe = sampler.interpolation == Sampler::CUBIC ? 3 : 1;
+    return sampler.values.size() == sampler.times.size() * valuesPerKeyframe * floatsPerValue;
+}
+
+static bool setTransformType(const cgltf_animation_channel& src, Channel& dst) {
     switch (src.target_path) {
         case cgltf_animation_path_type_translation:
             dst.transformType = Channel::TRANSLATION;
-            break;
+            return true;
         case cgltf_animation_path_type_rotation:
             dst.transformType = Channel::ROTATION;
-            break;
+            return true;
         case cgltf_animation_path_type_scale:
             dst.transformType = Channel::SCALE;
-            break;
-        case cgltf_animation_path_type_invalid:
+            return true;
         case cgltf_animation_path_type_weights:
+            dst.transformType = Channel::WEIGHTS;
+            return true;
+        case cgltf_animation_path_type_invalid:
             slog.e << "Unsupported channel path." << io::endl;
-            break;
+            return false;
+    }
+    return false;
+}
+
+static void createNodeTransform(const cgltf_node& src, utils::Entity entity, NodeTransform& dst) {
+    dst.entity = entity;
+    if (src.has_matrix) {
+        decomposeMatrix(mat4f(src.matrix[0], src.matrix[1], src.matrix[2], src.matrix[3],
+                src.matrix[4], src.matrix[5], src.matrix[6], src.matrix[7],
+                src.matrix[8], src.matrix[9], src.matrix[10], src.matrix[11],
+                src.matrix[12], src.matrix[13], src.matrix[14], src.matrix[15]),
+                &dst.translation, &dst.rotation, &dst.scale);
+        return;
     }
+    // cgltf initializes these to the identity when they are absent.
+    dst.translation = float3(src.translation[0], src.translation[1], src.translation[2]);
+    dst.rotation = quatf(src.rotation[3], src.rotation[0], src.rotation[1], src.rotation[2]);
+    dst.scale = float3(src.scale[0], src.scale[1], src.scale[2]);
+}
+
+// Returns the index of the first keyframe at or after the given time, or the number of keyframes
+// if there is none. Playback usually moves forward by a small amount of time, so the search
+// starts from the keyframe found previously and only falls back to a binary search when the
+// time went backwards, e.g. when the animation loops.
+static size_t findKeyframe(const vector<float>& times, size_t& cursor, float time) {
+    size_t index = cursor;
+    const size_t count = times.size();
+    if (index > count || (index > 0 && times[index - 1] >= time)) {
+        index = std::lower_bound(times.begin(), times.end(), time) - times.begin();
+    } else {
+        while (index < count && times[index] < time) {
+            ++index;
+        }
+    }
+    cursor = index;
+    return index;
 }
 
 Animator::Animator(FilamentAsset* publicAsset) {
@@ -141,6 +233,22 @@ Animator::Animator(FilamentAsset* publicAsset) {
     mImpl->renderableManager = &asset->mEngine->getRenderableManager();
     mImpl->transformManager = &asset->mEngine->getTransformManager();
 
+    // Each animated node gets a single TRS entry, shared by all the animations that target it.
+    std::unordered_map<const cgltf_node*, size_t> nodeIndices;
+
+    // The weights of all the morphed renderables are stored in flat arrays.
+    std::unordered_map<uint32_t, size_t> morphIndices;
+    const vector<Morph>& morphs = asset->mMorphs;
+    for (size_t i = 0, n = morphs.size(); i < n; ++i) {
+        morphIndices[morphs[i].entity.getId()] = i;
+        mImpl->morphOffsets.push_back(mImpl->restWeights.size());
+        mImpl->restWeights.insert(mImpl->restWeights.end(),
+                morphs[i].weights.begin(), morphs[i].weights.end());
+    }
+    mImpl->morphOffsets.push_back(mImpl->restWeights.size());
+    mImpl->weights = mImpl->restWeights;
+    mImpl->uploadedWeights = mImpl->restWeights;
+
     // Loop over the glTF animation definitions.
     const cgltf_data* srcAsset = asset->mSourceAsset;
     const cgltf_animation* srcAnims = srcAsset->animations;
@@ -161,23 +269,66 @@ Animator::Animator(FilamentAsset* publicAsset) {
             Sampler& dstSampler = dstAnim.samplers[j];
             createSampler(srcSampler, dstSampler);
             if (dstSampler.times.size() > 1) {
-                float maxtime = (--dstSampler.times.end())->first;
+                float maxtime = dstSampler.times.back();
                 dstAnim.duration = std::max(dstAnim.duration, maxtime);
             }
         }
 
         // Import each glTF channel into a custom data structure.
         cgltf_animation_channel* srcChannels = srcAnim.channels;
-        dstAnim.channels.resize(srcAnim.channels_count);
+        dstAnim.channels.reserve(srcAnim.channels_count);
         for (cgltf_size j = 0, nchans = srcAnim.channels_count; j < nchans; ++j) {
             const cgltf_animation_channel& srcChannel = srcChannels[j];
-            utils::Entity targetEntity = asset->mNodeMap[srcChannel.target_node];
-            Channel& dstChannel = dstAnim.channels[j];
-            dstChannel.sourceData = &dstAnim.samplers[srcChannel.sampler - srcSamplers];
-            dstChannel.targetEntity = targetEntity;
-            setTransformType(srcChannel, dstChannel);
+            Channel dstChannel;
+            if (!setTransformType(srcChannel, dstChannel)) {
+                continue;
+            }
+            const Sampler* sampler = &dstAnim.samplers[srcChannel.sampler - srcSamplers];
+            if (sampler->times.size() < 2) {
+                continue;
+            }
+            const cgltf_node* srcNode = srcChannel.target_node;
+            if (dstChannel.transformType == Channel::WEIGHTS) {
+                auto iter = morphIndices.find(asset->mNodeMap[srcNode].getId());
+                if (iter == morphIndices.end()) {
+                    continue;
+                }
+                const size_t morph = iter->second;
+                if (!hasValueCount(*sampler, morphs[morph].weights.size())) {
+                    slog.e << "Bad morph weights count in animation sampler." << io::endl;
+                    continue;
+                }
+                dstChannel.sourceData = sampler;
+                dstChannel.node = morph;
+                dstChannel.cursor = 0;
+                dstAnim.channels.push_back(dstChannel);
+                if (std::find(dstAnim.morphs.begin(), dstAnim.morphs.end(), dstChannel.node) ==
+                        dstAnim.morphs.end()) {
+                    dstAnim.morphs.push_back(dstChannel.node);
+                }
+                continue;
+            }
+            if (!hasValueCount(*sampler, dstChannel.transformType == Channel::ROTATION ? 4 : 3)) {
+                slog.e << "Bad value count in animation sampler." << io::endl;
+                continue;
+            }
+            auto iter = nodeIndices.find(srcNode);
+            if (iter == nodeIndices.end()) {
+                iter = nodeIndices.emplace(srcNode, mImpl->nodes.size()).first;
+                mImpl->nodes.emplace_back();
+                createNodeTransform(*srcNode, asset->mNodeMap[srcNode], mImpl->nodes.back());
+            }
+            dstChannel.sourceData = sampler;
+            dstChannel.node = iter->second;
+            dstChannel.cursor = 0;
+            dstAnim.channels.push_back(dstChannel);
+            if (std::find(dstAnim.nodes.begin(), dstAnim.nodes.end(), dstChannel.node) ==
+                    dstAnim.nodes.end()) {
+                dstAnim.nodes.push_back(dstChannel.node);
+            }
         }
     }
+    mImpl->restPose = mImpl->nodes;
 }
 
 Animator::~Animator() {
@@ -188,60 +339,68 @@ size_t Animator::getAnimationCount() const {
     return mImpl->animations.size();
 }
 
-void Animator::applyAnimation(size_t animationIndex, float time) const {
-    const Animation& anim = mImpl->animations[animationIndex];
-    TransformManager* transformManager = mImpl->transformManager;
+// Samples all the channels of an animation into the given pose, which holds one transform per
+// animated node and the weights of all the morphed renderables. Only the components targeted by
+// the channels are written.
+static void sampleAnimation(Animation& anim, float time, NodeTransform* UTILS_RESTRICT nodes,
+        float* UTILS_RESTRICT weights, const size_t* morphOffsets) {
     time = fmod(time, anim.duration);
-    for (const auto& channel : anim.channels) {
+    for (auto& channel : anim.channels) {
         const Sampler* sampler = channel.sourceData;
-        if (sampler->times.size() < 2) {
-            continue;
-        }
-
-        TransformManager::Instance node = transformManager->getInstance(channel.targetEntity);
-        const TimeValues& times = sampler->times;
+        const vector<float>& times = sampler->times;
 
         // Find the first keyframe after the given time, or the keyframe that matches it exactly.
-        TimeValues::const_iterator iter = times.lower_bound(time);
+        const size_t index = findKeyframe(times, channel.cursor, time);
 
         // Find the two values that we will interpolate between.
-        TimeValues::const_iterator prevIter;
-        TimeValues::const_iterator nextIter;
-        if (iter == times.end()) {
-            prevIter = --times.end();
-            nextIter = times.begin();
-        } else if (iter == times.begin()) {
-            prevIter = nextIter = iter;
+        size_t prevIndex;
+        size_t nextIndex;
+        if (index == times.size()) {
+            prevIndex = times.size() - 1;
+            nextIndex = 0;
+        } else if (index == 0) {
+            prevIndex = nextIndex = 0;
         } else {
-            nextIter = iter;
-            prevIter = --iter;
+            nextIndex = index;
+            prevIndex = index - 1;
         }
 
         // Compute the interpolant between 0 and 1.
-        float prevTime = prevIter->first;
-        float nextTime = nextIter->first;
+        float prevTime = times[prevIndex];
+        float nextTime = times[nextIndex];
         float interval = nextTime - prevTime;
         if (interval < 0) {
             interval += anim.duration;
         }
         float t = interval == 0 ? 0.0f : ((time - prevTime) / interval);
 
-        // Perform the interpolation. This is a simple but inefficient implementation; Filament
-        // stores transforms as mat4's but glTF animation is based on TRS (translation rotation
-        // scale).
-        size_t prevIndex = prevIter->second;
-        size_t nextIndex = nextIter->second;
-
-        mat4f xform = transformManager->getTransform(node);
-        float3 scale;
-        quatf rotation;
-        float3 translation;
-        decomposeMatrix(xform, &translation, &rotation, &scale);
-
         if (sampler->interpolation == Sampler::STEP) {
             t = 0.0f;
         }
 
+        if (channel.transformType == Channel::WEIGHTS) {
+            const size_t offset = morphOffsets[channel.node];
+            const size_t count = morphOffsets[channel.node + 1] - offset;
+            const float* srcWeights = sampler->values.data();
+            float* dstWeights = weights + offset;
+            if (sampler->interpolation == Sampler::CUBIC) {
+                for (size_t i = 0; i < count; ++i) {
+                    float vert0 = srcWeights[(prevIndex * 3 + 1) * count + i];
+                    float tang0 = srcWeights[(prevIndex * 3 + 2) * count + i];
+                    float tang1 = srcWeights[(nextIndex * 3) * count + i];
+                    float vert1 = srcWeights[(nextIndex * 3 + 1) * count + i];
+                    dstWeights[i] = cubicSpline(vert0, tang0, vert1, tang1, t);
+                }
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    dstWeights[i] = (1 - t) * srcWeights[prevIndex * count + i] +
+                            t * srcWeights[nextIndex * count + i];
+                }
+            }
+            continue;
+        }
+
+        NodeTransform& node = nodes[channel.node];
         switch (channel.transformType) {
             case Channel::SCALE: {
                 const float3* srcVec3 = (const float3*) sampler->values.data();
@@ -250,9 +409,9 @@ void Animator::applyAnimation(size_t animationIndex, float time) const {
                     float3 tang0 = srcVec3[prevIndex * 3 + 2];
                     float3 tang1 = srcVec3[nextIndex * 3];
                     float3 vert1 = srcVec3[nextIndex * 3 + 1];
-                    scale = cubicSpline(vert0, tang0, vert1, tang1, t);
+                    node.scale = cubicSpline(vert0, tang0, vert1, tang1, t);
                 } else {
-                    scale = ((1 - t) * srcVec3[prevIndex]) + (t * srcVec3[nextIndex]);
+                    node.scale = ((1 - t) * srcVec3[prevIndex]) + (t * srcVec3[nextIndex]);
                 }
                 break;
             }
@@ -263,9 +422,9 @@ void Animator::applyAnimation(size_t animationIndex, float time) const {
                     float3 tang0 = srcVec3[prevIndex * 3 + 2];
                     float3 tang1 = srcVec3[nextIndex * 3];
                     float3 vert1 = srcVec3[nextIndex * 3 + 1];
-                    translation = cubicSpline(vert0, tang0, vert1, tang1, t);
+                    node.translation = cubicSpline(vert0, tang0, vert1, tang1, t);
                 } else {
-                    translation = ((1 - t) * srcVec3[prevIndex]) + (t * srcVec3[nextIndex]);
+                    node.translation = ((1 - t) * srcVec3[prevIndex]) + (t * srcVec3[nextIndex]);
                 }
                 break;
             }
@@ -276,47 +435,317 @@ void Animator::applyAnimation(size_t animationIndex, float time) const {
                     quatf tang0 = srcQuat[prevIndex * 3 + 2];
                     quatf tang1 = srcQuat[nextIndex * 3];
                     quatf vert1 = srcQuat[nextIndex * 3 + 1];
-                    rotation = normalize(cubicSpline(vert0, tang0, vert1, tang1, t));
+                    node.rotation = normalize(cubicSpline(vert0, tang0, vert1, tang1, t));
                 } else {
-                    rotation = slerp(srcQuat[prevIndex], srcQuat[nextIndex], t);
+                    node.rotation = slerp(srcQuat[prevIndex], srcQuat[nextIndex], t);
                 }
                 break;
             }
+            case Channel::WEIGHTS:
+                break;
         }
+    }
+
+}
 
-        xform = composeMatrix(translation, rotation, scale);
-        transformManager->setTransform(node, xform);
+static void setTransform(TransformManager* transformManager, const NodeTransform& node) {
+    TransformManager::Instance instance = transformManager->getInstance(node.entity);
+    transformManager->setTransform(instance,
+            composeMatrix(node.translation, node.rotation, node.scale));
+}
+
+// Blends and uploads the positions of a morphed renderable, unless its weights didn't change.
+static void updateMorph(AnimatorImpl* impl, size_t morphIndex) {
+    const size_t offset = impl->morphOffsets[morphIndex];
+    const size_t count = impl->morphOffsets[morphIndex + 1] - offset;
+    const float* weights = impl->weights.data() + offset;
+    float* uploadedWeights = impl->uploadedWeights.data() + offset;
+    if (std::equal(weights, weights + count, uploadedWeights)) {
+        return;
     }
+    std::copy_n(weights, count, uploadedWeights);
+    FFilamentAsset* asset = impl->asset;
+    uploadMorphedPositions(*asset->mEngine, asset->mMorphs[morphIndex], weights);
 }
 
-void Animator::updateBoneMatrices() {
-    vector<mat4f>& boneMatrices = mImpl->boneMatrices;
-    FFilamentAsset* asset = mImpl->asset;
-    auto renderableManager = mImpl->renderableManager;
-    auto transformManager = mImpl->transformManager;
-    for (const auto& skin : asset->mSkins) {
-        size_t njoints = skin.joints.size();
-        boneMatrices.resize(njoints);
-        for (const auto& entity : skin.targets) {
-            auto renderable = renderableManager->getInstance(entity);
-            if (!renderable) {
+void Animator::applyAnimation(size_t animationIndex, float time) const {
+    Animation& anim = mImpl->animations[animationIndex];
+    sampleAnimation(anim, time, mImpl->nodes.data(), mImpl->weights.data(),
+            mImpl->morphOffsets.data());
+
+    // Compose and set the transform of each node only once, even if several channels target it.
+    for (size_t nodeIndex : anim.nodes) {
+        setTransform(mImpl->transformManager, mImpl->nodes[nodeIndex]);
+    }
+    for (size_t morphIndex : anim.morphs) {
+        updateMorph(mImpl, morphIndex);
+    }
+}
+
+void Animator::applyBlendedAnimations(const BlendedAnimation* animations, size_t count) const {
+    vector<NodeTransform>& nodes = mImpl->nodes;
+    vector<NodeTransform>& sampledPose = mImpl->sampledPose;
+    vector<BlendedTransform>& blendedPose = mImpl->blendedPose;
+    vector<size_t>& blendedNodes = mImpl->blendedNodes;
+    vector<size_t>& blendedMorphs = mImpl->blendedMorphs;
+    vector<float>& sampledWeights = mImpl->sampledWeights;
+    vector<float>& blendedWeights = mImpl->blendedWeights;
+    vector<float>& blendedWeightSums = mImpl->blendedWeightSums;
+    const vector<float>& restWeights = mImpl->restWeights;
+    const size_t* morphOffsets = mImpl->morphOffsets.data();
+    sampledPose.resize(nodes.size());
+    blendedPose.resize(nodes.size());
+    sampledWeights.resize(restWeights.size());
+    blendedWeights.resize(restWeights.size());
+    blendedWeightSums.resize(restWeights.size());
+    mImpl->pendingMorphs.resize(mImpl->morphOffsets.size() - 1);
+
+    // Clear the accumulators of the nodes and morphs targeted by at least one of the animations.
+    blendedNodes.clear();
+    blendedMorphs.clear();
+    for (size_t i = 0; i < count; ++i) {
+        const Animation& anim = mImpl->animations[animations[i].animationIndex];
+        for (size_t nodeIndex : anim.nodes) {
+            BlendedTransform& blended = blendedPose[nodeIndex];
+            if (!blended.pending) {
+                blended = {};
+                blended.pending = true;
+                blendedNodes.push_back(nodeIndex);
+            }
+        }
+        for (size_t morphIndex : anim.morphs) {
+            if (!mImpl->pendingMorphs[morphIndex]) {
+                mImpl->pendingMorphs[morphIndex] = true;
+                blendedMorphs.push_back(morphIndex);
+                const size_t begin = morphOffsets[morphIndex];
+                const size_t end = morphOffsets[morphIndex + 1];
+                std::fill(blendedWeights.begin() + begin, blendedWeights.begin() + end, 0.0f);
+                std::fill(blendedWeightSums.begin() + begin, blendedWeightSums.begin() + end, 0.0f);
+            }
+        }
+    }
+
+    // Accumulate the weighted components of the regular animations.
+    for (size_t i = 0; i < count; ++i) {
+        const BlendedAnimation& layer = animations[i];
+        const float weight = layer.weight;
+        if (layer.additive || weight <= 0) {
+            continue;
+        }
+        Animation& anim = mImpl->animations[layer.animationIndex];
+        sampleAnimation(anim, layer.time, sampledPose.data(), sampledWeights.data(),
+                morphOffsets);
+        for (const Channel& channel : anim.channels) {
+            if (channel.transformType == Channel::WEIGHTS) {
+                for (size_t w = morphOffsets[channel.node], e = morphOffsets[channel.node + 1];
+                        w < e; ++w) {
+                    blendedWeights[w] += weight * sampledWeights[w];
+                    blendedWeightSums[w] += weight;
+                }
+                continue;
+            }
+            const NodeTransform& sampled = sampledPose[channel.node];
+            BlendedTransform& blended = blendedPose[channel.node];
+            switch (channel.transformType) {
+                case Channel::TRANSLATION:
+                    blended.translation += weight * sampled.translation;
+                    blended.weights.x += weight;
+                    break;
+                case Channel::ROTATION: {
+                    // q and -q are the same rotation, pick the one closest to the others.
+                    const quatf q = dot(blended.rotation, sampled.rotation) < 0 ?
+                            -sampled.rotation : sampled.rotation;
+                    blended.rotation += weight * q;
+                    blended.weights.y += weight;
+                    break;
+                }
+                case Channel::SCALE:
+                    blended.scale += weight * sampled.scale;
+                    blended.weights.z += weight;
+                    break;
+                case Channel::WEIGHTS:
+                    break;
+            }
+        }
+    }
+
+    // Normalize the weights. When they add up to less than one, the remainder is taken from the
+    // rest pose, so that e.g. an animation can be faded in.
+    for (size_t nodeIndex : blendedNodes) {
+        BlendedTransform& blended = blendedPose[nodeIndex];
+        const NodeTransform& rest = mImpl->restPose[nodeIndex];
+        const float3 w = blended.weights;
+        blended.translation = w.x >= 1 ? blended.translation / w.x :
+                blended.translation + (1 - w.x) * rest.translation;
+        blended.scale = w.z >= 1 ? blended.scale / w.z :
+                blended.scale + (1 - w.z) * rest.scale;
+        if (w.y < 1) {
+            const quatf q = dot(blended.rotation, rest.rotation) < 0 ?
+                    -rest.rotation : rest.rotation;
+            blended.rotation += (1 - w.y) * q;
+        }
+        blended.rotation = normalize(blended.rotation);
+    }
+    for (size_t morphIndex : blendedMorphs) {
+        for (size_t w = morphOffsets[morphIndex], e = morphOffsets[morphIndex + 1]; w < e; ++w) {
+            const float sum = blendedWeightSums[w];
+            blendedWeights[w] = sum >= 1 ? blendedWeights[w] / sum :
+                    blendedWeights[w] + (1 - sum) * restWeights[w];
+        }
+    }
+
+    // Apply the additive animations on top, relative to the rest pose.
+    for (size_t i = 0; i < count; ++i) {
+        const BlendedAnimation& layer = animations[i];
+        const float weight = layer.weight;
+        if (!layer.additive || weight == 0) {
+            continue;
+        }
+        Animation& anim = mImpl->animations[layer.animationIndex];
+        sampleAnimation(anim, layer.time, sampledPose.data(), sampledWeights.data(),
+                morphOffsets);
+        for (const Channel& channel : anim.channels) {
+            if (channel.transformType == Channel::WEIGHTS) {
+                for (size_t w = morphOffsets[channel.node], e = morphOffsets[channel.node + 1];
+                        w < e; ++w) {
+                    blendedWeights[w] += weight * (sampledWeights[w] - restWeights[w]);
+                }
                 continue;
             }
-            mat4f inverseGlobalTransform;
-            auto xformable = transformManager->getInstance(entity);
-            if (xformable) {
-                inverseGlobalTransform = inverse(transformManager->getWorldTransform(xformable));
+            const NodeTransform& sampled = sampledPose[channel.node];
+            const NodeTransform& rest = mImpl->restPose[channel.node];
+            BlendedTransform& blended = blendedPose[channel.node];
+            switch (channel.transformType) {
+                case Channel::TRANSLATION:
+                    blended.translation += weight * (sampled.translation - rest.translation);
+                    break;
+                case Channel::ROTATION: {
+                    const quatf delta = sampled.rotation * inverse(rest.rotation);
+                    blended.rotation = normalize(slerp(quatf(1), delta, weight) *
+                            blended.rotation);
+                    break;
+                }
+                case Channel::SCALE:
+                    blended.scale += weight * (sampled.scale - rest.scale);
+                    break;
+                case Channel::WEIGHTS:
+                    break;
             }
+        }
+    }
+
+    // Finally, set the transform of each node and the positions of each morph once.
+    for (size_t nodeIndex : blendedNodes) {
+        BlendedTransform& blended = blendedPose[nodeIndex];
+        NodeTransform& node = nodes[nodeIndex];
+        node.translation = blended.translation;
+        node.rotation = blended.rotation;
+        node.scale = blended.scale;
+        blended.pending = false;
+        setTransform(mImpl->transformManager, node);
+    }
+    for (size_t morphIndex : blendedMorphs) {
+        const size_t begin = morphOffsets[morphIndex];
+        const size_t end = morphOffsets[morphIndex + 1];
+        std::copy(blendedWeights.begin() + begin, blendedWeights.begin() + end,
+                mImpl->weights.begin() + begin);
+        mImpl->pendingMorphs[morphIndex] = false;
+        updateMorph(mImpl, morphIndex);
+    }
+}
+
+void Animator::applyCrossFade(size_t previousAnimIndex, float previousAnimTime,
+        size_t animationIndex, float animationTime, float alpha) const {
+    const BlendedAnimation animations[2] = {
+        { previousAnimIndex, previousAnimTime, 1.0f - alpha, false },
+        { animationIndex, animationTime, alpha, false }
+    };
+    applyBlendedAnimations(animations, 2);
+}
+
+// Computes the bone matrices of all the targets of a skin. This only reads from the
+// TransformManager and writes to the skin's own range of the matrix arrays, so skins can be
+// processed concurrently.
+static void computeBoneMatrices(AnimatorImpl* impl, size_t skinIndex) {
+    const Skin& skin = impl->asset->mSkins[skinIndex];
+    const SkinRange& range = impl->skinRanges[skinIndex];
+    const TransformManager& transformManager = *impl->transformManager;
+    const size_t njoints = skin.joints.size();
+
+    // The joint transforms don't depend on the target, compute them once for all of them.
+    mat4f* UTILS_RESTRICT jointMatrices = impl->jointMatrices.data() + range.joints;
+    for (size_t boneIndex = 0; boneIndex < njoints; ++boneIndex) {
+        const auto& joint = skin.joints[boneIndex];
+        TransformManager::Instance jointInstance = transformManager.getInstance(joint);
+        jointMatrices[boneIndex] = transformManager.getWorldTransform(jointInstance) *
+                skin.inverseBindMatrices[boneIndex];
+    }
+
+    mat4f* UTILS_RESTRICT boneMatrices = impl->boneMatrices.data() + range.bones;
+    for (const auto& entity : skin.targets) {
+        auto xformable = transformManager.getInstance(entity);
+        if (xformable) {
+            const mat4f inverseGlobalTransform =
+                    inverse(transformManager.getWorldTransform(xformable));
             for (size_t boneIndex = 0; boneIndex < njoints; ++boneIndex) {
-                const auto& joint = skin.joints[boneIndex];
-                TransformManager::Instance jointInstance = transformManager->getInstance(joint);
-                mat4f globalJointTransform = transformManager->getWorldTransform(jointInstance);
-                boneMatrices[boneIndex] =
-                        inverseGlobalTransform *
-                        globalJointTransform *
-                        skin.inverseBindMatrices[boneIndex];
+                boneMatrices[boneIndex] = inverseGlobalTransform * jointMatrices[boneIndex];
+            }
+        } else {
+            std::copy_n(jointMatrices, njoints, boneMatrices);
+        }
+        boneMatrices += njoints;
+    }
+}
+
+void Animator::updateBoneMatrices() {
+    FFilamentAsset* asset = mImpl->asset;
+    const vector<Skin>& skins = asset->mSkins;
+    if (skins.empty()) {
+        return;
+    }
+
+    // The matrices of all the skins are stored in the same arrays, which are only reallocated
+    // the first time through.
+    vector<SkinRange>& skinRanges = mImpl->skinRanges;
+    skinRanges.resize(skins.size());
+    size_t jointCount = 0;
+    size_t boneCount = 0;
+    for (size_t i = 0, n = skins.size(); i < n; ++i) {
+        skinRanges[i] = { jointCount, boneCount };
+        jointCount += skins[i].joints.size();
+        boneCount += skins[i].joints.size() * skins[i].targets.size();
+    }
+    mImpl->jointMatrices.resize(jointCount);
+    mImpl->boneMatrices.resize(boneCount);
+
+    // The skins are independent of each other, so they're spread over all cores.
+    AnimatorImpl* impl = mImpl;
+    auto work = [impl](uint32_t first, uint32_t count) {
+        for (uint32_t i = first, e = first + count; i < e; i++) {
+            computeBoneMatrices(impl, i);
+        }
+    };
+    if (skins.size() > 1) {
+        JobSystem& js = asset->mEngine->getJobSystem();
+        auto job = jobs::parallel_for(js, nullptr, 0, uint32_t(skins.size()),
+                std::cref(work), jobs::CountSplitter<1, 8>());
+        js.runAndWait(job);
+    } else {
+        work(0, 1);
+    }
+
+    // Hand the bones of each skinned renderable to the RenderableManager in a single call, its
+    // uniform buffer is then uploaded once when the frame is prepared.
+    RenderableManager* renderableManager = mImpl->renderableManager;
+    const mat4f* boneMatrices = mImpl->boneMatrices.data();
+    for (const auto& skin : skins) {
+        const size_t njoints = skin.joints.size();
+        for (const auto& entity : skin.targets) {
+            auto renderable = renderableManager->getInstance(entity);
+            if (renderable) {
+                renderableManager->setBones(renderable, boneMatrices, njoints);
             }
-            renderableManager->setBones(renderable, boneMatrices.data(), boneMatrices.size());
+            boneMatrices += njoints;
         }
     }
 }
@@ -41,8 +41,11 @@
 
 #include <tsl/robin_map.h>
 
+#include <algorithm>
 #include <vector>
 
+#include <stdio.h>
+
 #define CGLTF_IMPLEMENTATION
 #include <cgltf.h>
 
@@ -63,10 +66,12 @@ namespace details {
 // of VertexBuffer and IndexBuffer objects. To achieve the sharing behavior, the loader maintains a
 // small cache. The cache keys are glTF mesh definitions and the cache entries are lists of
 // primitives, where a "primitive" is a reference to a Filament VertexBuffer and IndexBuffer.
+// Meshes with morph targets are not cached, since each renderable streams its own positions.
 struct Primitive {
     VertexBuffer* vertices = nullptr;
     IndexBuffer* indices = nullptr;
     Aabb aabb; // object-space bounding box
+    int morphSlot = -1; // buffer index of the morphed positions, if any
 };
 using MeshCache = tsl::robin_map<const cgltf_mesh*, std::vector<Primitive>>;
 
@@ -94,10 +99,17 @@ static uint32_t computeBindingSize(const cgltf_accessor* accessor){
     return uint32_t(accessor->stride * (accessor->count - 1) + element_size);
 };
 
+// Compressed buffer views are decoded into their own allocation, so the offset of the view within
+// the buffer does not apply to them.
 static uint32_t computeBindingOffset(const cgltf_accessor* accessor) {
-    return uint32_t(accessor->offset + accessor->buffer_view->offset);
+    const cgltf_buffer_view* view = accessor->buffer_view;
+    return uint32_t(accessor->offset + (view->has_meshopt_compression ? 0 : view->offset));
 };
 
+static void** getBufferViewData(cgltf_buffer_view* view) {
+    return view->has_meshopt_compression ? &view->data : &view->buffer->data;
+}
+
 struct FAssetLoader : public AssetLoader {
     FAssetLoader(const AssetConfiguration& config) :
             mEntityManager(EntityManager::get()),
@@ -109,6 +121,7 @@ struct FAssetLoader : public AssetLoader {
 
     FFilamentAsset* createAssetFromJson(const uint8_t* bytes, uint32_t nbytes);
     FilamentAsset* createAssetFromBinary(const uint8_t* bytes, uint32_t nbytes);
+    FilamentAsset* createAssetFromFile(const char* path);
 
     ~FAssetLoader() {
         delete mMaterials;
@@ -192,6 +205,54 @@ FilamentAsset* FAssetLoader::createAssetFromBinary(const uint8_t* bytes, uint32_
     return mResult;
 }
 
+FilamentAsset* FAssetLoader::createAssetFromFile(const char* path) {
+    // The file is mapped rather than read, so that GLB buffers are uploaded straight from the
+    // mapping, which is kept until the source asset is released. JSON files are copied by cgltf
+    // while parsing, so their mapping is released right away.
+    MappedFile file;
+    std::vector<uint8_t> content;
+    const uint8_t* bytes;
+    size_t nbytes;
+    if (file.map(path)) {
+        bytes = file.data();
+        nbytes = file.size();
+    } else {
+        FILE* in = fopen(path, "rb");
+        if (!in) {
+            slog.e << "Unable to open " << path << io::endl;
+            return nullptr;
+        }
+        fseek(in, 0, SEEK_END);
+        content.resize(size_t(ftell(in)));
+        fseek(in, 0, SEEK_SET);
+        const bool ok = fread(content.data(), 1, content.size(), in) == content.size();
+        fclose(in);
+        if (!ok) {
+            slog.e << "Unable to read " << path << io::endl;
+            return nullptr;
+        }
+        bytes = content.data();
+        nbytes = content.size();
+    }
+
+    cgltf_options options { cgltf_file_type_invalid };
+    cgltf_data* sourceAsset;
+    cgltf_result result = cgltf_parse(&options, bytes, nbytes, &sourceAsset);
+    if (result != cgltf_result_success) {
+        return nullptr;
+    }
+    const bool isBinary = sourceAsset->bin != nullptr;
+    createAsset(sourceAsset);
+    if (mResult && isBinary) {
+        if (file.data()) {
+            mResult->mMappedFiles.push_back(std::move(file));
+        } else {
+            content.swap(mResult->mGlbData);
+        }
+    }
+    return mResult;
+}
+
 void FAssetLoader::createAsset(const cgltf_data* srcAsset) {
     mResult = new FFilamentAsset(mEngine);
     mResult->mSourceAsset = srcAsset;
@@ -286,11 +347,19 @@ void FAssetLoader::createRenderable(const cgltf_node* node, Entity entity) {
 
     // If the mesh is already loaded, obtain the list of Filament VertexBuffer / IndexBuffer
     // objects that were already generated, otherwise allocate a new list of null pointers.
-    auto iter = mMeshCache.find(mesh);
-    if (iter == mMeshCache.end()) {
-        mMeshCache[mesh].resize(nprims);
+    const bool morphed = nprims > 0 && mesh->primitives[0].targets_count > 0;
+    std::vector<Primitive> morphedPrims;
+    Primitive* outputPrim;
+    if (morphed) {
+        morphedPrims.resize(nprims);
+        outputPrim = morphedPrims.data();
+    } else {
+        auto iter = mMeshCache.find(mesh);
+        if (iter == mMeshCache.end()) {
+            mMeshCache[mesh].resize(nprims);
+        }
+        outputPrim = mMeshCache[mesh].data();
     }
-    Primitive* outputPrim = mMeshCache[mesh].data();
     const cgltf_primitive* inputPrim = &mesh->primitives[0];
 
     if (mNameManager && mesh->name) {
@@ -350,14 +419,33 @@ void FAssetLoader::createRenderable(const cgltf_node* node, Entity entity) {
        builder.skinning(node->skin->joints_count);
     }
 
+    // Record the primitives whose positions will be blended on the CPU. The node's default
+    // weights take precedence over the mesh's.
+    if (morphed) {
+        const size_t ntargets = mesh->primitives[0].targets_count;
+        Morph morph { .entity = entity };
+        morph.weights.resize(ntargets, 0.0f);
+        const float* weights = node->weights_count ? node->weights : mesh->weights;
+        const size_t nweights = node->weights_count ? node->weights_count : mesh->weights_count;
+        std::copy_n(weights, std::min(nweights, ntargets), morph.weights.begin());
+        for (cgltf_size index = 0; index < nprims; ++index) {
+            if (morphedPrims[index].morphSlot >= 0) {
+                morph.primitives.push_back({
+                    .vertexBuffer = morphedPrims[index].vertices,
+                    .positionSlot = uint8_t(morphedPrims[index].morphSlot),
+                    .source = &mesh->primitives[index]
+                });
+            }
+        }
+        mResult->mMorphs.push_back(std::move(morph));
+    }
+
     builder
         .boundingBox(Box().set(aabb.min, aabb.max))
         .culling(true)
         .castShadows(true)
         .receiveShadows(true)
         .build(*mEngine, entity);
-
-    // TODO: support vertex morphing by honoring mesh->weights and mesh->weight_count.
 }
 
 bool FAssetLoader::createPrimitive(const cgltf_primitive* inPrim, Primitive* outPrim,
@@ -377,13 +465,13 @@ bool FAssetLoader::createPrimitive(const cgltf_primitive* inPrim, Primitive* out
         }
         ibb.bufferType(indexType);
         indices = ibb.build(*mEngine);
-        const cgltf_buffer_view* bv = indicesAccessor->buffer_view;
+        cgltf_buffer_view* bv = indicesAccessor->buffer_view;
         mResult->mBufferBindings.emplace_back(BufferBinding {
             .uri = bv->buffer->uri,
             .totalSize = uint32_t(bv->buffer->size),
             .offset = computeBindingOffset(indicesAccessor),
             .size = computeBindingSize(indicesAccessor),
-            .data = &bv->buffer->data,
+            .data = getBufferViewData(bv),
             .indexBuffer = indices,
             .convertBytesToShorts = indicesAccessor->component_type == cgltf_component_type_r_8u,
             .generateTrivialIndices = false
@@ -475,6 +563,18 @@ bool FAssetLoader::createPrimitive(const cgltf_primitive* inPrim, Primitive* out
             return false;
         }
 
+        // Morphed positions are blended on the CPU into a tightly packed array of floats.
+        if (inputAttribute.type == cgltf_attribute_type_position && inPrim->targets_count > 0) {
+            if (hasSparseMorphTargets(inPrim)) {
+                slog.e << "Sparse morph targets not yet supported." << io::endl;
+                return false;
+            }
+            expandMorphedBounds(inPrim, &outPrim->aabb);
+            outPrim->morphSlot = slot;
+            vbb.attribute(semantic, slot, VertexBuffer::AttributeType::FLOAT3);
+            continue;
+        }
+
         // The cgltf library provides a stride value for all accessors, even though they do not
         // exist in the glTF file. It is computed from the type and the stride of the buffer view.
         // As a convenience, cgltf also replaces zero (default) stride with the actual stride.
@@ -513,13 +613,14 @@ bool FAssetLoader::createPrimitive(const cgltf_primitive* inPrim, Primitive* out
 
     vbb.bufferCount(slot);
 
-    VertexBuffer* vertices = mResult->mPrimMap[inPrim] = vbb.build(*mEngine);
+    VertexBuffer* vertices = vbb.build(*mEngine);
+    mResult->mPrimitives.emplace_back(inPrim, vertices);
     mResult->mVertexBuffers.push_back(vertices);
 
     for (cgltf_size slot = 0; slot < inPrim->attributes_count; slot++) {
         const cgltf_attribute& inputAttribute = inPrim->attributes[slot];
         const cgltf_accessor* inputAccessor = inputAttribute.data;
-        const cgltf_buffer_view* bv = inputAccessor->buffer_view;
+        cgltf_buffer_view* bv = inputAccessor->buffer_view;
         if (inputAttribute.type == cgltf_attribute_type_normal ||
                 inputAttribute.type == cgltf_attribute_type_tangent) {
             continue;
@@ -528,13 +629,16 @@ bool FAssetLoader::createPrimitive(const cgltf_primitive* inPrim, Primitive* out
                 uvmap[inputAttribute.index] == UNUSED) {
             continue;
         }
+        if (int(slot) == outPrim->morphSlot) {
+            continue;
+        }
         mResult->mBufferBindings.push_back({
             .uri = bv->buffer->uri,
             .totalSize = uint32_t(bv->buffer->size),
             .bufferIndex = uint8_t(slot),
             .offset = computeBindingOffset(inputAccessor),
             .size = computeBindingSize(inputAccessor),
-            .data = &bv->buffer->data,
+            .data = getBufferViewData(bv),
             .vertexBuffer = vertices,
             .indexBuffer = nullptr,
             .convertBytesToShorts = false,
@@ -805,6 +909,10 @@ FilamentAsset* AssetLoader::createAssetFromBinary(uint8_t const* bytes, uint32_t
     return upcast(this)->createAssetFromBinary(bytes, nbytes);
 }
 
+FilamentAsset* AssetLoader::createAssetFromFile(const char* path) {
+    return upcast(this)->createAssetFromFile(path);
+}
+
 void AssetLoader::destroyAsset(const FilamentAsset* asset) {
     upcast(this)->destroyAsset(upcast(asset));
 }
@@ -16,6 +16,7 @@
 
 #include <gltfio/AssetPipeline.h>
 
+#include <meshoptimizer.h>
 #include <xatlas.h>
 
 #define CGLTF_WRITE_IMPLEMENTATION
@@ -27,6 +28,7 @@
 #include <math/vec3.h>
 #include <math/vec4.h>
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -49,6 +51,9 @@ static const char* const NORMAL = "NORMAL";
 static const char* const TANGENT = "TANGENT";
 static const char* const GENERATOR_ID = "gltfio";
 
+// How much the overdraw optimizer is allowed to degrade the vertex cache efficiency (5%).
+static constexpr float OVERDRAW_THRESHOLD = 1.05f;
+
 // Bookkeeping structure for baking a single primitive + node pair.
 struct BakedPrim {
     const cgltf_node* sourceNode;
@@ -65,6 +70,14 @@ struct BakedPrim {
     float3 bakedMax;
 };
 
+// Bookkeeping structure for optimizing a single primitive of a flattened asset.
+struct OptimizedPrim {
+    vector<float> vertices;
+    vector<uint32_t> indices;
+    size_t vertexCount;
+    size_t floatsPerVertex;
+};
+
 // Utility class to help populate cgltf arrays and ensure that the memory is freed.
 template <typename T>
 class ArrayHolder {
@@ -88,6 +101,9 @@ public:
     // Use xatlas to generate a new UV set and modify topology appropriately.
     const cgltf_data* parameterize(const cgltf_data* sourceAsset);
 
+    // Use meshoptimizer to reorder triangles and vertices for rendering efficiency.
+    const cgltf_data* optimize(const cgltf_data* sourceAsset);
+
     // Strips materials from a flattened asset and replaces them a simple nonlit material.
     const cgltf_data* generatePreview(const cgltf_data* sourceAsset, const Path& texturePath);
 
@@ -1280,6 +1296,233 @@ const cgltf_data* Pipeline::parameterize(const cgltf_data* sourceAsset) {
     return result;
 }
 
+const cgltf_data* Pipeline::optimize(const cgltf_data* sourceAsset) {
+    if (!isFlattened(sourceAsset) || sourceAsset->buffers[0].data == nullptr) {
+        utils::slog.e << "Only flattened assets can be optimized." << utils::io::endl;
+        return nullptr;
+    }
+
+    // Convert the vertices of each prim into an interleaved fp32 buffer, then reorder its
+    // triangles for the post-transform vertex cache and for overdraw, and finally reorder its
+    // vertices in the order they're referenced by the triangles. Unused vertices are dropped.
+    // Other primitive types (lines, points and strips) only have their vertices reordered.
+    const size_t numPrims = sourceAsset->meshes_count;
+    vector<OptimizedPrim> optimizedPrims(numPrims);
+    size_t numAttributes = 0;
+    cgltf_size numIndices = 0;
+    cgltf_size numFloats = 0;
+    for (cgltf_size i = 0; i < numPrims; i++) {
+        const cgltf_primitive& sourcePrim = sourceAsset->meshes[i].primitives[0];
+        OptimizedPrim& prim = optimizedPrims[i];
+
+        size_t floatsPerVert = 0;
+        size_t positionsOffset = 0;
+        const cgltf_accessor* positions = nullptr;
+        for (size_t ai = 0; ai < sourcePrim.attributes_count; ++ai) {
+            const cgltf_attribute& attrib = sourcePrim.attributes[ai];
+            if (attrib.type == cgltf_attribute_type_position && !positions) {
+                positions = attrib.data;
+                positionsOffset = floatsPerVert;
+            }
+            floatsPerVert += getNumFloats(attrib.data->type);
+        }
+        if (!positions) {
+            utils::slog.e << "Mesh " << i << " has no positions." << utils::io::endl;
+            return nullptr;
+        }
+
+        const cgltf_size vertexCount = positions->count;
+        prim.vertices.resize(vertexCount * floatsPerVert);
+        float* vertexWritePtr = prim.vertices.data();
+        for (cgltf_size j = 0; j < vertexCount; ++j) {
+            for (size_t ai = 0; ai < sourcePrim.attributes_count; ++ai) {
+                const cgltf_accessor* accessor = sourcePrim.attributes[ai].data;
+                cgltf_size elementSize = getNumFloats(accessor->type);
+                cgltf_accessor_read_float(accessor, j, vertexWritePtr, elementSize);
+                vertexWritePtr += elementSize;
+            }
+        }
+
+        const cgltf_accessor* sourceIndices = sourcePrim.indices;
+        prim.indices.resize(sourceIndices->count);
+        for (cgltf_size j = 0; j < sourceIndices->count; ++j) {
+            prim.indices[j] = (uint32_t) cgltf_accessor_read_index(sourceIndices, j);
+        }
+
+        uint32_t* indices = prim.indices.data();
+        const size_t indexCount = prim.indices.size();
+        const size_t stride = floatsPerVert * sizeof(float);
+        if (sourcePrim.type == cgltf_primitive_type_triangles) {
+            meshopt_optimizeVertexCache(indices, indices, indexCount, vertexCount);
+            meshopt_optimizeOverdraw(indices, indices, indexCount,
+                    prim.vertices.data() + positionsOffset, vertexCount, stride,
+                    OVERDRAW_THRESHOLD);
+        }
+        prim.vertexCount = meshopt_optimizeVertexFetch(prim.vertices.data(), indices, indexCount,
+                prim.vertices.data(), vertexCount, stride);
+        prim.floatsPerVertex = floatsPerVert;
+
+        numAttributes += sourcePrim.attributes_count;
+        numIndices += indexCount;
+        numFloats += prim.vertexCount * floatsPerVert;
+    }
+
+    // We need one accessor per attribute plus one for the indices, and two buffer views per prim:
+    // one for the interleaved vertex attributes and one for the indices.
+    const size_t numAccessors = numAttributes + numPrims;
+    const size_t numBufferViews = numPrims * 2;
+
+    // Determine the number of node references.
+    size_t numNodePointers = 0;
+    for (cgltf_size i = 0; i < sourceAsset->scenes_count; ++i) {
+        numNodePointers += sourceAsset->scenes[i].nodes_count;
+    }
+
+    const cgltf_size resultBufferSize = 4 * (numIndices + numFloats);
+
+    // Allocate top-level structs.
+    cgltf_data* resultAsset = mStorage.resultAssets.alloc(1);
+    cgltf_scene* scenes = mStorage.scenes.alloc(sourceAsset->scenes_count);
+    cgltf_node** nodePointers = mStorage.nodePointers.alloc(numNodePointers);
+    cgltf_node* nodes = mStorage.nodes.alloc(numPrims);
+    cgltf_mesh* meshes = mStorage.meshes.alloc(numPrims);
+    cgltf_primitive* prims = mStorage.prims.alloc(numPrims);
+    cgltf_buffer_view* views = mStorage.views.alloc(numBufferViews);
+    cgltf_accessor* accessors = mStorage.accessors.alloc(numAccessors);
+    cgltf_attribute* attributes = mStorage.attributes.alloc(numAttributes);
+    cgltf_buffer* buffers = mStorage.buffers.alloc(1);
+    uint8_t* resultData = mStorage.bufferData.alloc(resultBufferSize);
+
+    buffers[0] = {
+        .size = resultBufferSize,
+        .data = resultData
+    };
+
+    // Clone the scenes and nodes. This is easy because the source asset has been flattened.
+    for (size_t i = 0, len = sourceAsset->scenes_count; i < len; ++i) {
+        cgltf_scene& scene = scenes[i] = sourceAsset->scenes[i];
+        for (size_t j = 0; j < scene.nodes_count; ++j) {
+            size_t nodeIndex = scene.nodes[j] - sourceAsset->nodes;
+            nodePointers[j] = nodes + nodeIndex;
+        }
+        scene.nodes = nodePointers;
+        nodePointers += scene.nodes_count;
+    }
+    for (cgltf_size i = 0; i < numPrims; i++) {
+        auto& node = nodes[i] = sourceAsset->nodes[i];
+        node.mesh = meshes + i;
+    }
+
+    // Copy the optimized vertices, followed by the optimized indices.
+    float* vertexWritePtr = (float*) resultData;
+    for (const OptimizedPrim& prim : optimizedPrims) {
+        const size_t count = prim.vertexCount * prim.floatsPerVertex;
+        memcpy(vertexWritePtr, prim.vertices.data(), count * sizeof(float));
+        vertexWritePtr += count;
+    }
+    uint32_t* indexWritePtr = (uint32_t*) vertexWritePtr;
+    for (const OptimizedPrim& prim : optimizedPrims) {
+        memcpy(indexWritePtr, prim.indices.data(), prim.indices.size() * sizeof(uint32_t));
+        indexWritePtr += prim.indices.size();
+    }
+
+    // Populate the buffer views, accessors and attributes for each prim.
+    cgltf_size vertexBufferOffset = 0;
+    cgltf_size indexBufferOffset = numFloats * sizeof(float);
+    cgltf_accessor* resultAccessor = accessors;
+    cgltf_attribute* resultAttribute = attributes;
+    for (cgltf_size i = 0; i < numPrims; i++) {
+        const OptimizedPrim& prim = optimizedPrims[i];
+        const cgltf_mesh& sourceMesh = sourceAsset->meshes[i];
+        const cgltf_primitive& sourcePrim = sourceMesh.primitives[0];
+        const cgltf_size stride = prim.floatsPerVertex * sizeof(float);
+
+        cgltf_buffer_view* vertexBufferView = views + i * 2 + 0;
+        cgltf_buffer_view* indexBufferView = views + i * 2 + 1;
+        *vertexBufferView = {
+            .buffer = buffers,
+            .offset = vertexBufferOffset,
+            .size = prim.vertexCount * stride,
+            .stride = stride,
+            .type = cgltf_buffer_view_type_vertices
+        };
+        *indexBufferView = {
+            .buffer = buffers,
+            .offset = indexBufferOffset,
+            .size = prim.indices.size() * sizeof(uint32_t),
+            .type = cgltf_buffer_view_type_indices
+        };
+        vertexBufferOffset += vertexBufferView->size;
+        indexBufferOffset += indexBufferView->size;
+
+        cgltf_mesh& resultMesh = meshes[i] = sourceMesh;
+        cgltf_primitive& resultPrim = prims[i] = sourcePrim;
+        resultMesh.primitives = &resultPrim;
+        resultPrim.attributes = resultAttribute;
+        resultPrim.indices = resultAccessor + sourcePrim.attributes_count;
+
+        cgltf_size offset = 0;
+        for (size_t ai = 0; ai < sourcePrim.attributes_count; ++ai) {
+            const cgltf_attribute& sourceAttrib = sourcePrim.attributes[ai];
+            const cgltf_accessor* sourceAccessor = sourceAttrib.data;
+            *resultAttribute = sourceAttrib;
+            resultAttribute->data = resultAccessor;
+            *resultAccessor = {
+                .component_type = cgltf_component_type_r_32f,
+                .type = sourceAccessor->type,
+                .offset = offset,
+                .count = prim.vertexCount,
+                .stride = stride,
+                .buffer_view = vertexBufferView,
+                .has_min = sourceAccessor->has_min,
+                .has_max = sourceAccessor->has_max,
+            };
+
+            // The bounds are recomputed since unused vertices might have been dropped.
+            const size_t elementSize = getNumFloats(sourceAccessor->type);
+            if (resultAccessor->has_min || resultAccessor->has_max) {
+                std::fill_n(resultAccessor->min, elementSize, std::numeric_limits<float>::max());
+                std::fill_n(resultAccessor->max, elementSize,
+                        std::numeric_limits<float>::lowest());
+                const float* element = prim.vertices.data() + offset / sizeof(float);
+                for (size_t j = 0; j < prim.vertexCount; ++j, element += prim.floatsPerVertex) {
+                    for (size_t k = 0; k < elementSize; ++k) {
+                        resultAccessor->min[k] = std::min(resultAccessor->min[k], element[k]);
+                        resultAccessor->max[k] = std::max(resultAccessor->max[k], element[k]);
+                    }
+                }
+            }
+
+            offset += sizeof(float) * elementSize;
+            ++resultAccessor;
+            ++resultAttribute;
+        }
+
+        // Accessor for index buffer.
+        *resultAccessor++ = {
+            .component_type = cgltf_component_type_r_32u,
+            .type = cgltf_type_scalar,
+            .count = prim.indices.size(),
+            .stride = sizeof(uint32_t),
+            .buffer_view = indexBufferView,
+        };
+    }
+
+    // Clone the high-level asset structure, then substitute some of the top-level lists.
+    *resultAsset = *sourceAsset;
+    resultAsset->buffers = buffers;
+    resultAsset->buffers_count = 1;
+    resultAsset->buffer_views = views;
+    resultAsset->buffer_views_count = numBufferViews;
+    resultAsset->accessors = accessors;
+    resultAsset->accessors_count = numAccessors;
+    resultAsset->meshes = meshes;
+    resultAsset->nodes = nodes;
+    resultAsset->scenes = scenes;
+    resultAsset->scene = scenes + (sourceAsset->scene - sourceAsset->scenes);
+    return resultAsset;
+}
+
 const cgltf_data* Pipeline::generatePreview(const cgltf_data* sourceAsset, const Path& texture) {
     if (!isFlattened(sourceAsset)) {
         utils::slog.e << "Only flattened assets can be modified." << utils::io::endl;
@@ -1647,6 +1890,11 @@ AssetHandle AssetPipeline::parameterize(AssetHandle source) {
     return impl->parameterize((const cgltf_data*) source);
 }
 
+AssetHandle AssetPipeline::optimize(AssetHandle source) {
+    Pipeline* impl = (Pipeline*) mImpl;
+    return impl->optimize((const cgltf_data*) source);
+}
+
 AssetHandle AssetPipeline::generatePreview(AssetHandle source, const Path& texture) {
     Pipeline* impl = (Pipeline*) mImpl;
     return impl->generatePreview((const cgltf_data*) source, texture);
@@ -30,11 +30,13 @@
 #include <filament/VertexBuffer.h>
 
 #include <math/mat4.h>
+#include <math/vec3.h>
 
 #include <utils/Entity.h>
 
 #include <cgltf.h>
 
+#include "MappedFile.h"
 #include "upcast.h"
 #include "Wireframe.h"
 
@@ -54,6 +56,34 @@ struct Skin {
     std::vector<utils::Entity> targets;
 };
 
+// A primitive with morph targets. Its positions are blended on the CPU and streamed into its own
+// vertex buffer, the other attributes are not morphed.
+struct MorphPrimitive {
+    filament::VertexBuffer* vertexBuffer;
+    uint8_t positionSlot;
+    const cgltf_primitive* source;  // only valid until the source data is released
+    std::vector<filament::math::float3> positions;
+    std::vector<std::vector<filament::math::float3>> targets; // position offsets, may be empty
+};
+
+// The morphed primitives of a renderable, and the default weights of its morph targets.
+struct Morph {
+    utils::Entity entity;
+    std::vector<float> weights;
+    std::vector<MorphPrimitive> primitives;
+};
+
+// Blends the positions of each primitive of a morphed renderable and uploads them to the GPU.
+// Only the targets with a non-zero weight are visited.
+void uploadMorphedPositions(filament::Engine& engine, const Morph& morph, const float* weights);
+
+// Expands the bounding box of a morphed primitive by the extent of each target's offsets, so that
+// it contains the primitive for any set of weights between 0 and 1.
+void expandMorphedBounds(const cgltf_primitive* prim, filament::Aabb* aabb);
+
+// Returns true if the position offsets of any morph target of the primitive are sparse.
+bool hasSparseMorphTargets(const cgltf_primitive* prim);
+
 struct FFilamentAsset : public FilamentAsset {
     FFilamentAsset(filament::Engine* engine) : mEngine(engine) {}
 
@@ -143,7 +173,12 @@ struct FFilamentAsset : public FilamentAsset {
         mTextureBindings.clear();
         mTextureBindings.shrink_to_fit();
         mNodeMap.clear();
-        mPrimMap.clear();
+        mPrimitives.clear();
+        for (auto& morph : mMorphs) {
+            for (auto& prim : morph.primitives) {
+                prim.source = nullptr;
+            }
+        }
         releaseSourceAsset();
     }
 
@@ -157,15 +192,26 @@ struct FFilamentAsset : public FilamentAsset {
 
     void releaseSourceAsset() {
         if (--mSourceAssetRefCount == 0) {
+            // the mapped buffers are not owned by cgltf
+            cgltf_data* gltf = (cgltf_data*) mSourceAsset;
+            for (cgltf_size i = 0; gltf && i < gltf->buffers_count; ++i) {
+                for (const MappedFile& file : mMappedFiles) {
+                    if (gltf->buffers[i].data == file.data()) {
+                        gltf->buffers[i].data = nullptr;
+                    }
+                }
+            }
+            cgltf_free(gltf);
+            mSourceAsset = nullptr;
             mGlbData.clear();
             mGlbData.shrink_to_fit();
-            cgltf_free((cgltf_data*) mSourceAsset);
-            mSourceAsset = nullptr;
+            mMappedFiles.clear();
         }
     }
 
     filament::Engine* mEngine;
     std::vector<uint8_t> mGlbData;
+    std::vector<MappedFile> mMappedFiles;   // the asset file and its buffers, when mapped
     std::vector<utils::Entity> mEntities;
     std::vector<filament::MaterialInstance*> mMaterialInstances;
     std::vector<filament::VertexBuffer*> mVertexBuffers;
@@ -174,6 +220,7 @@ struct FFilamentAsset : public FilamentAsset {
     filament::Aabb mBoundingBox;
     utils::Entity mRoot;
     std::vector<Skin> mSkins;
+    std::vector<Morph> mMorphs;
     Animator* mAnimator = nullptr;
     Wireframe* mWireframe = nullptr;
     int mSourceAssetRefCount = 0;
@@ -185,7 +232,8 @@ struct FFilamentAsset : public FilamentAsset {
     std::vector<TextureBinding> mTextureBindings;
     const cgltf_data* mSourceAsset = nullptr;
     tsl::robin_map<const cgltf_node*, utils::Entity> mNodeMap;
-    tsl::robin_map<const cgltf_primitive*, filament::VertexBuffer*> mPrimMap;
+    // Morphed meshes are not shared, so a primitive can have a VertexBuffer per instance.
+    std::vector<std::pair<const cgltf_primitive*, filament::VertexBuffer*>> mPrimitives;
     /** @} */
 };
 
@@ -16,10 +16,77 @@
 
 #include "FFilamentAsset.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 using namespace filament;
+using namespace filament::math;
 using namespace utils;
 
 namespace gltfio {
+namespace details {
+
+void uploadMorphedPositions(Engine& engine, const Morph& morph, const float* weights) {
+    for (const MorphPrimitive& prim : morph.primitives) {
+        const size_t size = prim.positions.size() * sizeof(float3);
+        float* UTILS_RESTRICT positions = (float*) malloc(size);
+        memcpy(positions, prim.positions.data(), size);
+
+        // The positions are processed as a flat array of floats so that the loop is vectorized.
+        const size_t count = prim.positions.size() * 3;
+        for (size_t target = 0, n = prim.targets.size(); target < n; ++target) {
+            const float weight = weights[target];
+            if (weight == 0 || prim.targets[target].empty()) {
+                continue;
+            }
+            const float* UTILS_RESTRICT offsets = (const float*) prim.targets[target].data();
+            for (size_t i = 0; i < count; ++i) {
+                positions[i] += weight * offsets[i];
+            }
+        }
+
+        auto callback = (VertexBuffer::BufferDescriptor::Callback) free;
+        VertexBuffer::BufferDescriptor bd(positions, size, callback);
+        prim.vertexBuffer->setBufferAt(engine, prim.positionSlot, std::move(bd));
+    }
+}
+
+void expandMorphedBounds(const cgltf_primitive* prim, Aabb* aabb) {
+    float3 minOffset(0);
+    float3 maxOffset(0);
+    for (cgltf_size i = 0; i < prim->targets_count; ++i) {
+        const cgltf_morph_target& target = prim->targets[i];
+        for (cgltf_size j = 0; j < target.attributes_count; ++j) {
+            const cgltf_attribute& attribute = target.attributes[j];
+            const cgltf_accessor* accessor = attribute.data;
+            if (attribute.type != cgltf_attribute_type_position ||
+                    !accessor->has_min || !accessor->has_max) {
+                continue;
+            }
+            const float3 targetMin(accessor->min[0], accessor->min[1], accessor->min[2]);
+            const float3 targetMax(accessor->max[0], accessor->max[1], accessor->max[2]);
+            minOffset += min(targetMin, float3(0));
+            maxOffset += max(targetMax, float3(0));
+        }
+    }
+    aabb->min += minOffset;
+    aabb->max += maxOffset;
+}
+
+bool hasSparseMorphTargets(const cgltf_primitive* prim) {
+    for (cgltf_size i = 0; i < prim->targets_count; ++i) {
+        const cgltf_morph_target& target = prim->targets[i];
+        for (cgltf_size j = 0; j < target.attributes_count; ++j) {
+            const cgltf_attribute& attribute = target.attributes[j];
+            if (attribute.type == cgltf_attribute_type_position && attribute.data->is_sparse) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+} // namespace details
 
 using namespace details;
 
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MappedFile.h"
+
+#if defined(WIN32)
+#   include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+#include <utility>
+
+namespace gltfio {
+namespace details {
+
+MappedFile::MappedFile(MappedFile&& rhs) noexcept {
+    std::swap(mData, rhs.mData);
+    std::swap(mSize, rhs.mSize);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept {
+    if (this != &rhs) {
+        unmap();
+        std::swap(mData, rhs.mData);
+        std::swap(mSize, rhs.mSize);
+    }
+    return *this;
+}
+
+#if defined(WIN32)
+
+bool MappedFile::map(const char* path) noexcept {
+    unmap();
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    }
+    CloseHandle(file);
+    if (!mapping) {
+        return false;
+    }
+    // the view keeps the mapping alive
+    void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!data) {
+        return false;
+    }
+    mData = (uint8_t*) data;
+    mSize = size_t(size.QuadPart);
+    return true;
+}
+
+void MappedFile::unmap() noexcept {
+    if (mData) {
+        UnmapViewOfFile(mData);
+        mData = nullptr;
+        mSize = 0;
+    }
+}
+
+#elif !defined(__EMSCRIPTEN__)
+
+bool MappedFile::map(const char* path) noexcept {
+    unmap();
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = mmap(nullptr, size_t(st.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    // the mapping stays valid after the file is closed
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    mData = (uint8_t*) data;
+    mSize = size_t(st.st_size);
+    return true;
+}
+
+void MappedFile::unmap() noexcept {
+    if (mData) {
+        munmap(mData, mSize);
+        mData = nullptr;
+        mSize = 0;
+    }
+}
+
+#else
+
+bool MappedFile::map(const char*) noexcept {
+    return false;
+}
+
+void MappedFile::unmap() noexcept {
+}
+
+#endif
+
+} // namespace details
+} // namespace gltfio
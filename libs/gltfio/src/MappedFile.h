@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTFIO_MAPPEDFILE_H
+#define GLTFIO_MAPPEDFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace gltfio {
+namespace details {
+
+// A copy-on-write memory mapping of a whole file. The mapped pages are loaded lazily and can be
+// modified in place, e.g. to normalize skinning weights, without affecting the file.
+class MappedFile {
+public:
+    MappedFile() noexcept = default;
+    ~MappedFile() noexcept { unmap(); }
+
+    MappedFile(MappedFile const& rhs) = delete;
+    MappedFile& operator=(MappedFile const& rhs) = delete;
+    MappedFile(MappedFile&& rhs) noexcept;
+    MappedFile& operator=(MappedFile&& rhs) noexcept;
+
+    // Returns false if the file can't be mapped, e.g. on platforms without memory mapping.
+    bool map(const char* path) noexcept;
+    void unmap() noexcept;
+
+    uint8_t* data() const noexcept { return mData; }
+    size_t size() const noexcept { return mSize; }
+
+private:
+    uint8_t* mData = nullptr;
+    size_t mSize = 0;
+};
+
+} // namespace details
+} // namespace gltfio
+
+#endif // GLTFIO_MAPPEDFILE_H
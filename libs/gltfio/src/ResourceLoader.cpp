@@ -20,6 +20,7 @@
 #include "upcast.h"
 
 #include <filament/Engine.h>
+#include <filament/Fence.h>
 #include <filament/IndexBuffer.h>
 #include <filament/MaterialInstance.h>
 #include <filament/Texture.h>
@@ -31,15 +32,24 @@
 #include <math/vec3.h>
 #include <math/vec4.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Log.h>
 
 #include <cgltf.h>
 
+#include <meshoptimizer.h>
+
 #include <stb_image.h>
 
 #include <tsl/robin_map.h>
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
 #include <string>
+#include <vector>
+
+#include <string.h>
 
 using namespace filament;
 using namespace filament::math;
@@ -47,8 +57,45 @@ using namespace utils;
 
 namespace gltfio {
 
+// An image to decode, shared by all the texture bindings that refer to it.
+struct TextureDecode {
+    const char* uri = nullptr;      // null for images stored in a buffer view
+    const uint8_t* data = nullptr;  // encoded image, or null to read it from path
+    size_t size = 0;
+    std::string path;
+    bool srgb = false;
+    stbi_uc* texels = nullptr;      // decoded RGBA texels, null if decoding failed
+    int width = 0;
+    int height = 0;
+    JobSystem::Job* job = nullptr;
+    std::atomic<bool> decoded{false};   // set by the decoding job
+    bool done = false;                  // the texture was created, or decoding failed
+};
+
+static void decodeTexture(TextureDecode& decode) {
+    int comp;
+    if (decode.data) {
+        decode.texels = stbi_load_from_memory(decode.data, decode.size,
+                &decode.width, &decode.height, &comp, 4);
+    } else {
+        #if !defined(__EMSCRIPTEN__)
+            decode.texels = stbi_load(decode.path.c_str(),
+                    &decode.width, &decode.height, &comp, 4);
+        #endif
+    }
+    decode.decoded.store(true, std::memory_order_release);
+}
+
 struct ResourceLoader::Impl {
     tsl::robin_map<std::string, BufferDescriptor> mResourceCache;
+
+    // The textures being loaded. The bindings are copied since the client may release the
+    // asset's source data before they're all loaded, decodes are in a deque so they never move.
+    details::FFilamentAsset* mAsset = nullptr;
+    std::vector<TextureBinding> mBindings;
+    std::vector<size_t> mBindingDecodes;
+    std::deque<TextureDecode> mDecodes;
+    size_t mDoneCount = 0;
 };
 
 namespace details {
@@ -69,9 +116,19 @@ public:
         mAssets.push_back(asset);
         asset->acquireSourceAsset();
     }
+    void removeAsset(FFilamentAsset* asset) {
+        auto iter = std::find(mAssets.begin(), mAssets.end(), asset);
+        if (iter != mAssets.end()) {
+            mAssets.erase(iter);
+            asset->releaseSourceAsset();
+        }
+    }
     void addPendingUpload() {
         ++mPendingUploads;
     }
+    bool hasPendingUploads() const {
+        return mPendingUploads > 0;
+    }
     static void onLoadedResource(void* buffer, size_t size, void* user) {
         auto pool = (AssetPool*) user;
         if (--pool->mPendingUploads == 0 && pool->mLoaderDestroyed) {
@@ -99,6 +156,7 @@ ResourceLoader::ResourceLoader(const ResourceConfiguration& config) : mConfig(co
         mPool(new AssetPool), pImpl(new Impl) {}
 
 ResourceLoader::~ResourceLoader() {
+    asyncCancelLoad();
     mPool->onLoaderDestroyed();
     delete pImpl;
 }
@@ -108,7 +166,7 @@ static void importSkinningData(Skin& dstSkin, const cgltf_skin& srcSkin) {
     dstSkin.inverseBindMatrices.resize(srcSkin.joints_count);
     if (srcMatrices) {
         auto dstMatrices = (uint8_t*) dstSkin.inverseBindMatrices.data();
-        auto srcBuffer = srcMatrices->buffer_view->buffer->data;
+        auto srcBuffer = cgltf_buffer_view_data(srcMatrices->buffer_view) + srcMatrices->offset;
         memcpy(dstMatrices, srcBuffer, srcSkin.joints_count * sizeof(mat4f));
     }
 }
@@ -130,8 +188,51 @@ static void generateTrivialIndices(uint32_t* dst, size_t numVertices) {
 }
 
 bool ResourceLoader::loadResources(FilamentAsset* asset) {
-    FFilamentAsset* fasset = upcast(asset);
-    if (fasset->mResourcesLoaded) {
+    if (!beginLoad(upcast(asset))) {
+        return false;
+    }
+    // Wait for all the images and create their textures.
+    return createTextures(false);
+}
+
+bool ResourceLoader::asyncBeginLoad(FilamentAsset* asset) {
+    return beginLoad(upcast(asset));
+}
+
+void ResourceLoader::asyncCancelLoad() {
+    JobSystem& js = mConfig.engine->getJobSystem();
+    for (TextureDecode& decode : pImpl->mDecodes) {
+        if (!decode.done) {
+            js.waitAndRelease(decode.job);
+            free(decode.texels);
+        }
+    }
+    if (pImpl->mAsset) {
+        // The pending uploads read the source data, so they must be consumed before the pool
+        // gives up its reference, which lets the client destroy the asset.
+        if (mPool->hasPendingUploads()) {
+            Fence::waitAndDestroy(mConfig.engine->createFence());
+        }
+        mPool->removeAsset(pImpl->mAsset);
+    }
+    pImpl->mAsset = nullptr;
+    pImpl->mBindings.clear();
+    pImpl->mBindingDecodes.clear();
+    pImpl->mDecodes.clear();
+    pImpl->mDoneCount = 0;
+}
+
+float ResourceLoader::asyncGetLoadProgress() const {
+    const size_t total = pImpl->mDecodes.size();
+    return total ? float(pImpl->mDoneCount) / float(total) : 1.0f;
+}
+
+void ResourceLoader::asyncUpdateLoad() {
+    createTextures(true);
+}
+
+bool ResourceLoader::beginLoad(FFilamentAsset* fasset) {
+    if (fasset->mResourcesLoaded || pImpl->mAsset) {
         return false;
     }
     fasset->mResourcesLoaded = true;
@@ -187,7 +288,24 @@ bool ResourceLoader::loadResources(FilamentAsset* asset) {
 
     #else
 
-    // Read data from the file system and base64 URLs.
+    // Map the external buffer files rather than reading them into memory, the vertex and index
+    // buffers are then uploaded straight from the mappings, which are released with the source
+    // asset once all the uploads have completed.
+    for (cgltf_size i = 0; i < gltf->buffers_count; ++i) {
+        cgltf_buffer& buffer = gltf->buffers[i];
+        if (buffer.data || !buffer.uri || strncmp(buffer.uri, "data:", 5) == 0 ||
+                strstr(buffer.uri, "://")) {
+            continue;
+        }
+        utils::Path fullpath = mConfig.gltfPath.getParent() + buffer.uri;
+        MappedFile file;
+        if (file.map(fullpath.c_str()) && file.size() >= buffer.size) {
+            buffer.data = file.data();
+            fasset->mMappedFiles.push_back(std::move(file));
+        }
+    }
+
+    // Read the remaining data from the file system and base64 URLs.
     cgltf_result result = cgltf_load_buffers(&options, gltf, mConfig.gltfPath.c_str());
     if (result != cgltf_result_success) {
         slog.e << "Unable to load resources." << io::endl;
@@ -196,6 +314,12 @@ bool ResourceLoader::loadResources(FilamentAsset* asset) {
 
     #endif
 
+    // Buffer views compressed with EXT_meshopt_compression must be decoded before anything else
+    // reads the vertex data.
+    if (!decodeMeshoptBuffers(fasset)) {
+        return false;
+    }
+
     // To be robust against the glTF conformance suite, we optionally ensure that skinning weights
     // sum to 1.0 at every vertex. Note that if the same weights buffer is shared in multiple
     // places, this will needlessly repeat the work. In the future we would like to remove this
@@ -210,8 +334,8 @@ bool ResourceLoader::loadResources(FilamentAsset* asset) {
     }
 
     // Upload data to the GPU.
-    const BufferBinding* bindings = asset->getBufferBindings();
-    for (size_t i = 0, n = asset->getBufferBindingCount(); i < n; ++i) {
+    const BufferBinding* bindings = fasset->getBufferBindings();
+    for (size_t i = 0, n = fasset->getBufferBindingCount(); i < n; ++i) {
         auto bb = bindings[i];
         if (bb.vertexBuffer && !bb.generateDummyData) {
             const uint8_t* data8 = bb.offset + (const uint8_t*) *bb.data;
@@ -254,14 +378,99 @@ bool ResourceLoader::loadResources(FilamentAsset* asset) {
     // Compute surface orientation quaternions if necessary.
     computeTangents(fasset);
 
-    // Finally, load image files and create Filament Textures.
-    return createTextures(fasset);
+    // Copy the positions of the morphed primitives, they are then blended and uploaded.
+    importMorphTargets(fasset);
+
+    // Finally, decode the image files in the background, their Filament Textures are created
+    // as they're ready, see createTextures().
+    return decodeTextures(fasset);
 }
 
-bool ResourceLoader::createTextures(details::FFilamentAsset* asset) const {
+bool ResourceLoader::decodeTextures(FFilamentAsset* asset) {
+    // Gather the images to decode. To prevent needless re-decoding, we create a couple maps of
+    // decodes where the map keys are data pointers or URL strings.
+    const TextureBinding* texbindings = asset->getTextureBindings();
+    const size_t bindingCount = asset->getTextureBindingCount();
+    std::vector<size_t>& bindingDecodes = pImpl->mBindingDecodes;
+    std::deque<TextureDecode>& decodes = pImpl->mDecodes;
+    bindingDecodes.resize(bindingCount);
+
+    tsl::robin_map<const void*, size_t> bufDecodes;
+    tsl::robin_map<std::string, size_t> urlDecodes;
+
+    for (size_t i = 0; i < bindingCount; ++i) {
+        auto tb = texbindings[i];
+
+        // Check if the texture binding uses BufferView data (i.e. it does not have a URL).
+        if (tb.data) {
+            const uint8_t* data8 = tb.offset + (const uint8_t*) *tb.data;
+            auto iter = bufDecodes.find(data8);
+            if (iter == bufDecodes.end()) {
+                iter = bufDecodes.emplace(data8, decodes.size()).first;
+                decodes.emplace_back();
+                decodes.back().data = data8;
+                decodes.back().size = tb.totalSize;
+                decodes.back().srgb = tb.srgb;
+            }
+            bindingDecodes[i] = iter->second;
+            continue;
+        }
+
+        // Check if this URL is already being decoded.
+        auto iter = urlDecodes.find(tb.uri);
+        if (iter != urlDecodes.end()) {
+            bindingDecodes[i] = iter->second;
+            continue;
+        }
+        urlDecodes.emplace(tb.uri, decodes.size());
+        bindingDecodes[i] = decodes.size();
+        decodes.emplace_back();
+        TextureDecode& decode = decodes.back();
+        decode.uri = tb.uri;
+        decode.srgb = tb.srgb;
+
+        // Check the resource cache for this URL, otherwise load it from the file system.
+        auto cached = pImpl->mResourceCache.find(tb.uri);
+        if (cached != pImpl->mResourceCache.end()) {
+            decode.data = (const uint8_t*) cached->second.buffer;
+            decode.size = cached->second.size;
+        } else {
+            #if defined(__EMSCRIPTEN__)
+                slog.e << "Unable to load texture: " << tb.uri << io::endl;
+                bindingDecodes.clear();
+                decodes.clear();
+                return false;
+            #else
+                utils::Path fullpath = this->mConfig.gltfPath.getParent() + tb.uri;
+                decode.path = fullpath.getPath();
+            #endif
+        }
+    }
+
+    if (decodes.empty()) {
+        bindingDecodes.clear();
+        return true;
+    }
+
+    pImpl->mAsset = asset;
+    pImpl->mBindings.assign(texbindings, texbindings + bindingCount);
+    pImpl->mDoneCount = 0;
+
+    // Decode all the images in parallel, decoding PNG and JPEG files dominates the load time.
+    JobSystem& js = mConfig.engine->getJobSystem();
+    for (TextureDecode& decode : decodes) {
+        TextureDecode* pDecode = &decode;
+        decode.job = js.runAndRetain(js.createJob(nullptr,
+                [pDecode](JobSystem&, JobSystem::Job*) { decodeTexture(*pDecode); }));
+    }
+    return true;
+}
+
+bool ResourceLoader::createTextures(bool async) {
     // Define a simple functor that creates a Filament Texture from a blob of texels.
     // TODO: this could be optimized, e.g. do not generate mips if never mipmap-sampled, and use a
     // more compact format when possible.
+    FFilamentAsset* asset = pImpl->mAsset;
     auto createTexture = [this, asset](stbi_uc* texels, uint32_t w, uint32_t h, bool srgb) {
         Texture *tex = Texture::Builder()
                 .width(w)
@@ -282,198 +491,375 @@ bool ResourceLoader::createTextures(details::FFilamentAsset* asset) const {
         return tex;
     };
 
-    // Decode textures and associate them with material instance parameters.
-    // To prevent needless re-decoding, we create a couple maps of Filament Texture objects where
-    // the map keys are data pointers or URL strings.
-    stbi_uc* texels;
-    int width, height, comp;
-    Texture* tex;
-
-    tsl::robin_map<const void*, Texture*> bufTextures;
-    tsl::robin_map<std::string, Texture*> urlTextures;
-
-    const TextureBinding* texbindings = asset->getTextureBindings();
-    for (size_t i = 0, n = asset->getTextureBindingCount(); i < n; ++i) {
-        auto tb = texbindings[i];
-
-        // Check if the texture binding uses BufferView data (i.e. it does not have a URL).
-        if (tb.data) {
-            const uint8_t* data8 = tb.offset + (const uint8_t*) *tb.data;
-            tex = bufTextures[data8];
-            if (!tex) {
-                texels = stbi_load_from_memory(data8, tb.totalSize, &width, &height, &comp, 4);
-                if (texels == nullptr) {
-                    slog.e << "Unable to decode texture." << io::endl;
-                    return false;
-                }
-                bufTextures[data8] = tex = createTexture(texels, width, height, tb.srgb);
-            }
-            tb.materialInstance->setParameter(tb.materialParameter, tex, tb.sampler);
+    // Create the textures in order, as soon as each image is decoded. When loading
+    // asynchronously, we only pick up the images that are already decoded.
+    JobSystem& js = mConfig.engine->getJobSystem();
+    std::deque<TextureDecode>& decodes = pImpl->mDecodes;
+    bool success = true;
+    for (size_t i = 0, n = decodes.size(); i < n; ++i) {
+        TextureDecode& decode = decodes[i];
+        if (decode.done || (async && !decode.decoded.load(std::memory_order_acquire))) {
             continue;
         }
+        js.waitAndRelease(decode.job);
+        decode.done = true;
+        pImpl->mDoneCount++;
 
-        // Check if we already created a Texture object for this URL.
-        tex = urlTextures[tb.uri];
-        if (tex) {
-            tb.materialInstance->setParameter(tb.materialParameter, tex, tb.sampler);
+        if (decode.texels == nullptr) {
+            if (decode.uri) {
+                slog.e << "Unable to decode texture: " << decode.uri << io::endl;
+            } else {
+                slog.e << "Unable to decode texture." << io::endl;
+            }
+            success = false;
             continue;
         }
 
-        // Check the resource cache for this URL, otherwise load it from the file system.
-        auto iter = pImpl->mResourceCache.find(tb.uri);
-        if (iter != pImpl->mResourceCache.end()) {
-            const uint8_t* data8 = (const uint8_t*) iter->second.buffer;
-            texels = stbi_load_from_memory(data8, iter->second.size, &width, &height, &comp, 4);
-        } else {
-            #if defined(__EMSCRIPTEN__)
-                slog.e << "Unable to load texture: " << tb.uri << io::endl;
-                return false;
-            #else
-                utils::Path fullpath = this->mConfig.gltfPath.getParent() + tb.uri;
-                texels = stbi_load(fullpath.c_str(), &width, &height, &comp, 4);
-            #endif
+        // Associate the texture with material instance parameters.
+        Texture* tex = createTexture(decode.texels, decode.width, decode.height, decode.srgb);
+        for (size_t j = 0, c = pImpl->mBindings.size(); j < c; ++j) {
+            if (pImpl->mBindingDecodes[j] == i) {
+                const TextureBinding& tb = pImpl->mBindings[j];
+                tb.materialInstance->setParameter(tb.materialParameter, tex, tb.sampler);
+            }
         }
+    }
 
-        if (texels == nullptr) {
-            slog.e << "Unable to decode texture: " << tb.uri << io::endl;
-            return false;
-        }
+    if (pImpl->mDoneCount == decodes.size()) {
+        pImpl->mAsset = nullptr;
+        pImpl->mBindings.clear();
+        pImpl->mBindingDecodes.clear();
+        decodes.clear();
+        pImpl->mDoneCount = 0;
+    }
+    return success;
+}
 
-        urlTextures[tb.uri] = tex = createTexture(texels, width, height, tb.srgb);
-        tb.materialInstance->setParameter(tb.materialParameter, tex, tb.sampler);
+// Returns the data of a float accessor, read in place if it's neither sparse nor quantized,
+// otherwise converted into the scratch vector.
+template<typename T>
+static const T* readFloats(const cgltf_accessor* accessor, std::vector<T>& scratch,
+        size_t* stride) {
+    if (accessor->component_type == cgltf_component_type_r_32f && !accessor->is_sparse &&
+            accessor->buffer_view && cgltf_buffer_view_data(accessor->buffer_view)) {
+        *stride = accessor->stride;
+        return (const T*) (cgltf_buffer_view_data(accessor->buffer_view) + accessor->offset);
     }
-    return true;
+    scratch.resize(accessor->count);
+    for (cgltf_size i = 0; i < accessor->count; ++i) {
+        cgltf_accessor_read_float(accessor, i, &scratch[i].x, sizeof(T) / sizeof(float));
+    }
+    *stride = sizeof(T);
+    return scratch.data();
 }
 
-void ResourceLoader::computeTangents(FFilamentAsset* asset) const {
-    // Declare vectors of normals and tangents, which we'll extract & convert from the source.
+// The surface orientation of a primitive, computed in a job.
+struct TangentsJob {
+    const cgltf_primitive* prim;
+    VertexBuffer* vb;
+    int slot;                       // buffer index of the normals, replaced by the quaternions
+    cgltf_size vertexCount;
+    short4* quats;                  // null if there's nothing to upload
+    const char* error;
+};
+
+static void computeQuats(TangentsJob& job) {
+    const cgltf_primitive& prim = *job.prim;
+    cgltf_size vertexCount = 0;
+
+    // Collect accessors for normals, tangents, etc.
+    const int NUM_ATTRIBUTES = 8;
+    int slots[NUM_ATTRIBUTES] = {};
+    const cgltf_accessor* accessors[NUM_ATTRIBUTES] = {};
+    for (cgltf_size slot = 0; slot < prim.attributes_count; slot++) {
+        const cgltf_attribute& attr = prim.attributes[slot];
+        // Ignore the second set of UV's.
+        if (attr.index != 0) {
+            continue;
+        }
+        vertexCount = attr.data->count;
+        slots[attr.type] = slot;
+        accessors[attr.type] = attr.data;
+    }
+
+    // At a minimum we need normals to generate tangents.
+    auto normalsInfo = accessors[cgltf_attribute_type_normal];
+    if (normalsInfo == nullptr || vertexCount == 0) {
+        return;
+    }
+
+    // The attributes are read in place when possible, these hold the ones that need conversion.
     std::vector<float3> fp32Normals;
     std::vector<float4> fp32Tangents;
     std::vector<float3> fp32Positions;
     std::vector<float2> fp32TexCoords;
     std::vector<uint3> ui32Triangles;
+    size_t stride;
 
-    auto computeQuats = [&](const cgltf_primitive& prim) {
+    geometry::SurfaceOrientation::Builder sob;
+    sob.vertexCount(vertexCount);
 
-        cgltf_size vertexCount = 0;
+    assert(normalsInfo->count == vertexCount);
+    assert(normalsInfo->type == cgltf_type_vec3);
+    const float3* normals = readFloats(normalsInfo, fp32Normals, &stride);
+    sob.normals(normals, stride);
 
-        // Collect accessors for normals, tangents, etc.
-        const int NUM_ATTRIBUTES = 8;
-        int slots[NUM_ATTRIBUTES] = {};
-        const cgltf_accessor* accessors[NUM_ATTRIBUTES] = {};
-        for (cgltf_size slot = 0; slot < prim.attributes_count; slot++) {
-            const cgltf_attribute& attr = prim.attributes[slot];
-            // Ignore the second set of UV's.
-            if (attr.index != 0) {
-                continue;
-            }
-            vertexCount = attr.data->count;
-            slots[attr.type] = slot;
-            accessors[attr.type] = attr.data;
+    auto tangentsInfo = accessors[cgltf_attribute_type_tangent];
+    if (tangentsInfo) {
+        if (tangentsInfo->count != vertexCount || tangentsInfo->type != cgltf_type_vec4) {
+            job.error = "Bad tangent count or type.";
+            return;
         }
+        const float4* tangents = readFloats(tangentsInfo, fp32Tangents, &stride);
+        sob.tangents(tangents, stride);
+    }
 
-        // At a minimum we need normals to generate tangents.
-        auto normalsInfo = accessors[cgltf_attribute_type_normal];
-        if (normalsInfo == nullptr || vertexCount == 0) {
+    auto positionsInfo = accessors[cgltf_attribute_type_position];
+    if (positionsInfo) {
+        if (positionsInfo->count != vertexCount || positionsInfo->type != cgltf_type_vec3) {
+            job.error = "Bad position count or type.";
             return;
         }
+        const float3* positions = readFloats(positionsInfo, fp32Positions, &stride);
+        sob.positions(positions, stride);
+    }
 
-        short4* quats = (short4*) malloc(sizeof(short4) * vertexCount);
-
-        geometry::SurfaceOrientation::Builder sob;
-        sob.vertexCount(vertexCount);
-
-        // Convert normals into packed floats.
-        assert(normalsInfo->count == vertexCount);
-        assert(normalsInfo->type == cgltf_type_vec3);
-        fp32Normals.resize(vertexCount);
-        for (cgltf_size i = 0; i < vertexCount; ++i) {
-            cgltf_accessor_read_float(normalsInfo, i, &fp32Normals[i].x, 3);
+    // 16 and 32 bit indices are read in place, 8 bit indices are converted.
+    const cgltf_accessor* indices = prim.indices;
+    if (indices && !indices->is_sparse && indices->buffer_view &&
+            (indices->component_type == cgltf_component_type_r_16u ||
+             indices->component_type == cgltf_component_type_r_32u)) {
+        const uint8_t* data = cgltf_buffer_view_data(indices->buffer_view) + indices->offset;
+        sob.triangleCount(indices->count / 3);
+        if (indices->component_type == cgltf_component_type_r_16u) {
+            sob.triangles((const ushort3*) data);
+        } else {
+            sob.triangles((const uint3*) data);
+        }
+    } else if (indices) {
+        ui32Triangles.resize(indices->count / 3);
+        cgltf_size j = 0;
+        for (auto& triangle : ui32Triangles) {
+            triangle.x = cgltf_accessor_read_index(indices, j++);
+            triangle.y = cgltf_accessor_read_index(indices, j++);
+            triangle.z = cgltf_accessor_read_index(indices, j++);
         }
-        sob.normals(fp32Normals.data());
+        sob.triangleCount(ui32Triangles.size());
+        sob.triangles(ui32Triangles.data());
+    } else {
+        ui32Triangles.resize(vertexCount / 3);
+        uint32_t j = 0;
+        for (auto& triangle : ui32Triangles) {
+            triangle = uint3{ j, j + 1, j + 2 };
+            j += 3;
+        }
+        sob.triangleCount(ui32Triangles.size());
+        sob.triangles(ui32Triangles.data());
+    }
 
-        // Convert tangents into packed floats.
-        auto tangentsInfo = accessors[cgltf_attribute_type_tangent];
-        if (tangentsInfo) {
-            if (tangentsInfo->count != vertexCount || tangentsInfo->type != cgltf_type_vec4) {
-                slog.e << "Bad tangent count or type." << io::endl;
-                return;
-            }
-            fp32Tangents.resize(vertexCount);
-            for (cgltf_size i = 0; i < vertexCount; ++i) {
-                cgltf_accessor_read_float(tangentsInfo, i, &fp32Tangents[i].x, 4);
-            }
-            sob.tangents(fp32Tangents.data());
+    auto texcoordsInfo = accessors[cgltf_attribute_type_texcoord];
+    if (texcoordsInfo) {
+        if (texcoordsInfo->count != vertexCount || texcoordsInfo->type != cgltf_type_vec2) {
+            job.error = "Bad texcoord count or type.";
+            return;
         }
+        const float2* texcoords = readFloats(texcoordsInfo, fp32TexCoords, &stride);
+        sob.uvs(texcoords, stride);
+    }
 
-        auto positionsInfo = accessors[cgltf_attribute_type_position];
-        if (positionsInfo) {
-            if (positionsInfo->count != vertexCount || positionsInfo->type != cgltf_type_vec3) {
-                slog.e << "Bad position count or type." << io::endl;
-                return;
-            }
-            fp32Positions.resize(vertexCount);
-            for (cgltf_size i = 0; i < vertexCount; ++i) {
-                cgltf_accessor_read_float(positionsInfo, i, &fp32Positions[i].x, 3);
-            }
-            sob.positions(fp32Positions.data());
+    // Compute surface orientation quaternions.
+    auto helper = sob.build();
+    job.quats = (short4*) malloc(sizeof(short4) * vertexCount);
+    helper.getQuats(job.quats, vertexCount);
+    job.slot = slots[cgltf_attribute_type_normal];
+    job.vertexCount = vertexCount;
+}
+
+void ResourceLoader::computeTangents(FFilamentAsset* asset) const {
+    std::vector<TangentsJob> tangentsJobs;
+    tangentsJobs.reserve(asset->mPrimitives.size());
+    for (auto iter : asset->mPrimitives) {
+        tangentsJobs.push_back({ iter.first, iter.second, 0, 0, nullptr, nullptr });
+    }
+
+    // The primitives are independent of each other, so they're spread over all cores.
+    JobSystem& js = mConfig.engine->getJobSystem();
+    auto work = [&tangentsJobs](uint32_t first, uint32_t count) {
+        for (uint32_t i = first, e = first + count; i < e; i++) {
+            computeQuats(tangentsJobs[i]);
         }
+    };
+    auto job = jobs::parallel_for(js, nullptr, 0, uint32_t(tangentsJobs.size()),
+            std::cref(work), jobs::CountSplitter<1, 16>());
+    js.runAndWait(job);
+
+    // Upload quaternions to the GPU.
+    for (TangentsJob& tj : tangentsJobs) {
+        if (tj.error) {
+            slog.e << tj.error << io::endl;
+        }
+        if (tj.quats) {
+            auto callback = (VertexBuffer::BufferDescriptor::Callback) free;
+            VertexBuffer::BufferDescriptor bd(tj.quats, tj.vertexCount * sizeof(short4), callback);
+            tj.vb->setBufferAt(*mConfig.engine, tj.slot, std::move(bd));
+        }
+    }
+}
 
-        if (prim.indices) {
-            size_t triangleCount = prim.indices->count / 3;
-            ui32Triangles.resize(triangleCount);
-            cgltf_size j = 0;
-            for (auto& triangle : ui32Triangles) {
-                triangle.x = cgltf_accessor_read_index(prim.indices, j++);
-                triangle.y = cgltf_accessor_read_index(prim.indices, j++);
-                triangle.z = cgltf_accessor_read_index(prim.indices, j++);
+// Decodes a buffer view compressed with EXT_meshopt_compression into its own allocation, which
+// is released by cgltf_free along with the rest of the source asset.
+// meshoptimizer asserts on invalid parameters, so they're checked beforehand
+static bool isValidMeshopt(const cgltf_buffer_view& view) {
+    const cgltf_meshopt_compression& mc = view.meshopt_compression;
+    if (mc.count * mc.stride != view.size || mc.offset + mc.size > mc.buffer->size) {
+        return false;
+    }
+    switch (mc.mode) {
+        case cgltf_meshopt_compression_mode_attributes:
+            if (mc.stride == 0 || mc.stride > 256 || mc.stride % 4 != 0) {
+                return false;
             }
-        } else {
-            size_t triangleCount = vertexCount / 3;
-            ui32Triangles.resize(triangleCount);
-            cgltf_size j = 0;
-            for (auto& triangle : ui32Triangles) {
-                triangle.x = j++;
-                triangle.y = j++;
-                triangle.z = j++;
+            break;
+        case cgltf_meshopt_compression_mode_triangles:
+            if (mc.count % 3 != 0) {
+                return false;
             }
-        }
+            // fall through
+        case cgltf_meshopt_compression_mode_indices:
+            if (mc.stride != 2 && mc.stride != 4) {
+                return false;
+            }
+            break;
+        default:
+            return false;
+    }
+    switch (mc.filter) {
+        case cgltf_meshopt_compression_filter_none:
+            return true;
+        case cgltf_meshopt_compression_filter_octahedral:
+            return mc.stride == 4 || mc.stride == 8;
+        case cgltf_meshopt_compression_filter_quaternion:
+            return mc.stride == 8;
+        case cgltf_meshopt_compression_filter_exponential:
+            return mc.stride % 4 == 0;
+        default:
+            return false;
+    }
+}
 
-        sob.triangleCount(ui32Triangles.size());
-        sob.triangles(ui32Triangles.data());
+static bool decodeMeshopt(cgltf_buffer_view& view) {
+    const cgltf_meshopt_compression& mc = view.meshopt_compression;
+    if (!mc.buffer->data || !isValidMeshopt(view)) {
+        return false;
+    }
+    const uint8_t* source = (const uint8_t*) mc.buffer->data + mc.offset;
+    void* data = malloc(view.size);
+    if (!data) {
+        return false;
+    }
+    int result = -1;
+    switch (mc.mode) {
+        case cgltf_meshopt_compression_mode_attributes:
+            result = meshopt_decodeVertexBuffer(data, mc.count, mc.stride, source, mc.size);
+            break;
+        case cgltf_meshopt_compression_mode_triangles:
+            result = meshopt_decodeIndexBuffer(data, mc.count, mc.stride, source, mc.size);
+            break;
+        case cgltf_meshopt_compression_mode_indices:
+            result = meshopt_decodeIndexSequence(data, mc.count, mc.stride, source, mc.size);
+            break;
+        default:
+            break;
+    }
+    if (result != 0) {
+        free(data);
+        return false;
+    }
+    switch (mc.filter) {
+        case cgltf_meshopt_compression_filter_octahedral:
+            meshopt_decodeFilterOct(data, mc.count, mc.stride);
+            break;
+        case cgltf_meshopt_compression_filter_quaternion:
+            meshopt_decodeFilterQuat(data, mc.count, mc.stride);
+            break;
+        case cgltf_meshopt_compression_filter_exponential:
+            meshopt_decodeFilterExp(data, mc.count, mc.stride);
+            break;
+        default:
+            break;
+    }
+    view.data = data;
+    return true;
+}
 
-        auto texcoordsInfo = accessors[cgltf_attribute_type_texcoord];
-        if (texcoordsInfo) {
-            if (texcoordsInfo->count != vertexCount || texcoordsInfo->type != cgltf_type_vec2) {
-                slog.e << "Bad texcoord count or type." << io::endl;
-                return;
-            }
-            fp32TexCoords.resize(vertexCount);
-            for (cgltf_size i = 0; i < vertexCount; ++i) {
-                cgltf_accessor_read_float(texcoordsInfo, i, &fp32TexCoords[i].x, 2);
-            }
-            sob.uvs(fp32TexCoords.data());
+bool ResourceLoader::decodeMeshoptBuffers(FFilamentAsset* asset) const {
+    auto gltf = (cgltf_data*) asset->mSourceAsset;
+    std::vector<cgltf_buffer_view*> views;
+    for (cgltf_size i = 0; i < gltf->buffer_views_count; ++i) {
+        cgltf_buffer_view& view = gltf->buffer_views[i];
+        if (view.has_meshopt_compression && !view.data) {
+            views.push_back(&view);
         }
+    }
+    if (views.empty()) {
+        return true;
+    }
 
-        // Compute surface orientation quaternions.
-        auto helper = sob.build();
-        helper.getQuats(quats, vertexCount);
-
-        // Upload quaternions to the GPU.
-        auto callback = (VertexBuffer::BufferDescriptor::Callback) free;
-        VertexBuffer::BufferDescriptor bd(quats, vertexCount * sizeof(short4), callback);
-        VertexBuffer* vb = asset->mPrimMap.at(&prim);
-        vb->setBufferAt(*mConfig.engine, slots[cgltf_attribute_type_normal], std::move(bd));
+    // The buffer views are independent of each other, so they're spread over all cores.
+    std::vector<uint8_t> decoded(views.size());
+    JobSystem& js = mConfig.engine->getJobSystem();
+    auto work = [&views, &decoded](uint32_t first, uint32_t count) {
+        for (uint32_t i = first, e = first + count; i < e; i++) {
+            decoded[i] = decodeMeshopt(*views[i]);
+        }
     };
+    auto job = jobs::parallel_for(js, nullptr, 0, uint32_t(views.size()),
+            std::cref(work), jobs::CountSplitter<1, 16>());
+    js.runAndWait(job);
+
+    for (size_t i = 0; i < views.size(); ++i) {
+        if (!decoded[i]) {
+            slog.e << "Unable to decode buffer view " << size_t(views[i] - gltf->buffer_views)
+                    << io::endl;
+            return false;
+        }
+    }
+    return true;
+}
 
-    for (auto iter : asset->mNodeMap) {
-        const cgltf_mesh* mesh = iter.first->mesh;
-        if (mesh) {
-            cgltf_size nprims = mesh->primitives_count;
-            for (cgltf_size index = 0; index < nprims; ++index) {
-                computeQuats(mesh->primitives[index]);
+// Sparse accessors are rejected by the AssetLoader, cgltf can't read them.
+static void readPositions(const cgltf_accessor* accessor, std::vector<float3>& dst) {
+    assert(!accessor->is_sparse);
+    dst.resize(accessor->count);
+    for (cgltf_size i = 0; i < accessor->count; ++i) {
+        cgltf_accessor_read_float(accessor, i, &dst[i].x, 3);
+    }
+}
+
+void ResourceLoader::importMorphTargets(FFilamentAsset* asset) const {
+    for (Morph& morph : asset->mMorphs) {
+        for (MorphPrimitive& prim : morph.primitives) {
+            const cgltf_primitive* source = prim.source;
+            for (cgltf_size i = 0; i < source->attributes_count; ++i) {
+                if (source->attributes[i].type == cgltf_attribute_type_position) {
+                    readPositions(source->attributes[i].data, prim.positions);
+                }
+            }
+
+            // Targets without positions are left empty and skipped when blending.
+            prim.targets.resize(source->targets_count);
+            for (cgltf_size t = 0; t < source->targets_count; ++t) {
+                const cgltf_morph_target& target = source->targets[t];
+                for (cgltf_size i = 0; i < target.attributes_count; ++i) {
+                    const cgltf_attribute& attribute = target.attributes[i];
+                    if (attribute.type == cgltf_attribute_type_position &&
+                            attribute.data->count == prim.positions.size()) {
+                        readPositions(attribute.data, prim.targets[t]);
+                    }
+                }
             }
         }
+        uploadMorphedPositions(*mConfig.engine, morph, morph.weights.data());
     }
 }
 
@@ -483,8 +869,8 @@ void ResourceLoader::normalizeSkinningWeights(details::FFilamentAsset* asset) co
             slog.w << "Cannot normalize weights, unsupported attribute type." << io::endl;
             return;
         }
-        uint8_t* bytes = (uint8_t*) data->buffer_view->buffer->data;
-        float4* floats = (float4*) (bytes + data->offset + data->buffer_view->offset);
+        uint8_t* bytes = (uint8_t*) cgltf_buffer_view_data(data->buffer_view);
+        float4* floats = (float4*) (bytes + data->offset);
         for (cgltf_size i = 0; i < data->count; ++i) {
             float4 weights = floats[i];
             float sum = weights.x + weights.y + weights.z + weights.w;
@@ -528,6 +914,9 @@ void ResourceLoader::updateBoundingBoxes(details::FFilamentAsset* asset) const {
                 break;
             }
         }
+        if (prim.targets_count > 0) {
+            expandMorphedBounds(&prim, &aabb);
+        }
         return aabb;
     };
 
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_UTILS_FILEBLOBSTORE_H
+#define TNT_UTILS_FILEBLOBSTORE_H
+
+#include <utils/compiler.h>
+#include <utils/CString.h>
+
+#include <stddef.h>
+
+namespace utils {
+
+/**
+ * A key-value store backed by the filesystem, e.g. for caches that persist across runs.
+ *
+ * Each blob is stored in its own file, in the directory given at construction. The file is
+ * named after a hash of the key and also contains the key, which is compared on retrieval.
+ *
+ * Files are written under a unique temporary name and then renamed, so a partially written
+ * blob is never read back, even when several threads or processes share the same directory.
+ */
+class UTILS_PUBLIC FileBlobStore {
+public:
+    /**
+     * @param directory the directory to store the blobs in, it is created if needed.
+     */
+    explicit FileBlobStore(const char* directory) noexcept;
+
+    FileBlobStore(FileBlobStore const& rhs) = delete;
+    FileBlobStore& operator=(FileBlobStore const& rhs) = delete;
+
+    /**
+     * Stores a blob, replacing the blob previously associated to this key if any.
+     */
+    void insert(void const* key, size_t keySize, void const* value, size_t valueSize) noexcept;
+
+    /**
+     * Retrieves a blob.
+     * @return the size of the blob associated to key or 0 if there is none. The blob is copied
+     *         into value only if valueSize is large enough.
+     */
+    size_t retrieve(void const* key, size_t keySize, void* value, size_t valueSize) const noexcept;
+
+private:
+    CString mDirectory;
+};
+
+} // namespace utils
+
+#endif // TNT_UTILS_FILEBLOBSTORE_H
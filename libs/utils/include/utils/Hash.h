@@ -44,6 +44,70 @@ inline uint32_t murmur3(const uint32_t* key, size_t wordCount, uint32_t seed) {
     return h;
 }
 
+// murmur3 for keys whose size isn't a multiple of 4 bytes, or that may not be aligned
+inline uint32_t murmurSlow(const uint8_t* key, size_t size, uint32_t seed) {
+    const size_t wordCount = size / 4;
+    uint32_t h = seed;
+    for (size_t i = 0; i < wordCount; i++, key += 4) {
+        uint32_t k = uint32_t(key[0]) | uint32_t(key[1]) << 8 |
+                     uint32_t(key[2]) << 16 | uint32_t(key[3]) << 24;
+        k *= 0xcc9e2d51;
+        k = (k << 15) | (k >> 17);
+        k *= 0x1b873593;
+        h ^= k;
+        h = (h << 13) | (h >> 19);
+        h = (h * 5) + 0xe6546b64;
+    }
+    // the remaining 0 to 3 bytes
+    uint32_t k = 0;
+    switch (size & 3) {
+        case 3: k ^= uint32_t(key[2]) << 16;    // fall through
+        case 2: k ^= uint32_t(key[1]) << 8;     // fall through
+        case 1: k ^= uint32_t(key[0]);
+            k *= 0xcc9e2d51;
+            k = (k << 15) | (k >> 17);
+            k *= 0x1b873593;
+            h ^= k;
+    }
+    h ^= size;
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+// 64-bit murmur2 (MurmurHash64A), for content hashes that must not collide in practice
+inline uint64_t murmur64(const uint8_t* key, size_t size, uint64_t seed) {
+    constexpr uint64_t m = 0xc6a4a7935bd1e995;
+    constexpr int r = 47;
+    const size_t wordCount = size / 8;
+    uint64_t h = seed ^ (size * m);
+    for (size_t i = 0; i < wordCount; i++, key += 8) {
+        uint64_t k = 0;
+        for (size_t j = 0; j < 8; j++) {
+            k |= uint64_t(key[j]) << (j * 8);
+        }
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+    // the remaining 0 to 7 bytes
+    if (size & 7) {
+        for (size_t j = 0; j < (size & 7); j++) {
+            h ^= uint64_t(key[j]) << (j * 8);
+        }
+        h *= m;
+    }
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
 template<typename T>
 struct MurmurHashFn {
     uint32_t operator()(const T& key) const {
@@ -239,6 +239,11 @@ public:
      */
     static Path getCurrentExecutable();
 
+    /**
+     * @return a path representing a directory for temporary files
+     */
+    static Path getTemporaryDirectory();
+
     /**
      * Creates a directory denoted by the given path.
      * This is not recursive and doesn't create intermediate directories.
@@ -258,6 +263,14 @@ public:
      */
     bool mkdirRecursive() const;
 
+    /**
+     * Deletes the directory denoted by the given path, which must be empty.
+     *
+     * @return True if directory was successfully deleted.
+     *         When false, errno should have details on actual error.
+     */
+    bool rmdir() const;
+
     /**
      * Deletes this file.
      *
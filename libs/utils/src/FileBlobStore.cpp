@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <utils/FileBlobStore.h>
+
+#include <utils/Hash.h>
+#include <utils/Log.h>
+#include <utils/Path.h>
+
+#include <memory>
+#include <random>
+#include <string>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace utils {
+
+// Each file starts with this header, followed by the key and the value.
+struct BlobHeader {
+    static constexpr uint32_t MAGIC = 0x424C4246;  // 'FBLB'
+    uint32_t magic;
+    uint32_t keySize;
+    uint64_t valueSize;
+};
+
+static std::string getPath(const char* directory, void const* key, size_t keySize) noexcept {
+    // the key is hashed into the filename, collisions are resolved by comparing the keys
+    const uint64_t h = hash::murmur64((uint8_t const*)key, keySize, 0);
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.blob", (unsigned long long)h);
+    return Path::concat(directory, name);
+}
+
+FileBlobStore::FileBlobStore(const char* directory) noexcept
+        : mDirectory(directory, strlen(directory)) {
+    Path path(directory);
+    if (!path.exists() && !path.mkdirRecursive()) {
+        slog.w << "FileBlobStore: unable to create " << directory << io::endl;
+    }
+}
+
+size_t FileBlobStore::retrieve(void const* key, size_t keySize,
+        void* value, size_t valueSize) const noexcept {
+    const std::string path = getPath(mDirectory.c_str(), key, keySize);
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return 0;
+    }
+
+    size_t size = 0;
+    BlobHeader header{};
+    if (fread(&header, sizeof(header), 1, file) == 1 &&
+            header.magic == BlobHeader::MAGIC && header.keySize == keySize) {
+        std::unique_ptr<uint8_t[]> storedKey(new uint8_t[keySize]);
+        if (fread(storedKey.get(), 1, keySize, file) == keySize &&
+                !memcmp(storedKey.get(), key, keySize)) {
+            size = size_t(header.valueSize);
+            if (value && valueSize >= size) {
+                if (fread(value, 1, size, file) != size) {
+                    size = 0; // truncated file
+                }
+            }
+        }
+    }
+
+    fclose(file);
+    return size;
+}
+
+void FileBlobStore::insert(void const* key, size_t keySize,
+        void const* value, size_t valueSize) noexcept {
+    const std::string path = getPath(mDirectory.c_str(), key, keySize);
+
+    // write to a uniquely named temporary file first, then rename it, so we never read a
+    // partial blob
+    const std::string tmp = path + "." + std::to_string(std::random_device()()) + ".tmp";
+    FILE* file = fopen(tmp.c_str(), "wb");
+    if (!file) {
+        slog.w << "FileBlobStore: unable to write " << tmp.c_str() << io::endl;
+        return;
+    }
+
+    const BlobHeader header{ BlobHeader::MAGIC, uint32_t(keySize), uint64_t(valueSize) };
+    bool success = fwrite(&header, sizeof(header), 1, file) == 1 &&
+            fwrite(key, 1, keySize, file) == keySize &&
+            fwrite(value, 1, valueSize, file) == valueSize;
+    success = (fclose(file) == 0) && success;
+
+#if defined(WIN32)
+    // rename() doesn't replace an existing file on windows
+    remove(path.c_str());
+#endif
+
+    if (!success || rename(tmp.c_str(), path.c_str()) != 0) {
+        remove(tmp.c_str());
+    }
+}
+
+} // namespace utils
@@ -19,6 +19,8 @@
 #include <vector>
 
 #include <dirent.h>
+#include <stdlib.h>
+#include <unistd.h>
 #include <sys/stat.h>
 
 #include <mach-o/dyld.h>
@@ -29,6 +31,10 @@ bool Path::mkdir() const {
     return ::mkdir(m_path.c_str(), S_IRUSR | S_IWUSR | S_IXUSR) == 0;
 }
 
+bool Path::rmdir() const {
+    return ::rmdir(m_path.c_str()) == 0;
+}
+
 Path Path::getCurrentExecutable() {
     // First, need to establish resource path.
     char exec_buf[2048];
@@ -42,6 +48,11 @@ Path Path::getCurrentExecutable() {
     return result;
 }
 
+Path Path::getTemporaryDirectory() {
+    const char* directory = getenv("TMPDIR");
+    return Path(directory && *directory ? directory : "/tmp");
+}
+
 std::vector<Path> Path::listContents() const {
     // Return an empty vector if the path doesn't exist or is not a directory
     if (!isDirectory() || !exists()) {
@@ -29,6 +29,10 @@ bool Path::mkdir() const {
     return _mkdir(m_path.c_str()) == 0;
 }
 
+bool Path::rmdir() const {
+    return _rmdir(m_path.c_str()) == 0;
+}
+
 Path Path::getCurrentExecutable() {
     // First, need to establish resource path.
     TCHAR path[MAX_PATH + 1];
@@ -40,6 +44,17 @@ Path Path::getCurrentExecutable() {
     return result;
 }
 
+Path Path::getTemporaryDirectory() {
+    TCHAR path[MAX_PATH + 1];
+    Path result;
+
+    if (GetTempPath(MAX_PATH + 1, path) != 0) {
+        result.setPath(path);
+    }
+
+    return result;
+}
+
 std::vector<Path> Path::listContents() const {
     // Return an empty vector if the path doesn't exist or is not a directory
     if (!isDirectory() || !exists()) {
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <utils/FileBlobStore.h>
+#include <utils/Path.h>
+
+#include <vector>
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace utils;
+
+TEST(FileBlobStore, InsertRetrieve) {
+    Path directory = Path::getTemporaryDirectory().concat("utils_test_blobs");
+    auto clear = [&directory]() {
+        for (Path file : directory.listContents()) {
+            file.unlinkFile();
+        }
+    };
+    clear();
+    {
+        FileBlobStore store(directory.c_str());
+        EXPECT_TRUE(directory.isDirectory());
+
+        const char key0[] = "key0";
+        const char key1[] = "key1";
+        const char value0[] = "value0";
+        const char value1[] = "the value of key1";
+        char value[64];
+
+        // a missing key is reported as an empty blob
+        EXPECT_EQ(0u, store.retrieve(key0, sizeof(key0), value, sizeof(value)));
+
+        store.insert(key0, sizeof(key0), value0, sizeof(value0));
+        store.insert(key1, sizeof(key1), value1, sizeof(value1));
+
+        // the size can be queried first, the value isn't copied if it doesn't fit
+        EXPECT_EQ(sizeof(value0), store.retrieve(key0, sizeof(key0), nullptr, 0));
+        memset(value, 0, sizeof(value));
+        EXPECT_EQ(sizeof(value1), store.retrieve(key1, sizeof(key1), value, 4));
+        EXPECT_EQ(0, value[0]);
+
+        EXPECT_EQ(sizeof(value0), store.retrieve(key0, sizeof(key0), value, sizeof(value)));
+        EXPECT_STREQ(value0, value);
+        EXPECT_EQ(sizeof(value1), store.retrieve(key1, sizeof(key1), value, sizeof(value)));
+        EXPECT_STREQ(value1, value);
+
+        // a key that's a prefix of another is a different key
+        EXPECT_EQ(0u, store.retrieve(key0, sizeof(key0) - 1, value, sizeof(value)));
+
+        // inserting a key again replaces its blob
+        store.insert(key0, sizeof(key0), value1, sizeof(value1));
+        EXPECT_EQ(sizeof(value1), store.retrieve(key0, sizeof(key0), value, sizeof(value)));
+        EXPECT_STREQ(value1, value);
+
+        // the blobs persist across instances
+        FileBlobStore other(directory.c_str());
+        EXPECT_EQ(sizeof(value1), other.retrieve(key1, sizeof(key1), value, sizeof(value)));
+        EXPECT_STREQ(value1, value);
+
+        // corrupted blobs are ignored
+        std::vector<Path> files = directory.listContents();
+        EXPECT_EQ(2u, files.size());
+        for (Path const& file : files) {
+            FILE* f = fopen(file.c_str(), "r+b");
+            ASSERT_TRUE(f);
+            fputc(0, f);
+            fclose(f);
+        }
+        EXPECT_EQ(0u, store.retrieve(key0, sizeof(key0), value, sizeof(value)));
+        EXPECT_EQ(0u, store.retrieve(key1, sizeof(key1), value, sizeof(value)));
+    }
+    clear();
+    EXPECT_TRUE(directory.rmdir());
+}
@@ -394,3 +394,15 @@ TEST(PathTest, GetExtension) {
     p = Path();
     EXPECT_EQ(p.getExtension(), "");
 }
+
+TEST(PathTest, TemporaryDirectory) {
+    Path tmp(Path::getTemporaryDirectory());
+    EXPECT_TRUE(tmp.isDirectory());
+
+    Path dir = tmp.concat("utils_test_path");
+    dir.rmdir();
+    EXPECT_TRUE(dir.mkdir());
+    EXPECT_TRUE(dir.isDirectory());
+    EXPECT_TRUE(dir.rmdir());
+    EXPECT_FALSE(dir.exists());
+}
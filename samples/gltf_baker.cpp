@@ -89,6 +89,7 @@ struct App {
     image::LinearImage meshPositions;
     bool showOverlay = false;
     bool enablePrepScale = true;
+    bool enablePrepOptimize = true;
     View* overlayView = nullptr;
     Scene* overlayScene = nullptr;
     VertexBuffer* overlayVb = nullptr;
@@ -385,6 +386,20 @@ static void prepAsset(App& app) {
             return;
         }
 
+        if (app.enablePrepOptimize) {
+            app.statusText = std::make_shared<std::string>("Optimizing");
+            asset = pipeline.optimize(asset);
+            app.statusText.reset();
+        }
+
+        if (!asset) {
+            app.messageBoxText = std::make_shared<std::string>(
+                    "Unable to optimize mesh, check terminal output for details.");
+            app.pushedState = LOADED;
+            app.requestStatePop = true;
+            return;
+        }
+
         const utils::Path folder = app.filename.getAbsolutePath().getParent();
         const utils::Path binPath = folder + "prepped.bin";
         const utils::Path outPath = folder + "prepped.gltf";
@@ -618,14 +633,15 @@ int main(int argc, char** argv) {
             const ImVec4 enabled = ImGui::GetStyle().Colors[ImGuiCol_Text];
             ImGui::GetStyle().FrameRounding = 5;
 
-            // Prep action (flattening and parameterizing).
+            // Prep action (flattening, parameterizing and optimizing).
             const bool canPrep = app.state == LOADED;
             ImGui::PushStyleColor(ImGuiCol_Text, canPrep ? enabled : disabled);
             if (ImGui::Button("Prep", ImVec2(100, 50)) && canPrep) {
                 prepAsset(app);
             }
             if (ImGui::IsItemHovered()) {
-                ImGui::SetTooltip("Flattens the asset and generates a new set of UV coordinates.");
+                ImGui::SetTooltip("Flattens the asset, generates a new set of UV coordinates and "
+                        "optimizes the meshes.");
             }
             ImGui::PopStyleColor();
 
@@ -677,6 +693,7 @@ int main(int argc, char** argv) {
             }
             if (canPrep) {
                 ImGui::Checkbox("Auto-scale before parameterization", &app.enablePrepScale);
+                ImGui::Checkbox("Optimize after parameterization", &app.enablePrepOptimize);
             }
             if (canBake) {
                 static const int kFirstOption = std::log2(512);
@@ -33,7 +33,7 @@
 
 #include <utils/NameComponentManager.h>
 
-#include <fstream>
+#include <iostream>
 #include <string>
 
 #include "generated/resources/gltf.h"
@@ -47,6 +47,7 @@ struct App {
     SimpleViewer* viewer;
     Config config;
     AssetLoader* loader;
+    ResourceLoader* resourceLoader = nullptr;
     FilamentAsset* asset = nullptr;
     NameComponentManager* names;
     MaterialProvider* materials;
@@ -125,11 +126,6 @@ static int handleCommandLineArguments(int argc, char* argv[], App* app) {
     return optind;
 }
 
-static std::ifstream::pos_type getFileSize(const char* filename) {
-    std::ifstream in(filename, std::ifstream::ate | std::ifstream::binary);
-    return in.tellg();
-}
-
 int main(int argc, char** argv) {
     App app;
 
@@ -161,30 +157,8 @@ int main(int argc, char** argv) {
     }
 
     auto loadAsset = [&app](utils::Path filename) {
-        // Peek at the file size to allow pre-allocation.
-        long contentSize = static_cast<long>(getFileSize(filename.c_str()));
-        if (contentSize <= 0) {
-            std::cerr << "Unable to open " << filename << std::endl;
-            exit(1);
-        }
-
-        // Consume the glTF file.
-        std::ifstream in(filename.c_str(), std::ifstream::in);
-        std::vector<uint8_t> buffer(static_cast<unsigned long>(contentSize));
-        if (!in.read((char*) buffer.data(), contentSize)) {
-            std::cerr << "Unable to read " << filename << std::endl;
-            exit(1);
-        }
-
         // Parse the glTF file and create Filament entities.
-        if (filename.getExtension() == "glb") {
-            app.asset = app.loader->createAssetFromBinary(buffer.data(), buffer.size());
-        } else {
-            app.asset = app.loader->createAssetFromJson(buffer.data(), buffer.size());
-        }
-        buffer.clear();
-        buffer.shrink_to_fit();
-
+        app.asset = app.loader->createAssetFromFile(filename.c_str());
         if (!app.asset) {
             std::cerr << "Unable to parse " << filename << std::endl;
             exit(1);
@@ -192,13 +166,15 @@ int main(int argc, char** argv) {
     };
 
     auto loadResources = [&app] (utils::Path filename) {
-        // Load external textures and buffers.
-        gltfio::ResourceLoader({
+        // Load external buffers, the textures are loaded in the background, see animate().
+        delete app.resourceLoader;
+        app.resourceLoader = new gltfio::ResourceLoader({
             .engine = app.engine,
             .gltfPath = filename.getAbsolutePath(),
             .normalizeSkinningWeights = true,
             .recomputeBoundingBoxes = false
-        }).loadResources(app.asset);
+        });
+        app.resourceLoader->asyncBeginLoad(app.asset);
 
         // Load animation data then free the source hierarchy.
         app.asset->getAnimator();
@@ -231,6 +207,8 @@ int main(int argc, char** argv) {
                 ImGui::Text("%zu entities in the asset", app.asset->getEntityCount());
                 ImGui::Text("%zu renderables (excluding UI)", scene->getRenderableCount());
                 ImGui::Text("%zu skipped frames", FilamentApp::get().getSkippedFrameCount());
+                ImGui::Text("%.0f%% of the textures loaded",
+                        app.resourceLoader->asyncGetLoadProgress() * 100.0f);
             }
         });
 
@@ -242,6 +220,7 @@ int main(int argc, char** argv) {
     auto cleanup = [&app](Engine* engine, View*, Scene*) {
         Fence::waitAndDestroy(engine->createFence());
         delete app.viewer;
+        delete app.resourceLoader;
         app.loader->destroyAsset(app.asset);
         app.materials->destroyMaterials();
         delete app.materials;
@@ -250,6 +229,7 @@ int main(int argc, char** argv) {
     };
 
     auto animate = [&app](Engine* engine, View* view, double now) {
+        app.resourceLoader->asyncUpdateLoad();
         app.viewer->applyAnimation(now);
     };
 
@@ -263,6 +243,9 @@ int main(int argc, char** argv) {
 
     filamentApp.setDropHandler([&] (std::string path) {
         app.viewer->removeAsset();
+        Fence::waitAndDestroy(app.engine->createFence());
+        delete app.resourceLoader;
+        app.resourceLoader = nullptr;
         app.loader->destroyAsset(app.asset);
         loadAsset(path);
         loadResources(path);
@@ -38,10 +38,12 @@ void evaluateDirectionalLight(const MaterialInputs material,
     float visibility = 1.0;
 #if defined(HAS_SHADOWING)
     if (light.NoL > 0.0) {
-        visibility = shadow(light_shadowMap, getLightSpacePosition());
-        #if defined(MATERIAL_HAS_AMBIENT_OCCLUSION)
-        visibility *= computeMicroShadowing(light.NoL, material.ambientOcclusion);
-        #endif
+        if (frameUniforms.directionalShadows != 0u) {
+            visibility = shadow(light_shadowMap, getLightSpacePosition());
+            #if defined(MATERIAL_HAS_AMBIENT_OCCLUSION)
+            visibility *= computeMicroShadowing(light.NoL, material.ambientOcclusion);
+            #endif
+        }
     } else {
 #if defined(MATERIAL_CAN_SKIP_LIGHTING)
         return;
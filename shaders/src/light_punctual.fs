@@ -78,6 +78,15 @@ ivec2 getRecordTexCoord(uint index) {
     return ivec2(index & RECORD_BUFFER_WIDTH_MASK, index >> RECORD_BUFFER_WIDTH_SHIFT);
 }
 
+/**
+ * Returns the index of a light in the lights data buffer (lightsUniforms UBO)
+ * given the specified light record index.
+ */
+uint getLightIndex(uint index) {
+    ivec2 texCoord = getRecordTexCoord(index);
+    return texelFetch(light_records, texCoord, 0).r;
+}
+
 float getSquareFalloffAttenuation(float distanceSquare, float falloff) {
     float factor = distanceSquare * falloff;
     float smoothFactor = saturate(1.0 - factor * factor);
@@ -121,10 +130,8 @@ void setupPunctualLight(inout Light light, const highp vec4 positionFalloff) {
  * The light parameters used to compute the Light structure are fetched from the
  * lightsUniforms uniform buffer.
  */
-Light getSpotLight(uint index) {
+Light getSpotLight(uint lightIndex) {
     Light light;
-    ivec2 texCoord = getRecordTexCoord(index);
-    uint lightIndex = texelFetch(light_records, texCoord, 0).r;
 
     highp vec4 positionFalloff = lightsUniforms.lights[lightIndex][0];
     highp vec4 colorIntensity  = lightsUniforms.lights[lightIndex][1];
@@ -149,10 +156,8 @@ Light getSpotLight(uint index) {
  * The light parameters used to compute the Light structure are fetched from the
  * lightsUniforms uniform buffer.
  */
-Light getPointLight(uint index) {
+Light getPointLight(uint lightIndex) {
     Light light;
-    ivec2 texCoord = getRecordTexCoord(index);
-    uint lightIndex = texelFetch(light_records, texCoord, 0).r;
 
     highp vec4 positionFalloff = lightsUniforms.lights[lightIndex][0];
     highp vec4 colorIntensity  = lightsUniforms.lights[lightIndex][1];
@@ -165,6 +170,44 @@ Light getPointLight(uint index) {
     return light;
 }
 
+/**
+ * Returns the visibility of the current fragment from the specified punctual light,
+ * sampled from the light's tile(s) in the shadow atlas. Point lights use one tile per
+ * cube face. Returns 1.0 if the light doesn't cast shadows.
+ */
+float getPunctualVisibility(uint lightIndex, const Light light, bool isPointLight) {
+#if defined(HAS_SHADOWING)
+    // index of the light's first shadow tile plus one (0 if the light doesn't cast shadows)
+    // and the light's shadow bias
+    vec2 shadowParams = lightsUniforms.lights[lightIndex][3].zw;
+    uint tile = uint(shadowParams.x);
+    if (tile == 0u) {
+        return 1.0;
+    }
+    tile -= 1u;
+
+    if (isPointLight) {
+        // select the cube face containing the fragment, as seen from the light
+        highp vec3 d = -light.l;
+        highp vec3 a = abs(d);
+        if (a.x >= a.y && a.x >= a.z) {
+            tile += d.x > 0.0 ? 0u : 1u;
+        } else if (a.y >= a.z) {
+            tile += d.y > 0.0 ? 2u : 3u;
+        } else {
+            tile += d.z > 0.0 ? 4u : 5u;
+        }
+    }
+
+    // move the receiver towards the light to reduce shadow acne
+    highp vec3 p = vertex_worldPosition + light.l * shadowParams.y;
+    highp vec4 position = frameUniforms.shadowTileFromWorldMatrix[tile] * vec4(p, 1.0);
+    return shadow(light_shadowAtlas, position.xyz * (1.0 / position.w));
+#else
+    return 1.0;
+#endif
+}
+
 /**
  * Evaluates all punctual lights that my affect the current fragment.
  * The result of the lighting computations is accumulated in the color
@@ -186,13 +229,16 @@ void evaluatePunctualLights(const PixelParams pixel, inout vec3 color) {
 
     // Iterate point lights
     for ( ; index < end; index++) {
-        Light light = getPointLight(index);
+        uint lightIndex = getLightIndex(index);
+        Light light = getPointLight(lightIndex);
 #if defined(MATERIAL_CAN_SKIP_LIGHTING)
         if (light.NoL > 0.0) {
-            color.rgb += surfaceShading(pixel, light, 1.0);
+            float visibility = getPunctualVisibility(lightIndex, light, true);
+            color.rgb += surfaceShading(pixel, light, visibility);
         }
 #else
-        color.rgb += surfaceShading(pixel, light, 1.0);
+        float visibility = getPunctualVisibility(lightIndex, light, true);
+        color.rgb += surfaceShading(pixel, light, visibility);
 #endif
     }
 
@@ -200,13 +246,16 @@ void evaluatePunctualLights(const PixelParams pixel, inout vec3 color) {
 
     // Iterate spotlights
     for ( ; index < end; index++) {
-        Light light = getSpotLight(index);
+        uint lightIndex = getLightIndex(index);
+        Light light = getSpotLight(lightIndex);
 #if defined(MATERIAL_CAN_SKIP_LIGHTING)
         if (light.NoL > 0.0) {
-            color.rgb += surfaceShading(pixel, light, 1.0);
+            float visibility = getPunctualVisibility(lightIndex, light, false);
+            color.rgb += surfaceShading(pixel, light, visibility);
         }
 #else
-        color.rgb += surfaceShading(pixel, light, 1.0);
+        float visibility = getPunctualVisibility(lightIndex, light, false);
+        color.rgb += surfaceShading(pixel, light, visibility);
 #endif
     }
 }
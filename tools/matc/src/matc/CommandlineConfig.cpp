@@ -22,10 +22,14 @@
 
 #include <utils/Path.h>
 
+#include <fstream>
 #include <istream>
 #include <sstream>
 #include <string>
 
+#include <ctype.h>
+#include <stdlib.h>
+
 using namespace utils;
 
 namespace matc {
@@ -59,6 +63,17 @@ static void usage(char* name) {
             "       Filter out specified comma-separated variants:\n"
             "           directionalLighting, dynamicLighting, shadowReceiver, skinning\n"
             "       This variant filter is merged the filter from the material, if any\n\n"
+            "   --variant-profile=<file>\n"
+            "       Only compile the variants listed in the specified usage profile, other\n"
+            "       variants fall back to the closest compiled variant at runtime. Each line\n"
+            "       holds a material name followed by the variants it uses, either as\n"
+            "       '+'-separated variants (or 'base'), or as a bitmask as returned by\n"
+            "       Material::getUsedVariants(), e.g.:\n"
+            "           myMaterial base directionalLighting+shadowReceiver 0x0200\n"
+            "       Materials not listed in the profile have all their variants compiled\n\n"
+            "   --cache=<directory>, -c <directory>\n"
+            "       Cache the compiled shaders in the specified directory, shaders that\n"
+            "       didn't change since a previous build are not compiled again\n\n"
             "   --version, -v\n"
             "       Print the material version number\n\n"
             "Internal use and debugging only:\n"
@@ -88,22 +103,65 @@ static void license() {
     ;
 }
 
-static uint8_t parseVariantFilter(const std::string& arg) {
+// Returns false if arg contains an unknown variant name; known names are parsed regardless.
+static bool parseVariant(const std::string& arg, char separator, uint8_t& variant) {
     std::stringstream ss(arg);
     std::string item;
-    uint8_t variantFilter = 0;
-    while (std::getline(ss, item, ',')) {
+    bool valid = true;
+    variant = 0;
+    while (std::getline(ss, item, separator)) {
         if (item == "directionalLighting") {
-            variantFilter |= filament::Variant::DIRECTIONAL_LIGHTING;
+            variant |= filament::Variant::DIRECTIONAL_LIGHTING;
         } else if (item == "dynamicLighting") {
-            variantFilter |= filament::Variant::DYNAMIC_LIGHTING;
+            variant |= filament::Variant::DYNAMIC_LIGHTING;
         } else if (item == "shadowReceiver") {
-            variantFilter |= filament::Variant::SHADOW_RECEIVER;
+            variant |= filament::Variant::SHADOW_RECEIVER;
         } else if (item == "skinning") {
-            variantFilter |= filament::Variant::SKINNING;
+            variant |= filament::Variant::SKINNING;
+        } else {
+            valid = false;
         }
     }
-    return variantFilter;
+    return valid;
+}
+
+static uint8_t parseVariantFilter(const std::string& arg) {
+    uint8_t variant;
+    parseVariant(arg, ',', variant);
+    return variant;
+}
+
+static bool parseVariantProfile(const std::string& path,
+        std::unordered_map<std::string, uint32_t>& profile) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Unable to read the variant profile " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        std::stringstream ss(line.substr(0, line.find('#')));
+        std::string name;
+        if (!(ss >> name)) {
+            continue;
+        }
+        uint32_t usedVariants = 0;
+        std::string item;
+        while (ss >> item) {
+            uint8_t variant = 0;
+            if (isdigit((unsigned char)item[0])) {
+                usedVariants |= uint32_t(strtoul(item.c_str(), nullptr, 0));
+            } else if (item == "base" || parseVariant(item, '+', variant)) {
+                usedVariants |= 1u << variant;
+            } else {
+                std::cerr << "Unrecognized variant '" << item << "' for material " << name
+                        << " in the variant profile " << path << std::endl;
+                return false;
+            }
+        }
+        profile[name] |= usedVariants;
+    }
+    return true;
 }
 
 CommandlineConfig::CommandlineConfig(int argc, char** argv) : Config(), mArgc(argc), mArgv(argv) {
@@ -111,7 +169,7 @@ CommandlineConfig::CommandlineConfig(int argc, char** argv) : Config(), mArgc(ar
 }
 
 bool CommandlineConfig::parse() {
-    static constexpr const char* OPTSTR = "hlxo:f:dm:a:p:OSEr:vV:g";
+    static constexpr const char* OPTSTR = "hlxo:f:dm:a:p:OSEr:vV:gc:";
     static const struct option OPTIONS[] = {
             { "help",                    no_argument, nullptr, 'h' },
             { "license",                 no_argument, nullptr, 'l' },
@@ -129,6 +187,8 @@ bool CommandlineConfig::parse() {
             { "api",               required_argument, nullptr, 'a' },
             { "reflect",           required_argument, nullptr, 'r' },
             { "print",                   no_argument, nullptr, 't' },
+            { "cache",             required_argument, nullptr, 'c' },
+            { "variant-profile",   required_argument, nullptr, 'u' },
             { "version",                 no_argument, nullptr, 'v' },
             { nullptr, 0, nullptr, 0 }  // termination of the option list
     };
@@ -236,6 +296,14 @@ bool CommandlineConfig::parse() {
             case 't':
                 mPrintShaders = true;
                 break;
+            case 'c':
+                mShaderCacheDirectory = arg;
+                break;
+            case 'u':
+                if (!parseVariantProfile(arg, mVariantProfile)) {
+                    return false;
+                }
+                break;
         }
     }
 
@@ -24,6 +24,8 @@
 
 #include <memory>
 #include <ostream>
+#include <string>
+#include <unordered_map>
 
 #include <utils/compiler.h>
 
@@ -119,6 +121,22 @@ public:
         return mVariantFilter;
     }
 
+    // the variants a material is used with, from the variant profile. Returns false if the
+    // profile doesn't list this material, in which case all variants should be compiled.
+    bool getUsedVariants(std::string const& materialName, uint32_t* usedVariants) const noexcept {
+        auto pos = mVariantProfile.find(materialName);
+        if (pos == mVariantProfile.end()) {
+            return false;
+        }
+        *usedVariants = pos->second;
+        return true;
+    }
+
+    // directory where compiled shaders are cached, empty if there is no cache
+    std::string const& getShaderCacheDirectory() const noexcept {
+        return mShaderCacheDirectory;
+    }
+
 protected:
     bool mDebug = false;
     bool mIsValid = true;
@@ -130,6 +148,8 @@ protected:
     OutputFormat mOutputFormat = OutputFormat::BLOB;
     TargetApi mTargetApi = TargetApi::OPENGL;
     uint8_t mVariantFilter = 0;
+    std::string mShaderCacheDirectory;
+    std::unordered_map<std::string, uint32_t> mVariantProfile;
 };
 
 }
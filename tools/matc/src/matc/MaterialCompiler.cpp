@@ -274,6 +274,15 @@ bool MaterialCompiler::run(const Config& config) {
         .printShaders(config.printShaders())
         .variantFilter(config.getVariantFilter() | builder.getVariantFilter());
 
+    uint32_t usedVariants;
+    if (config.getUsedVariants(builder.getMaterialName().c_str_safe(), &usedVariants)) {
+        builder.usedVariants(usedVariants);
+    }
+
+    if (!config.getShaderCacheDirectory().empty()) {
+        builder.shaderCache(config.getShaderCacheDirectory().c_str());
+    }
+
     // Write builder.build() to output.
     Package package = builder.build();
     MaterialBuilder::shutdown();